@@ -0,0 +1,104 @@
+#pragma once
+#include "core/graph.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace infini {
+
+/**
+ * @brief Request latencies in power-of-two buckets of microseconds.
+ */
+struct LatencyHistogram {
+    // counts[i] is the number of requests taking [2^i, 2^(i+1)) us, where
+    // the first bucket also holds the requests under 1 us
+    vector<uint64_t> counts = vector<uint64_t>(32, 0);
+    uint64_t total = 0;
+    double sumUs = 0;
+
+    void record(std::chrono::microseconds latency);
+    // The upper bound in us of the bucket holding quantile q in [0, 1]
+    double percentile(double q) const;
+    double meanUs() const { return total ? sumUs / total : 0; }
+};
+
+/**
+ * @brief Coalesces single-sample requests into batches and runs them on
+ * graphs built for fixed batch sizes.
+ *
+ * Each bucket is an allocated graph whose inputs and outputs carry the batch
+ * in dim 0. A batch is started once the queue holds as many requests as the
+ * largest bucket, or once its oldest request has waited for `maxDelay`. It
+ * runs on the smallest bucket it fits in; the rows past the requests keep
+ * stale data. The buckets share the weights of the smallest one, see
+ * GraphObj::shareWeights. The batches run one by one on a thread of the
+ * scheduler, so the callers never wait on each other, and neither do they
+ * hold the GIL when driven from Python.
+ */
+class BatchScheduler {
+  public:
+    // One byte buffer per graph input or output, holding a single sample
+    using Sample = vector<vector<uint8_t>>;
+
+    struct Bucket {
+        Graph graph;
+        TensorVec inputs, outputs;
+    };
+
+  private:
+    struct Request {
+        Sample inputs;
+        std::promise<Sample> result;
+        std::chrono::steady_clock::time_point enqueued;
+    };
+
+    // Sorted by the batch size
+    vector<Bucket> buckets;
+    vector<int> batchSizes;
+    // The bytes of a sample of each input and output
+    vector<size_t> inputBytes, outputBytes;
+    std::chrono::microseconds maxDelay;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeUp;
+    std::deque<Request> queue;
+    bool stopping = false;
+    LatencyHistogram latency;
+    // The number of batches run with each size
+    vector<uint64_t> batchCounts;
+    // Declared last, so that it starts after the members above are set up
+    std::thread loop;
+
+  public:
+    BatchScheduler(vector<Bucket> buckets, std::chrono::microseconds maxDelay);
+    // Serves the queued requests before returning
+    ~BatchScheduler();
+    BatchScheduler(const BatchScheduler &) = delete;
+    BatchScheduler &operator=(const BatchScheduler &) = delete;
+
+    /**
+     * @brief Queue a request, whose outputs are set in the future once its
+     * batch has run.
+     */
+    std::shared_future<Sample> submit(Sample inputs);
+
+    int getMaxBatchSize() const { return batchSizes.back(); }
+    const vector<size_t> &getInputBytes() const { return inputBytes; }
+    const vector<size_t> &getOutputBytes() const { return outputBytes; }
+
+    size_t getQueueDepth() const;
+    // The time from submit until the outputs are set
+    LatencyHistogram getLatency() const;
+    // Element i is the number of batches run with i requests
+    vector<uint64_t> getBatchCounts() const;
+    void resetStats();
+
+  private:
+    void serve();
+    void runBatch(vector<Request> &batch);
+};
+
+} // namespace infini
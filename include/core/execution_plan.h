@@ -0,0 +1,35 @@
+#pragma once
+#include "core/kernel.h"
+
+namespace infini {
+
+/**
+ * @brief The operators of a graph resolved to their kernels and performance
+ * records, so that running the graph again does no lookup.
+ *
+ * Kernels read their tensors through the operator, so a plan stays valid as
+ * long as the graph and its memory plan do. GraphObj bumps its version on
+ * every change of either, which invalidates the plan.
+ */
+struct ExecutionPlan {
+    struct Step {
+        Kernel *kernel;
+        Operator op;
+        // The record to run with, or nullptr for the default arguments
+        PerfRecord record;
+    };
+    vector<Step> steps;
+    // The version of the graph the plan was built for, 0 if none
+    size_t version = 0;
+    // Whether the kernels without a record were tuned
+    bool tuned = false;
+    // Whether the dependencies below were recorded for concurrent runs
+    bool concurrent = false;
+    // The steps to start after each step, and the number of steps each step
+    // waits for. Besides the data flow, a step waits for the earlier steps
+    // touching memory it writes, or writing memory it touches.
+    vector<vector<int>> successors;
+    vector<int> numPredecessors;
+};
+
+} // namespace infini
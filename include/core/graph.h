@@ -1,5 +1,7 @@
 #pragma once
+#include "core/execution_plan.h"
 #include "core/lazy_allocator.h"
+#include "core/memory_planner.h"
 #include "core/operator.h"
 #include "core/tensor.h"
 
@@ -11,6 +13,7 @@ class GraphObj : public Object {
     TensorVec tensors;
     OpVec ops;
     LazyAllocator allocator;
+    vector<MemoryPlan> memoryPlans;
 
   public:
     explicit GraphObj(Runtime runtime)
@@ -32,12 +35,14 @@ class GraphObj : public Object {
         auto it = std::find(ops.begin(), ops.end(), op);
         if (it != ops.end())
             ops.erase(it);
+        ++version;
     }
 
     void removeTensor(Tensor tensor) {
         auto it = std::find(tensors.begin(), tensors.end(), tensor);
         if (it != tensors.end())
             tensors.erase(it);
+        ++version;
     }
 
     void deleteConnection(Tensor tensor, Operator op);
@@ -62,9 +67,117 @@ class GraphObj : public Object {
      */
     bool topo_sort();
 
+    /**
+     * @brief Run the optimization passes. Constant folding, dead code
+     * elimination and operator fusion repeat until none of them changes the
+     * graph, then CPU graphs get blocked layouts. If memory was allocated
+     * before, it is planned again for the new graph, so weights keep their
+     * data but other tensors do not.
+     */
     void optimize();
 
-    void dataMalloc(bool useNaiveAllocator = false);
+    /**
+     * @brief Evaluate the operators whose inputs are all weights with data,
+     * and the Shape operators, replacing their outputs by new weights.
+     * Returns true if the graph changed.
+     */
+    bool foldConstants();
+
+    /**
+     * @brief Remove the operators whose outputs are neither read nor marked as
+     * graph outputs, then the tensors left without source and targets.
+     * Nothing is removed if no tensor is marked as graph output. Returns true
+     * if the graph changed.
+     */
+    bool eliminateDeadCode();
+
+    /**
+     * @brief Fuse operator patterns of CPU inference graphs: Conv followed by
+     * BatchNormalization folds into the conv weights, MatMul followed by a
+     * bias Add and Conv or MatMul followed by an activation use the GEMM
+     * epilogue, and chains of element-wise operators become one
+     * FusedElementWise. Returns true if the graph changed.
+     */
+    bool fuseOperators();
+
+    /**
+     * @brief Run the CPU regions of convolutions and the pooling,
+     * batch normalization and elementwise ops around them on channel-blocked
+     * (nChw<block>c) activations. Layout-converting transposes are inserted
+     * only where a region meets the rest of the graph, so graph inputs and
+     * outputs keep the plain layout.
+     */
+    void assignBlockedLayout(int block = 8);
+
+    /**
+     * @brief Plan the memory of the tensors. Views share the memory of their
+     * input and, on CPU, outputs may take over the memory of an input read for
+     * the last time. When a CPU runtime runs independent operators at once,
+     * their buffers are planned as live together. KV caches get memory of
+     * their own, which keeps its contents across plans. The naive allocator
+     * gives every tensor its own memory instead, for debugging.
+     *
+     * @param planner The planner placing the tensors. Auto tries them all and
+     * keeps the plan with the lowest peak, which may run the operators in
+     * another topological order.
+     * @param concatInPlace On CPU, place the inputs of a Concat along its
+     * outermost non-unit axis inside its output, when they are read by
+     * nothing else. Their producers then write the output directly and the
+     * Concat copies nothing.
+     */
+    void dataMalloc(bool useNaiveAllocator = false,
+                    MemoryPlanner planner = MemoryPlanner::Auto,
+                    bool concatInPlace = false);
+
+    /**
+     * @brief The plans tried by the last dataMalloc, the chosen one first.
+     */
+    const vector<MemoryPlan> &getMemoryPlans() const { return memoryPlans; }
+
+    /**
+     * @brief Give the symbols naming dims of the graph inputs (see
+     * TensorObj::setDimSymbol) new sizes, and infer the shapes of the other
+     * tensors again. Symbols not in `sizes` keep their size.
+     *
+     * Once memory is allocated, the sizes are rounded up to powers of two.
+     * The memory and execution plans are made once for each such bucket, at
+     * its sizes, and reused by the sizes falling into it. They are dropped
+     * when the operators change.
+     */
+    void setSymbols(const std::map<string, int> &sizes);
+
+    /**
+     * @brief The size of each symbol of the graph inputs.
+     */
+    std::map<string, int> getSymbols() const;
+
+    /**
+     * @brief Create an executable copy of `graph`, whose memory is planned
+     * already. The copy shares the weights of `graph` and owns its other
+     * tensors, so that copies can run on different threads at once.
+     */
+    static Graph instantiate(const Graph &graph);
+
+    /**
+     * @brief Point the weights of this graph at those of `owner`, such as a
+     * graph of the same model built for another batch size. The weights are
+     * paired in order, and those differing in their shape or data keep their
+     * own memory, which is released once all of them are shared. Call it
+     * before the graph is instantiated.
+     */
+    void shareWeights(const Graph &owner);
+
+    /**
+     * @brief A counter bumped by every change of the operators, their
+     * connections or the memory plan.
+     */
+    size_t getVersion() const { return version; }
+
+    /**
+     * @brief The plan the runtime built for the last run. It is rebuilt when
+     * its version differs from the graph.
+     */
+    ExecutionPlan &getExecutionPlan() { return executionPlan; }
 
     /**
      * @brief Add an operator and create its outputs. Output tensor arguments
@@ -116,6 +229,18 @@ class GraphObj : public Object {
      */
     void addOperatorAndConnect(const Operator &op);
 
+    /**
+     * @brief Remove an operator and its connections, along with the inputs
+     * that are left unused. Its outputs stay in the graph without source.
+     */
+    void detachOperator(const Operator &op);
+
+    /**
+     * @brief Replace the operators `fused` by `op`, which reads inputs of
+     * `fused` and writes the output of the last one.
+     */
+    void replaceOperators(const OpVec &fused, const Operator &op);
+
     /**
      * @brief If the nodes is sorted in topological order.
      */
@@ -125,6 +250,51 @@ class GraphObj : public Object {
      * @brief If the weight tensors are allocated.
      */
     bool weightAllocated = false;
+
+    /**
+     * @brief The arguments of the last dataMalloc, with which the graph is
+     * planned again after it changes.
+     */
+    struct MallocOptions {
+        bool useNaiveAllocator = false;
+        MemoryPlanner planner = MemoryPlanner::Auto;
+        bool concatInPlace = false;
+    } mallocOptions;
+    void dataMallocAgain() {
+        dataMalloc(mallocOptions.useNaiveAllocator, mallocOptions.planner,
+                   mallocOptions.concatInPlace);
+    }
+
+    size_t version = 1;
+    ExecutionPlan executionPlan;
+
+    /**
+     * @brief Set the symbols of the graph inputs to `sizes` and infer the
+     * shapes of the other tensors, without touching the memory.
+     */
+    void inferShapes(const std::map<string, int> &sizes);
+
+    /**
+     * @brief The plans of a bucket of symbol sizes, see setSymbols.
+     */
+    struct ShapeBucket {
+        OpVec ops;
+        vector<MemoryPlan> memoryPlans;
+        // Offsets of the non-weight tensors in the memory of the allocator
+        std::unordered_map<TensorObj *, size_t> offsets;
+        ExecutionPlan executionPlan;
+    };
+    std::map<std::map<string, int>, ShapeBucket> shapeBuckets;
+    std::optional<std::map<string, int>> currentBucket;
+    // The number of version bumps by memory plans, so that version minus
+    // replans counts the changes of the operators
+    size_t replans = 0;
+    size_t bucketsVersion = 0;
+
+    /**
+     * @brief The graph whose allocator owns the weights, if instantiated.
+     */
+    Graph weightOwner;
 };
 
 } // namespace infini
@@ -2,23 +2,35 @@
 
 #include "core/graph.h"
 #include "core/runtime.h"
+#include "utils/thread_pool.h"
 #include <cstdint>
+#include <future>
 #include <iostream>
 
 namespace infini {
 
 class GraphHandlerObj {
     Graph g;
+    // Staging copies of the graph inputs and outputs, one set per slot
+    std::vector<std::unordered_map<TensorObj *, Tensor>> ioBuffers;
+    // Guards the creation of the runner by the first run_async. Held by
+    // pointer, so that the handler stays movable.
+    std::unique_ptr<std::mutex> runnerMutex = std::make_unique<std::mutex>();
+    // Runs the asynchronous requests one by one. Declared after the graph, so
+    // that it is joined before the graph is destroyed.
+    std::unique_ptr<ThreadPool> runner;
 
   public:
     GraphHandlerObj(Runtime runtime)
         : g(make_ref<GraphObj>(std::move(runtime))) {}
+    explicit GraphHandlerObj(Graph g) : g(std::move(g)) {}
 
     Tensor tensor(Shape dims, int dtype);
 
     //------ operators
 
     inline OpVec operators() { return g->getOperators(); }
+    inline Graph graph() const { return g; }
 
     Tensor conv(Tensor input, Tensor weight, Tensor output, int ph, int pw,
                 int sh, int sw, int dh, int dw);
@@ -30,6 +42,10 @@ class GraphHandlerObj {
     Tensor batchNormalization(Tensor input, Tensor output, Tensor mean,
                               Tensor var, Tensor scale, Tensor bias,
                               float momentum, float eps, bool training);
+    Tensor layerNormalization(Tensor input, Tensor scale, Tensor output,
+                              Tensor bias, float eps, int axis);
+    Tensor rmsNorm(Tensor input, Tensor weight, Tensor output, float eps,
+                   int axis);
 
     Tensor maxPool(Tensor input, Tensor output, int kh, int kw, int dh, int dw,
                    int ph, int pw, int sh, int sw, int ceilMode);
@@ -52,6 +68,7 @@ class GraphHandlerObj {
     Tensor tanh(Tensor x, Tensor y);
     Tensor erf(Tensor x, Tensor y);
     Tensor softmax(Tensor x, Tensor y, int axis);
+    Tensor logSoftmax(Tensor x, Tensor y, int axis);
     Tensor abs(Tensor x, Tensor y);
     Tensor sqrt(Tensor x, Tensor y);
     Tensor neg(Tensor x, Tensor y);
@@ -68,8 +85,36 @@ class GraphHandlerObj {
                     int num_outputs);
     Tensor gather(Tensor data, Tensor indices, Tensor output, int axis);
     Tensor gatherElements(Tensor data, Tensor indices, Tensor output, int axis);
+    Tensor reduceL1(Tensor data, Tensor reduced,
+                    const optional<vector<int>> &axes, bool keepdims,
+                    bool noopWithEmptyAxes);
+    Tensor reduceL2(Tensor data, Tensor reduced,
+                    const optional<vector<int>> &axes, bool keepdims,
+                    bool noopWithEmptyAxes);
+    Tensor reduceLogSum(Tensor data, Tensor reduced,
+                        const optional<vector<int>> &axes, bool keepdims,
+                        bool noopWithEmptyAxes);
+    Tensor reduceLogSumExp(Tensor data, Tensor reduced,
+                           const optional<vector<int>> &axes, bool keepdims,
+                           bool noopWithEmptyAxes);
+    Tensor reduceMax(Tensor data, Tensor reduced,
+                     const optional<vector<int>> &axes, bool keepdims,
+                     bool noopWithEmptyAxes);
     Tensor reduceMean(Tensor data, Tensor reduced,
-                      const optional<vector<int>> &axes, bool keepdims);
+                      const optional<vector<int>> &axes, bool keepdims,
+                      bool noopWithEmptyAxes);
+    Tensor reduceMin(Tensor data, Tensor reduced,
+                     const optional<vector<int>> &axes, bool keepdims,
+                     bool noopWithEmptyAxes);
+    Tensor reduceProd(Tensor data, Tensor reduced,
+                      const optional<vector<int>> &axes, bool keepdims,
+                      bool noopWithEmptyAxes);
+    Tensor reduceSum(Tensor data, Tensor reduced,
+                     const optional<vector<int>> &axes, bool keepdims,
+                     bool noopWithEmptyAxes);
+    Tensor reduceSumSquare(Tensor data, Tensor reduced,
+                           const optional<vector<int>> &axes, bool keepdims,
+                           bool noopWithEmptyAxes);
     Tensor slice(Tensor input, Tensor output, const vector<int> &starts,
                  const vector<int> &ends, const optional<vector<int>> &axes,
                  const optional<vector<int>> &steps);
@@ -78,6 +123,10 @@ class GraphHandlerObj {
     Tensor cast(Tensor input, Tensor output, int to);
     Tensor expand(Tensor input, Tensor output, Shape dims);
     Tensor where(Tensor inputX, Tensor inputY, Tensor condition, Tensor output);
+    Tensor kvcacheAppend(Tensor cache, Tensor input, Tensor position,
+                         Tensor output);
+    Tensor attentionKVCache(Tensor query, Tensor keyCache, Tensor valueCache,
+                            Tensor position, Tensor output);
 
     Tensor allReduceSum(Tensor input, Tensor output);
     Tensor allReduceProd(Tensor input, Tensor output);
@@ -101,6 +150,44 @@ class GraphHandlerObj {
 
     inline void run() { g->getRuntime()->run(g); }
 
+    /**
+     * @brief Give the symbolic dims of the graph inputs new sizes, see
+     * GraphObj::setSymbols. The staging buffers must be allocated again.
+     */
+    inline void set_symbols(const std::map<string, int> &sizes) {
+        g->setSymbols(sizes);
+    }
+    inline std::map<string, int> symbols() const { return g->getSymbols(); }
+
+    /**
+     * @brief A handler of an executable copy of the graph, which shares its
+     * weights and can run on another thread.
+     */
+    inline GraphHandlerObj instantiate() {
+        return GraphHandlerObj(GraphObj::instantiate(g));
+    }
+
+    /**
+     * @brief Allocate `n` slots of staging buffers for the graph inputs and
+     * outputs, so that the inputs of a request can be copied into one slot
+     * while the graph runs on another.
+     */
+    void init_io_buffers(int n);
+
+    /**
+     * @brief The staging buffer of graph input or output `t` in `slot`.
+     */
+    Tensor io_buffer(Tensor t, int slot);
+
+    /**
+     * @brief Run the graph in the background, after the runs submitted
+     * before. With a slot, its inputs are copied into the graph when the run
+     * starts, and the graph outputs into it when the run ends. Otherwise the
+     * graph tensors are used directly and must not be touched until the run
+     * ends.
+     */
+    std::shared_future<void> run_async(int slot = -1);
+
     inline double get_perf_time() { return g->getRuntime()->getPerfTime(g); }
 };
 
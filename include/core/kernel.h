@@ -4,6 +4,7 @@
 #include "core/tensor.h"
 #include <functional>
 #include <nlohmann/json.hpp>
+#include <shared_mutex>
 using json = nlohmann::json;
 namespace infini {
 
@@ -83,6 +84,9 @@ class KernelRegistry {
   private:
     std::map<KernelAttrs, KernelRecord> kernels;
     int nKernels = 0;
+    // Kernels are looked up by graphs compiled on several threads, and may be
+    // registered after static initialization by dynamically loaded code
+    mutable std::shared_mutex mutex;
 
   public:
     ~KernelRegistry() {
@@ -95,12 +99,14 @@ class KernelRegistry {
     }
     bool registerKernel(const KernelAttrs &key, Kernel *kernel, string name) {
         // TODO: mutliple kernels support: priority and check name
+        std::unique_lock lock(mutex);
         IT_ASSERT(kernels.find(key) == kernels.end(),
                   "Kernel already registered");
         kernels.emplace(key, KernelRecord{kernel, name, ++nKernels});
         return true;
     }
     Kernel *getKernel(const KernelAttrs &kernelAttrs) const {
+        std::shared_lock lock(mutex);
         auto it = kernels.find(kernelAttrs);
         IT_ASSERT(it != kernels.end(),
                   "Kernel not found for key {" +
@@ -109,7 +115,12 @@ class KernelRegistry {
                       std::get<2>(kernelAttrs).toString() + "}");
         return std::get<0>(it->second);
     }
+    bool hasKernel(const KernelAttrs &kernelAttrs) const {
+        std::shared_lock lock(mutex);
+        return kernels.find(kernelAttrs) != kernels.end();
+    }
     const KernelRecord &getKernelItem(const KernelAttrs &kernelAttrs) const {
+        std::shared_lock lock(mutex);
         return kernels.at(kernelAttrs);
     }
 };
@@ -76,6 +76,9 @@ class LazyAllocator {
 
     size_t allocWeight(size_t size);
 
+    // function: release the weight memory once the weights live elsewhere
+    void freeWeight();
+
     // function: simulate memory free
     // arguments:
     //     addr: head address offset of memory block to be free
@@ -92,12 +95,17 @@ class LazyAllocator {
 
     void *getWeightPtr();
 
+    // function: take a plan made outside of the allocator, so that getPtr
+    // allocates at least `size` bytes
+    void reserve(size_t size);
+
+    size_t getPeak() const { return peak; }
+
     void info();
 
-  private:
     // function: memory alignment, rouned up
     // return: size of the aligned memory block
-    size_t getAlignedSize(size_t size);
+    size_t getAlignedSize(size_t size) const;
 };
 
 } // namespace infini
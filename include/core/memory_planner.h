@@ -0,0 +1,55 @@
+#pragma once
+#include "core/lazy_allocator.h"
+
+namespace infini {
+
+enum class MemoryPlanner {
+    // The plan with the lowest peak among all the planners below
+    Auto,
+    // LazyAllocator's best-fit heap, replayed in execution order
+    Greedy,
+    // The largest buffers first, each into the tightest gap left among the
+    // buffers it is live with
+    GreedyBySize,
+    // Colouring of the conflict graph of lifetimes, by decreasing weighted
+    // degree, each buffer at the lowest offset its neighbours leave free
+    IntervalColouring,
+    // Reorder the independent operators to lower the live bytes, then take
+    // the best of the plans above on the new order
+    Reorder,
+};
+
+const char *toString(MemoryPlanner planner);
+
+// A memory block that is live from step `start` to step `end` of the
+// execution, both included. Step i runs the i-th operator.
+struct MemoryBuffer {
+    size_t size;
+    int start;
+    int end;
+};
+
+struct MemoryPlan {
+    MemoryPlanner planner;
+    // the offset of each buffer
+    vector<size_t> offsets;
+    // the memory needed by the plan
+    size_t peak;
+    // the max live bytes at any step, which no plan of the same order can go
+    // below
+    size_t lowerBound;
+};
+
+// function: compute the max live bytes at any step
+size_t liveBytesLowerBound(const vector<MemoryBuffer> &buffers);
+
+// function: replay the buffers on `allocator` in execution order. The
+// allocator is reinitialized first, and holds the plan afterwards.
+MemoryPlan planGreedy(const vector<MemoryBuffer> &buffers,
+                      LazyAllocator &allocator);
+
+MemoryPlan planGreedyBySize(const vector<MemoryBuffer> &buffers);
+
+MemoryPlan planIntervalColouring(const vector<MemoryBuffer> &buffers);
+
+} // namespace infini
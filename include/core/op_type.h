@@ -205,6 +205,11 @@ struct OpType {
         G2BMM,
         GBMM,
         MemBound,
+        FusedElementWise,
+        KVCacheAppend,
+        AttentionKVCache,
+        Attention,
+        RMSNorm,
         // TODO
         ConvTransNHWC,
         ConvBackwardFilter,
@@ -93,6 +93,36 @@ class OperatorObj : public Object {
     DataType getDType() const { return getInputs(0)->getDType(); }
     virtual int numInputs() const = 0;
     virtual int numOutputs() const = 0;
+    /**
+     * @brief Whether the output holds the data of the first input unchanged,
+     * only with another shape. The memory planner may then let the output
+     * share the memory of the input.
+     */
+    virtual bool isView() const { return false; }
+    /**
+     * @brief Whether this is a view whose output shares memory with its input,
+     * so that running it does nothing.
+     */
+    bool isAliasedView() const;
+    /**
+     * @brief Indices of the inputs whose memory the output may overwrite,
+     * because the kernels read each element before writing it. The memory
+     * planner reuses such an input for the output if it is read for the last
+     * time.
+     */
+    virtual vector<int> getInplaceInputs() const { return {}; }
+    /**
+     * @brief Whether the op writes into its first input, whose memory its
+     * output then always shares, such as appending rows to a KV cache.
+     */
+    virtual bool isInplaceUpdate() const { return false; }
+    /**
+     * @brief Recompute the attributes derived from the input shapes, after
+     * the inputs were given new shapes by GraphObj::setSymbols.
+     *
+     * @param oldInputShapes The input shapes the attributes were derived from.
+     */
+    virtual void updateShapeAttributes(const vector<Shape> &oldInputShapes) {}
 
     /**
      * @brief Clone this operator and replace its inputs and outputs.
@@ -126,6 +156,7 @@ class OperatorObj : public Object {
     void removePredecessors(const Operator &op);
     void removeSuccessors(const Operator &op);
     void replaceInput(Tensor t1, Tensor t2);
+    void replaceOutput(Tensor t1, Tensor t2);
 };
 
 #define OP_CLONE(OpObj)                                                        \
@@ -2,6 +2,7 @@
 #include "core/graph.h"
 #include "core/kernel.h"
 #include <nlohmann/json_fwd.hpp>
+#include <shared_mutex>
 using json = nlohmann::json;
 namespace infini {
 
@@ -17,6 +18,8 @@ class PerfEngine {
 
   private:
     map<Key, PerfRecord> data;
+    // Graphs may be compiled and tuned from several threads at once
+    mutable std::shared_mutex mutex;
 
   public:
     static PerfEngine &getInstance() {
@@ -30,6 +33,7 @@ class PerfEngine {
      * @return PerfRecord nullptr if no record is fnoud.
      */
     PerfRecord getPerfData(const Key &key) {
+        std::shared_lock lock(mutex);
         auto it = data.find(key);
         if (it != data.end()) // find previous evaluating results
             return data.at(key);
@@ -38,11 +42,28 @@ class PerfEngine {
     }
 
     void setPerfData(const Key &key, PerfRecord record) {
+        std::unique_lock lock(mutex);
         IT_ASSERT(data.find(key) == data.end(), "Perf data already exist");
         data.emplace(key, record);
     }
-    map<Key, PerfRecord> get_data() { return data; }
-    void set_data(map<Key, PerfRecord> data) { this->data = data; }
+
+    /**
+     * @brief Store `record` unless another thread tuned the same key first.
+     *
+     * @return PerfRecord The record stored for `key`.
+     */
+    PerfRecord addPerfData(const Key &key, PerfRecord record) {
+        std::unique_lock lock(mutex);
+        return data.emplace(key, record).first->second;
+    }
+    map<Key, PerfRecord> get_data() {
+        std::shared_lock lock(mutex);
+        return data;
+    }
+    void set_data(map<Key, PerfRecord> data) {
+        std::unique_lock lock(mutex);
+        this->data = data;
+    }
     void savePerfEngineData(std::string file_path);
     void loadPerfEngineData(std::string file_path);
 };
@@ -4,6 +4,7 @@
 #include "core/op_type.h"
 #include "core/ref.h"
 #include <memory>
+#include <mutex>
 
 namespace infini {
 
@@ -15,6 +16,8 @@ class GraphObj;
 class GraphHandlerObj;
 class RuntimeObj;
 class BlobObj;
+class ThreadPool;
+struct ExecutionPlan;
 
 using TensorBase = Ref<TensorBaseObj>;
 using Tensor = Ref<TensorObj>;
@@ -81,6 +84,7 @@ class RuntimeObj : public std::enable_shared_from_this<RuntimeObj> {
                                size_t bytes) const = 0;
     virtual string toString() const = 0;
 
+    Device getDevice() const { return device; }
     int getDeviceId() const { return deviceId; }
 
     virtual void initComm(const string &name, int worldSize, int rank) = 0;
@@ -96,12 +100,40 @@ class RuntimeObj : public std::enable_shared_from_this<RuntimeObj> {
 };
 
 class CpuRuntimeObj : public RuntimeObj {
+  private:
+    // Number of operators that may run at once
+    int interOpThreads = 1;
+    mutable std::shared_ptr<ThreadPool> pool;
+    mutable std::mutex poolMutex;
+
   public:
     CpuRuntimeObj(Device dev) : RuntimeObj(dev) {}
 
+    /**
+     * @brief Run up to `threads` independent operators at once, each with
+     * its share of the OpenMP threads. Graphs planned by dataMalloc after
+     * this call keep the buffers of concurrent operators apart.
+     */
+    void setInterOpThreads(int threads);
+    int getInterOpThreads() const { return interOpThreads; }
+
+    /**
+     * @brief Execute a graph through its execution plan, which is rebuilt
+     * only after the graph or its memory plan changed.
+     */
     void run(const Graph &graph, bool tune = false,
              bool profiling = false) const override;
 
+    /**
+     * @brief Resolve the operators of a graph to their kernels and
+     * performance records. Views planned onto the memory of their input are
+     * left out. With inter-op threads, it also records which operators must
+     * finish before each one starts.
+     *
+     * @param tune Whether to tune the kernels without a record.
+     */
+    ExecutionPlan compile(const Graph &graph, bool tune) const;
+
     void copyBlobFromCPU(void *dst, const void *src,
                          size_t bytes) const override;
     void copyBlobToCPU(void *dst, const void *src, size_t bytes) const override;
@@ -110,6 +142,9 @@ class CpuRuntimeObj : public RuntimeObj {
     void initComm(const string &, int, int) override { IT_TODO_HALT(); }
 
     CommunicatorObj &getCommunicator() const override { IT_TODO_HALT(); }
+
+  private:
+    void runConcurrently(const ExecutionPlan &plan) const;
 };
 
 class NativeCpuRuntimeObj : public CpuRuntimeObj {
@@ -21,6 +21,8 @@ class TensorObj : public TensorBaseObj {
     Fuid fuid;    // Cloned tensors share the same id. Tensors constructed from
                   // scratch have a new id.
     TensorType tensorType = TensorType::others;
+    int channelBlock = 1; // See getChannelBlock()
+    vector<string> dimSymbols; // See setDimSymbol()
 
   public:
     TensorObj(Shape shape, DataType dtype, Runtime runtime);
@@ -39,10 +41,36 @@ class TensorObj : public TensorBaseObj {
     bool isWeight() const { return tensorType == TensorType::weight; }
     bool isInput() const { return tensorType == TensorType::input; }
     bool isOutput() const { return tensorType == TensorType::output; }
+    bool isKVCache() const { return tensorType == TensorType::kvcache; }
     bool isOthers() const { return tensorType == TensorType::others; }
     void setWeight() { tensorType = TensorType::weight; }
     void setInput() { tensorType = TensorType::input; }
     void setOutput() { tensorType = TensorType::output; }
+    void setKVCache() { tensorType = TensorType::kvcache; }
+    /**
+     * @brief Channels per block of the memory layout. The dims always stay the
+     * logical NCHW ones. With a block B > 1, element (n, c, h, w) is stored at
+     * ((n * C / B + c / B) * H * W + h * W + w) * B + c % B, which are the
+     * nChw8c and nChw16c layouts for B = 8 and 16. 1 is the plain layout.
+     */
+    int getChannelBlock() const { return channelBlock; }
+    void setChannelBlock(int block) {
+        IT_ASSERT(block == 1 || (shape.size() == 4 && shape[1] % block == 0),
+                  "Channels must be a multiple of the layout block.");
+        channelBlock = block;
+    }
+    /**
+     * @brief Name dim `i` after a symbol such as "batch" or "seq", whose size
+     * GraphObj::setSymbols may change. The dims of a symbol take its size.
+     */
+    void setDimSymbol(int i, const string &symbol);
+    // The symbol of each dim, empty for the fixed dims
+    vector<string> getDimSymbols() const;
+    /**
+     * @brief Give the tensor new dims of the same rank. Its data, if any, is
+     * kept, so it must be large enough for the new dims.
+     */
+    void setShape(Shape shape);
     string tensorTypeToString() const {
         switch (tensorType) {
         case TensorType::weight:
@@ -54,6 +82,9 @@ class TensorObj : public TensorBaseObj {
         case TensorType::output:
             return "output";
             break;
+        case TensorType::kvcache:
+            return "kvcache";
+            break;
         case TensorType::others:
             return "others";
             break;
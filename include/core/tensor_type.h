@@ -2,6 +2,8 @@
 
 namespace infini {
 
-enum class TensorType { weight, input, output, others };
+// A kvcache tensor keeps its contents across runs like a weight, but each
+// executable copy of a graph has its own.
+enum class TensorType { weight, input, output, kvcache, others };
 
 } // namespace infini
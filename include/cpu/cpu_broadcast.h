@@ -0,0 +1,102 @@
+#pragma once
+#include "core/tensor.h"
+#include <algorithm>
+
+namespace infini {
+
+/**
+ * @brief The broadcast of some inputs to the output, with the dims of size 1
+ * dropped and the adjacent dims that every input either spans or broadcasts
+ * merged. A same-shape op becomes a single dim, and a bias add two.
+ */
+struct BroadcastPlan {
+    Shape dims;
+    // Element strides of each input in `dims`, 0 where it is broadcast
+    vector<vector<int64_t>> strides;
+
+    BroadcastPlan(const Shape &out, const vector<Shape> &inputs)
+        : strides(inputs.size()) {
+        const int rank = out.size(), n = inputs.size();
+        // Whether each input spans each dim, and the dims kept
+        vector<vector<bool>> spans;
+        for (int i = 0; i < rank; ++i) {
+            if (out[i] == 1)
+                continue;
+            vector<bool> s(n);
+            for (int k = 0; k < n; ++k) {
+                const int j = i - (rank - int(inputs[k].size()));
+                s[k] = j >= 0 && inputs[k][j] != 1;
+            }
+            if (!spans.empty() && spans.back() == s)
+                dims.back() *= out[i];
+            else {
+                dims.emplace_back(out[i]);
+                spans.emplace_back(s);
+            }
+        }
+        for (int k = 0; k < n; ++k) {
+            strides[k].resize(dims.size());
+            int64_t stride = 1;
+            for (int i = dims.size() - 1; i >= 0; --i) {
+                strides[k][i] = spans[i][k] ? stride : 0;
+                stride *= spans[i][k] ? dims[i] : 1;
+            }
+        }
+    }
+
+    // The number of rows along the last dim, 1 if there is no dim
+    int64_t rows() const {
+        int64_t ret = 1;
+        for (size_t i = 0; i + 1 < dims.size(); ++i)
+            ret *= dims[i];
+        return ret;
+    }
+};
+
+/**
+ * @brief Call f(r, offsets) for each row r along the last dim of `plan`, with
+ * `offsets` the element offset of the row in each input. Rows are handed to
+ * threads in chunks of about `chunk` elements, and each chunk walks its rows
+ * with a counter instead of dividing for every offset.
+ */
+template <typename F>
+void forEachRow(const BroadcastPlan &plan, F f, int64_t chunk = 16384) {
+    const auto &dims = plan.dims;
+    const int n = plan.strides.size();
+    if (dims.empty()) {
+        vector<int64_t> offsets(n, 0);
+        return f(int64_t(0), offsets.data());
+    }
+    const int outer = dims.size() - 1;
+    const int64_t len = dims.back(), rows = plan.rows();
+    // An empty output has no rows
+    if (rows * len == 0)
+        return;
+    const int64_t rowsPerChunk = std::max<int64_t>(1, chunk / len);
+#pragma omp parallel for if (rows * len > chunk)
+    for (int64_t r0 = 0; r0 < rows; r0 += rowsPerChunk) {
+        vector<int64_t> index(outer), offsets(n, 0);
+        int64_t r = r0;
+        for (int i = outer - 1; i >= 0; --i) {
+            index[i] = r % dims[i];
+            r /= dims[i];
+            for (int k = 0; k < n; ++k)
+                offsets[k] += index[i] * plan.strides[k][i];
+        }
+        const int64_t r1 = std::min(rows, r0 + rowsPerChunk);
+        for (r = r0; r < r1; ++r) {
+            f(r, offsets.data());
+            for (int i = outer - 1; i >= 0; --i) {
+                for (int k = 0; k < n; ++k)
+                    offsets[k] += plan.strides[k][i];
+                if (++index[i] < dims[i])
+                    break;
+                for (int k = 0; k < n; ++k)
+                    offsets[k] -= plan.strides[k][i] * dims[i];
+                index[i] = 0;
+            }
+        }
+    }
+}
+
+} // namespace infini
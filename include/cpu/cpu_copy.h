@@ -0,0 +1,102 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace infini {
+
+/**
+ * @brief Copy `blocks` runs of `run` bytes, from `src` every `srcStride`
+ * bytes to `dst` every `dstStride` bytes. Threads take blocks, or parts of
+ * the run when there is a single block, once there is enough to copy.
+ */
+inline void copyBlocks(const uint8_t *src, size_t srcStride, uint8_t *dst,
+                       size_t dstStride, size_t run, size_t blocks) {
+    constexpr size_t chunk = 1 << 16;
+    if (blocks == 1) {
+#pragma omp parallel for if (run > chunk)
+        for (size_t start = 0; start < run; start += chunk)
+            std::memcpy(dst + start, src + start,
+                        std::min(chunk, run - start));
+        return;
+    }
+#pragma omp parallel for if (blocks * run > chunk)
+    for (size_t i = 0; i < blocks; ++i)
+        std::memcpy(dst + i * dstStride, src + i * srcStride, run);
+}
+
+/**
+ * @brief Copy rows of `rowBytes` bytes between two strided views of `dims`
+ * rows. The row at index (i0, i1, ...) of `dims` starts at the sum of
+ * ik * srcStrides[k] bytes in `src`, and likewise in `dst`. Threads take
+ * chunks of rows, and each chunk walks its rows with a counter.
+ */
+inline void copyRows(const uint8_t *src, const std::vector<int64_t> &srcStrides,
+                     uint8_t *dst, const std::vector<int64_t> &dstStrides,
+                     const std::vector<int64_t> &dims, size_t rowBytes) {
+    constexpr int64_t chunk = 1 << 16;
+    const int rank = dims.size();
+    int64_t rows = 1;
+    for (auto d : dims)
+        rows *= d;
+    const int64_t rowsPerChunk =
+        std::max<int64_t>(1, chunk / std::max<size_t>(rowBytes, 1));
+#pragma omp parallel for if (rows * int64_t(rowBytes) > chunk)
+    for (int64_t r0 = 0; r0 < rows; r0 += rowsPerChunk) {
+        std::vector<int64_t> index(rank);
+        int64_t s = 0, d = 0, r = r0;
+        for (int i = rank - 1; i >= 0; --i) {
+            index[i] = r % dims[i];
+            r /= dims[i];
+            s += index[i] * srcStrides[i];
+            d += index[i] * dstStrides[i];
+        }
+        const int64_t r1 = std::min(rows, r0 + rowsPerChunk);
+        for (r = r0; r < r1; ++r) {
+            std::memcpy(dst + d, src + s, rowBytes);
+            for (int i = rank - 1; i >= 0; --i) {
+                s += srcStrides[i];
+                d += dstStrides[i];
+                if (++index[i] < dims[i])
+                    break;
+                s -= srcStrides[i] * dims[i];
+                d -= dstStrides[i] * dims[i];
+                index[i] = 0;
+            }
+        }
+    }
+}
+
+// Register kernel<U> for every type, with U the unsigned integer of its size,
+// for kernels that only move elements
+#define REGISTER_KERNEL_BY_SIZE(type, kernel, name)                            \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Float32,              \
+                    kernel<uint32_t>, name "_CPU_float32");                    \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Float16,              \
+                    kernel<uint16_t>, name "_CPU_float16");                    \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::BFloat16,             \
+                    kernel<uint16_t>, name "_CPU_bfloat16");                   \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Double,               \
+                    kernel<uint64_t>, name "_CPU_float64");                    \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Int8,                 \
+                    kernel<uint8_t>, name "_CPU_int8");                        \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Int16,                \
+                    kernel<uint16_t>, name "_CPU_int16");                      \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Int32,                \
+                    kernel<uint32_t>, name "_CPU_int32");                      \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Int64,                \
+                    kernel<uint64_t>, name "_CPU_int64");                      \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::UInt8,                \
+                    kernel<uint8_t>, name "_CPU_uint8");                       \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::UInt16,               \
+                    kernel<uint16_t>, name "_CPU_uint16");                     \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::UInt32,               \
+                    kernel<uint32_t>, name "_CPU_uint32");                     \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::UInt64,               \
+                    kernel<uint64_t>, name "_CPU_uint64");                     \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Bool,                 \
+                    kernel<uint8_t>, name "_CPU_bool");
+
+} // namespace infini
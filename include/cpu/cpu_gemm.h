@@ -0,0 +1,83 @@
+#pragma once
+#include "core/common.h"
+#include "core/op_type.h"
+#include "cpu/cpu_math.h"
+#include <cmath>
+#include <type_traits>
+
+namespace infini {
+
+/**
+ * @brief Apply a fused activation to a single value. Sigmoid and Tanh are
+ * only meaningful for floating-point types; integer types pass through them.
+ */
+template <typename T> inline T cpuActivation(T x, ActType act) {
+    switch (act) {
+    case ActType::Relu:
+        return x > T(0) ? x : T(0);
+    case ActType::Sigmoid:
+        if constexpr (std::is_same_v<T, float>)
+            return sigmoidApprox(x);
+        else if constexpr (std::is_floating_point_v<T>)
+            return T(1) / (T(1) + std::exp(-x));
+        return x;
+    case ActType::Tanh:
+        if constexpr (std::is_same_v<T, float>)
+            return tanhApprox(x);
+        else if constexpr (std::is_floating_point_v<T>)
+            return std::tanh(x);
+        return x;
+    default:
+        return x;
+    }
+}
+
+/**
+ * @brief Work fused into the GEMM output tiles: C(i, j) = act(C(i, j) +
+ * bias(i, j)). It runs on each tile right after its last k block, so the
+ * output is written to memory only once.
+ */
+template <typename T> struct GemmEpilogue {
+    // bias(i, j) is `bias[i * biasRs + j * biasCs]`, a zero stride broadcasts
+    // the bias along that dimension. No bias is added if it is null.
+    const T *bias = nullptr;
+    int64_t biasRs = 0, biasCs = 0;
+    ActType act = ActType::None;
+
+    bool empty() const { return !bias && act == ActType::None; }
+};
+
+/**
+ * @brief Batched GEMM on the host, C[i] = op(A[i]) * op(B[i]) for every batch
+ * i in [0, b). All matrices are dense and row-major. op(A) is m x k and op(B)
+ * is k x n; when `transA` is true A is stored as k x m, and likewise B is
+ * stored as n x k when `transB` is true. C is a contiguous [b, m, n] tensor.
+ *
+ * The engine packs panels of A and B into cache-sized blocks and runs a
+ * register-tiled microkernel on them. The AVX-512 or AVX2 microkernel is
+ * picked at runtime on x86; other targets use a portable kernel. Output tiles
+ * of all batches are distributed over OpenMP threads.
+ *
+ * @param offsetA Element offset of A[i] from `A`, one per batch. It makes
+ * batch broadcasting free: broadcast batches simply repeat an offset.
+ * @param offsetB Element offset of B[i] from `B`, one per batch.
+ * @param epilogue Bias and activation applied to every C[i].
+ */
+template <typename T>
+void cpuGemmBatched(bool transA, bool transB, int b, int m, int n, int k,
+                    const T *A, const int64_t *offsetA, const T *B,
+                    const int64_t *offsetB, T *C,
+                    const GemmEpilogue<T> &epilogue = {});
+
+/**
+ * @brief Single GEMM, C = op(A) * op(B). See cpuGemmBatched.
+ */
+template <typename T>
+void cpuGemm(bool transA, bool transB, int m, int n, int k, const T *A,
+             const T *B, T *C, const GemmEpilogue<T> &epilogue = {}) {
+    const int64_t zero = 0;
+    cpuGemmBatched<T>(transA, transB, 1, m, n, k, A, &zero, B, &zero, C,
+                      epilogue);
+}
+
+} // namespace infini
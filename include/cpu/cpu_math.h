@@ -0,0 +1,166 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace infini {
+
+/**
+ * @brief exp(x) within 2 ulp over the normal range, without branches or
+ * calls, so that loops of it vectorize. Inputs under about -87.7, -inf
+ * included, give 0 and inputs over ln(FLT_MAX), about 88.72, give inf.
+ *
+ * x = n ln2 + r with |r| <= ln2 / 2, exp(r) is a polynomial and 2^n is
+ * written into the exponent bits.
+ */
+inline float expApprox(float x) {
+    x = x < -88.f ? -88.f : (x > 88.7228394f ? 88.7228394f : x);
+    // Rounds to nearest by pushing the fraction out of the mantissa
+    const float shift = 12582912.f;
+    float n = (x * 1.44269504088896341f + shift) - shift;
+    // ln2 in two parts, so that n * ln2 is exact
+    float r = x - n * 0.693359375f + n * 2.12194440e-4f;
+    float p = 1.9875691500e-4f;
+    p = p * r + 1.3981999507e-3f;
+    p = p * r + 8.3334519073e-3f;
+    p = p * r + 4.1665795894e-2f;
+    p = p * r + 1.6666665459e-1f;
+    p = p * r + 5.0000001201e-1f;
+    p = p * r * r + r + 1.f;
+    // n = -127 makes the exponent bits 0, which flushes to zero. 2^128 has
+    // no exponent bits, and is taken as 2^127 doubled.
+    const float top = n > 127.f ? 2.f : 1.f;
+    uint32_t bits = uint32_t(int32_t(n) + (top > 1.f ? 126 : 127)) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale * top;
+}
+
+/**
+ * @brief log(x) within 2 ulp, subnormals included. Gives -inf at 0, NaN
+ * below it and inf at inf.
+ *
+ * x = 2^e m with m in [sqrt(1/2), sqrt(2)), and log(m) is a polynomial.
+ */
+inline float logApprox(float x) {
+    const bool tiny = x < 1.17549435e-38f;
+    const float v = tiny ? x * 8388608.f : x;
+    uint32_t bits;
+    std::memcpy(&bits, &v, sizeof(bits));
+    float e = float(int32_t(bits >> 23) - 126) - (tiny ? 23.f : 0.f);
+    // m in [1/2, 1) first
+    bits = (bits & 0x007fffffu) | 0x3f000000u;
+    float m;
+    std::memcpy(&m, &bits, sizeof(m));
+    const bool low = m < 0.707106781186547524f;
+    e = low ? e - 1.f : e;
+    m = low ? m + m - 1.f : m - 1.f;
+    const float z = m * m;
+    float p = 7.0376836292e-2f;
+    p = p * m - 1.1514610310e-1f;
+    p = p * m + 1.1676998740e-1f;
+    p = p * m - 1.2420140846e-1f;
+    p = p * m + 1.4249322787e-1f;
+    p = p * m - 1.6668057665e-1f;
+    p = p * m + 2.0000714765e-1f;
+    p = p * m - 2.4999993993e-1f;
+    p = p * m + 3.3333331174e-1f;
+    // e ln2 in two parts, as in expApprox
+    const float y = m + (p * m * z - 2.12194440e-4f * e - 0.5f * z) +
+                    0.693359375f * e;
+    return x > 0.f ? (x < INFINITY ? y : x) : (x == 0.f ? -INFINITY : NAN);
+}
+
+/**
+ * @brief tanh(x) within 3 ulp. Near 0, where 1 - 2 / (exp(2|x|) + 1) would
+ * cancel, it is an odd polynomial instead.
+ */
+inline float tanhApprox(float x) {
+    const float a = x < 0.f ? -x : x;
+    const float z = x * x;
+    float p = -5.70498872745e-3f;
+    p = p * z + 2.06390887954e-2f;
+    p = p * z - 5.37397155531e-2f;
+    p = p * z + 1.33314422036e-1f;
+    p = p * z - 3.33332819422e-1f;
+    const float small = p * z * x + x;
+    const float large = 1.f - 2.f / (expApprox(2.f * a) + 1.f);
+    return a < 0.625f ? small : (x < 0.f ? -large : large);
+}
+
+/**
+ * @brief 1 / (1 + exp(-x)) within 3 ulp. For negative x it is taken as
+ * exp(x) / (1 + exp(x)), which underflows gracefully.
+ */
+inline float sigmoidApprox(float x) {
+    const float e = expApprox(x < 0.f ? x : -x);
+    const float s = 1.f / (1.f + e);
+    return x < 0.f ? e * s : s;
+}
+
+/**
+ * @brief erfc(a) for a >= 0 after Numerical Recipes' erfcc, within about
+ * 2e-7 relative for a under 1. Beyond, rounding the exponent of about -a^2
+ * costs up to a^2 * 1.2e-7 more.
+ */
+inline float erfcPositiveApprox(float a) {
+    const float t = 1.f / (1.f + 0.5f * a);
+    float p = 0.17087277f;
+    p = p * t - 0.82215223f;
+    p = p * t + 1.48851587f;
+    p = p * t - 1.13520398f;
+    p = p * t + 0.27886807f;
+    p = p * t - 0.18628806f;
+    p = p * t + 0.09678418f;
+    p = p * t + 0.37409196f;
+    p = p * t + 1.00002368f;
+    p = p * t - 1.26551223f;
+    return t * expApprox(p - a * a);
+}
+
+/**
+ * @brief erf(x) within about 2e-7 relative. Near 0, where 1 - erfc(|x|)
+ * would cancel, it is its Taylor series instead.
+ */
+inline float erfApprox(float x) {
+    const float a = x < 0.f ? -x : x;
+    const float z = x * x;
+    // The coefficients of x^(2k+1) are (-1)^k / (k! (2k + 1))
+    float p = -1.f / 1320;
+    p = p * z + 1.f / 216;
+    p = p * z - 1.f / 42;
+    p = p * z + 1.f / 10;
+    p = p * z - 1.f / 3;
+    p = p * z + 1.f;
+    // 2 / sqrt(pi)
+    const float small = 1.12837916709551257f * x * p;
+    const float large = 1.f - erfcPositiveApprox(a);
+    return a < 0.5f ? small : (x < 0.f ? -large : large);
+}
+
+/**
+ * @brief x Phi(x) = x erfc(-x / sqrt(2)) / 2. erfc is taken directly, so
+ * that the tail at negative x keeps its relative precision.
+ */
+inline float geluApprox(float x) {
+    const float a = (x < 0.f ? -x : x) * 0.707106781186547524f;
+    const float e = erfcPositiveApprox(a);
+    return 0.5f * x * (x < 0.f ? e : 2.f - e);
+}
+
+/**
+ * @brief y[i] = f(x[i]) for i < n, with f one of the functions above and
+ * exp overflowing to inf. `y` may be `x`.
+ *
+ * On x86-64, each is compiled for AVX-512, AVX2 with FMA and the baseline,
+ * and the version for the running CPU is picked when the library loads.
+ */
+void vecExp(const float *x, float *y, size_t n);
+void vecLog(const float *x, float *y, size_t n);
+void vecTanh(const float *x, float *y, size_t n);
+void vecSigmoid(const float *x, float *y, size_t n);
+void vecErf(const float *x, float *y, size_t n);
+void vecGelu(const float *x, float *y, size_t n);
+
+} // namespace infini
@@ -0,0 +1,52 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief Scaled dot-product attention, softmax(Q K^T * scale + mask) V, over
+ * the last two dims. The scores are never stored in full: the CPU kernel
+ * streams blocks of keys through an online softmax, so its memory does not
+ * grow with the product of the sequence lengths.
+ *
+ * The query is [..., seqQ, dim], the key [..., seqK, dim], or [..., dim,
+ * seqK] if `transK`, and the value [..., seqK, dimV], all with the same
+ * leading dims. The optional mask is added to the scores, and broadcasts to
+ * [..., seqQ, seqK] along the NumPy rules.
+ */
+class AttentionObj : public OperatorObj {
+    float scale;
+    bool transK;
+
+  public:
+    /**
+     * @brief Construct a new Attention object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param query The query tensor.
+     * @param key The key tensor.
+     * @param value The value tensor.
+     * @param output The output tensor, of shape [..., seqQ, dimV].
+     * @param scale The factor of the scores, which is commonly 1 / sqrt(dim).
+     * @param transK If the key is stored as [..., dim, seqK].
+     * @param mask The additive mask, or nullptr.
+     */
+    AttentionObj(GraphObj *graph, Tensor query, Tensor key, Tensor value,
+                 Tensor output, float scale, bool transK = false,
+                 Tensor mask = nullptr);
+    OP_CLONE(AttentionObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+
+    float getScale() const { return scale; }
+    bool getTransK() const { return transK; }
+    Tensor getMask() const { return inputs.size() > 3 ? inputs[3] : nullptr; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+} // namespace infini
@@ -40,6 +40,7 @@ class BatchNormObj : public OperatorObj {
     // output size will be 3 when training
     int numInputs() const override { return 5; }
     int numOutputs() const override { return outputs.size(); }
+    vector<int> getInplaceInputs() const override;
     float getMomentum() const { return momentum; }
     float getEps() const { return eps; }
     bool getTrainingMode() const { return trainingMode; }
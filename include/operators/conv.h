@@ -95,10 +95,10 @@ class ConvBaseObj : public OperatorObj {
                 ActType act = ActType::None);
 
     std::string toString() const override;
-    int numInputs() const override { return 2; }
+    int numInputs() const override { return inputs.size(); }
     int numOutputs() const override { return 1; }
 
-    Tensor getBias() const { return inputs[2]; }
+    Tensor getBias() const { return inputs.size() > 2 ? inputs[2] : nullptr; }
     PaddingMode getPaddingMode() const { return padding; }
     pair<int, int> inferPaddingSize() const;
 
@@ -119,6 +119,9 @@ class ConvBaseObj : public OperatorObj {
     }
     ActType getAct() const { return act; }
     virtual int getNumGroups() const = 0;
+    void updateShapeAttributes(const vector<Shape> &) override {
+        setAuxilaryAttributes(padding);
+    }
 
   private:
     vector<int> getWorkloadVector() const override;
@@ -26,6 +26,7 @@ class ElementWiseObj : public OperatorObj {
     std::string toString() const override;
     int numInputs() const override { return 2; }
     int numOutputs() const override { return 1; }
+    vector<int> getInplaceInputs() const override;
 
   private:
     vector<int> getWorkloadVector() const override;
@@ -70,6 +71,7 @@ DEFINE_ELEMENT_WISE_OBJ(Minimum, OpType::Min)
 DEFINE_ELEMENT_WISE_OBJ(Power, OpType::Pow)
 DEFINE_ELEMENT_WISE_OBJ(FloorDiv, OpType::FloorDiv)
 DEFINE_ELEMENT_WISE_OBJ(FloorMod, OpType::FloorMod)
+DEFINE_ELEMENT_WISE_OBJ(Mod, OpType::Mod)
 DEFINE_ELEMENT_WISE_OBJ(SquaredDifference, OpType::SquaredDifference)
 DEFINE_ELEMENT_WISE_OBJ(Equal, OpType::Equal)
 DEFINE_ELEMENT_WISE_OBJ(GreaterThan, OpType::Greater)
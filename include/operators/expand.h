@@ -22,6 +22,7 @@ class ExpandObj : public OperatorObj {
     ExpandObj(GraphObj *graph, Tensor input, Tensor output, Shape dims);
     OP_CLONE(ExpandObj);
     optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+    void updateShapeAttributes(const vector<Shape> &oldInputShapes) override;
 
     std::string toString() const override;
     int numInputs() const override { return 1; }
@@ -0,0 +1,58 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief A chain of element-wise operators evaluated in a single pass over
+ * memory. It is created by GraphObj::fuseOperators rather than by frontends.
+ *
+ * The running value starts as the first input, and every step applies one
+ * unary or binary operator to it. The other operand of a binary step is one
+ * of the remaining inputs, which has the shape of the output or a single
+ * element.
+ */
+class FusedElementWiseObj : public OperatorObj {
+  public:
+    struct Step {
+        OpType type;
+        // Index of the other operand of a binary step, or -1 if unary
+        int input;
+        // If the running value is the right operand of a binary step
+        bool reversed;
+    };
+
+  private:
+    vector<Step> steps;
+
+  public:
+    /**
+     * @brief Construct a new FusedElementWise object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param inputs The running value, followed by the other operands of the
+     * binary steps.
+     * @param output The output tensor, which has the shape of inputs[0].
+     * @param steps The operators to apply, in order.
+     */
+    FusedElementWiseObj(GraphObj *graph, TensorVec inputs, Tensor output,
+                        vector<Step> steps);
+    OP_CLONE(FusedElementWiseObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    const vector<Step> &getSteps() const { return steps; }
+    vector<int> getInplaceInputs() const override;
+
+    /**
+     * @brief Whether an operator of `type` can be a step.
+     */
+    static bool isFusable(OpType type);
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+} // namespace infini
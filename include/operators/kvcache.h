@@ -0,0 +1,79 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief Write new rows into a KV cache at a position, in place. Only the new
+ * rows are copied, so a decoding step costs O(new tokens) instead of
+ * O(context).
+ *
+ * The cache is a kvcache tensor of shape [..., maxLength, dim], and the rows
+ * are [..., n, dim] with the same leading dims. The output is the cache after
+ * the update and shares its memory, so the ops reading the cache read the
+ * output, which orders them after the append.
+ */
+class KVCacheAppendObj : public OperatorObj {
+  public:
+    /**
+     * @brief Construct a new KVCacheAppend object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param cache The kvcache tensor to update.
+     * @param input The new rows.
+     * @param position A single Int32 or Int64 element, the row of the cache
+     * taking the first new row.
+     * @param output The updated cache.
+     */
+    KVCacheAppendObj(GraphObj *graph, Tensor cache, Tensor input,
+                     Tensor position, Tensor output);
+    OP_CLONE(KVCacheAppendObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 3; }
+    int numOutputs() const override { return 1; }
+    bool isInplaceUpdate() const override { return true; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+/**
+ * @brief Causal attention of new queries over a KV cache, which reads only
+ * the valid prefix of the cache.
+ *
+ * The queries are [batch, heads, n, dim] and the caches [batch, kvHeads,
+ * maxLength, dim], where kvHeads divides heads. Query i sits at position
+ * `position + i`, and attends to the cache rows up to it with the scale
+ * 1 / sqrt(dim).
+ */
+class AttentionKVCacheObj : public OperatorObj {
+  public:
+    /**
+     * @brief Construct a new AttentionKVCache object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param query The queries of the new tokens.
+     * @param keyCache The key cache, including the keys of the new tokens.
+     * @param valueCache The value cache, including the values of the new
+     * tokens.
+     * @param position A single Int32 or Int64 element, the position of the
+     * first new token.
+     * @param output The output tensor, which has the shape of `query`.
+     */
+    AttentionKVCacheObj(GraphObj *graph, Tensor query, Tensor keyCache,
+                        Tensor valueCache, Tensor position, Tensor output);
+    OP_CLONE(AttentionKVCacheObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 4; }
+    int numOutputs() const override { return 1; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+} // namespace infini
@@ -0,0 +1,92 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief Whether `param` holds one value per normalized element, with the
+ * trailing dims of `dims` from `axis` on, as the parameters of LayerNorm and
+ * RMSNorm do.
+ */
+bool isNormalizedShape(const Shape &dims, int axis, const Tensor &param);
+
+/**
+ * @brief Layer normalization over the dims from `axis` on, as in ONNX
+ * LayerNormalization: (x - mean) / sqrt(var + eps) * scale + bias.
+ *
+ * The scale and the bias have the normalized dims, possibly with fewer
+ * leading dims of 1.
+ */
+class LayerNormObj : public OperatorObj {
+    float eps;
+    int axis;
+
+  public:
+    /**
+     * @brief Construct a new LayerNorm object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param input The input tensor.
+     * @param scale The scale of the normalized values.
+     * @param output The output tensor.
+     * @param bias The bias added after scaling, or nullptr.
+     * @param eps The epsilon added to the variance.
+     * @param axis The first normalized dim.
+     */
+    LayerNormObj(GraphObj *graph, Tensor input, Tensor scale, Tensor output,
+                 Tensor bias = nullptr, float eps = 1e-5, int axis = -1);
+    OP_CLONE(LayerNormObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return inputs.size(); }
+    int numOutputs() const override { return 1; }
+    vector<int> getInplaceInputs() const override { return {0}; }
+
+    float getEps() const { return eps; }
+    int getAxis() const { return axis; }
+    Tensor getBias() const { return inputs.size() > 2 ? inputs[2] : nullptr; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+/**
+ * @brief Root mean square normalization over the dims from `axis` on:
+ * x / sqrt(mean(x^2) + eps) * weight. Unlike LayerNorm, the mean is not
+ * subtracted and there is no bias.
+ */
+class RMSNormObj : public OperatorObj {
+    float eps;
+    int axis;
+
+  public:
+    /**
+     * @brief Construct a new RMSNorm object.
+     *
+     * @param graph The computation graph that this operator belongs to.
+     * @param input The input tensor.
+     * @param weight The scale of the normalized values.
+     * @param output The output tensor.
+     * @param eps The epsilon added to the mean square.
+     * @param axis The first normalized dim.
+     */
+    RMSNormObj(GraphObj *graph, Tensor input, Tensor weight, Tensor output,
+               float eps = 1e-6, int axis = -1);
+    OP_CLONE(RMSNormObj);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 2; }
+    int numOutputs() const override { return 1; }
+    vector<int> getInplaceInputs() const override { return {0}; }
+
+    float getEps() const { return eps; }
+    int getAxis() const { return axis; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+} // namespace infini
@@ -46,6 +46,7 @@ class MatmulObj : public OperatorObj {
 
     std::string toString() const override;
     optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+    void updateShapeAttributes(const vector<Shape> &) override;
 
     int numInputs() const override { return inputs.size(); }
     int numOutputs() const override { return 1; }
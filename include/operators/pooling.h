@@ -42,6 +42,7 @@ class PoolingObj : public OperatorObj {
     OP_CLONE(PoolingObj);
 
     optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+    void updateShapeAttributes(const vector<Shape> &) override;
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
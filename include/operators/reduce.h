@@ -0,0 +1,69 @@
+#pragma once
+#include "core/operator.h"
+
+namespace infini {
+/**
+ * @brief Reduce the input tensor's elements along certain axes, the base of
+ * ReduceSum, ReduceMean, ReduceMax and the other reductions.
+ *
+ */
+class ReduceBaseObj : public OperatorObj {
+  protected:
+    set<int> axes; // axis to reduce
+    bool keepDims;
+
+  public:
+    /**
+     * @brief Construct a new Reduce object.
+     *
+     * @param type The reduction, one of the Reduce op types.
+     * @param graph The computation graph that this operator belongs to.
+     * @param input The input tensor.
+     * @param output The output tensor.
+     * @param axes Axes to reduce. If it is absent or empty, all the axes are
+     * reduced, unless `noopWithEmptyAxes` is set.
+     * @param keepDims Keep the reduced dimensions or not.
+     * @param noopWithEmptyAxes Reduce nothing for absent or empty `axes`, so
+     * that the output is the input, as in ONNX.
+     */
+    ReduceBaseObj(OpType type, GraphObj *graph, Tensor input, Tensor output,
+                  const optional<vector<int>> &axes, bool keepDims,
+                  bool noopWithEmptyAxes);
+    optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+
+    std::string toString() const override;
+    int numInputs() const override { return 1; }
+    int numOutputs() const override { return 1; }
+
+    bool isReduced(int idx) const;
+    const set<int> &getAxes() const { return axes; }
+    bool getKeepDims() const { return keepDims; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
+};
+
+#define DEFINE_REDUCE_OBJ(prefix, type)                                        \
+    class prefix##Obj : public ReduceBaseObj {                                 \
+      public:                                                                  \
+        prefix##Obj(GraphObj *graph, Tensor input, Tensor output,              \
+                    const optional<vector<int>> &axes, bool keepDims = true,   \
+                    bool noopWithEmptyAxes = false)                            \
+            : ReduceBaseObj(type, graph, input, output, axes, keepDims,        \
+                            noopWithEmptyAxes) {}                              \
+        OP_CLONE(prefix##Obj);                                                 \
+    };
+
+DEFINE_REDUCE_OBJ(ReduceL1, OpType::ReduceL1)
+DEFINE_REDUCE_OBJ(ReduceL2, OpType::ReduceL2)
+DEFINE_REDUCE_OBJ(ReduceLogSum, OpType::ReduceLogSum)
+DEFINE_REDUCE_OBJ(ReduceLogSumExp, OpType::ReduceLogSumExp)
+DEFINE_REDUCE_OBJ(ReduceMax, OpType::ReduceMax)
+DEFINE_REDUCE_OBJ(ReduceMean, OpType::ReduceMean)
+DEFINE_REDUCE_OBJ(ReduceMin, OpType::ReduceMin)
+DEFINE_REDUCE_OBJ(ReduceProd, OpType::ReduceProd)
+DEFINE_REDUCE_OBJ(ReduceSum, OpType::ReduceSum)
+DEFINE_REDUCE_OBJ(ReduceSumSquare, OpType::ReduceSumSquare)
+
+} // namespace infini
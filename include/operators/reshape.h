@@ -23,10 +23,12 @@ class ReshapeObj : public OperatorObj {
     OP_CLONE(ReshapeObj);
 
     optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+    void updateShapeAttributes(const vector<Shape> &oldInputShapes) override;
 
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    bool isView() const override { return true; }
 
     inline Shape getShape() const { return dims; }
 
@@ -60,6 +62,7 @@ class FlattenObj : public OperatorObj {
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    bool isView() const override { return true; }
     int getAxis() const { return axis; }
 
   private:
@@ -90,6 +93,7 @@ class IdentityObj : public OperatorObj {
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    bool isView() const override { return true; }
 
   private:
     vector<int> getWorkloadVector() const override;
@@ -9,6 +9,10 @@ namespace infini {
 class SliceObj : public OperatorObj {
     template <class T> struct range_t { T start, end, step; };
     vector<range_t<int>> axes;
+    // The slice arguments, resolved into `axes` for the input shape
+    vector<int> starts, ends, steps;
+    // The index in the arguments of each input dim, -1 if it is not sliced
+    vector<int> sliceOf;
 
   public:
     /**
@@ -33,6 +37,7 @@ class SliceObj : public OperatorObj {
     OP_CLONE(SliceObj);
 
     optional<vector<Shape>> inferShape(const TensorVec &inputs) const override;
+    void updateShapeAttributes(const vector<Shape> &) override;
     std::string toString() const override;
     inline int numInputs() const override { return 1; }
     inline int numOutputs() const override { return 1; }
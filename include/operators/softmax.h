@@ -2,9 +2,16 @@
 #include "core/operator.h"
 
 namespace infini {
+/**
+ * @brief Softmax along `axis`, exp(x) / sum(exp(x)).
+ */
 class SoftmaxObj : public OperatorObj {
     int axis;
 
+  protected:
+    SoftmaxObj(OpType type, GraphObj *graph, Tensor input, Tensor output,
+               int axis);
+
   public:
     SoftmaxObj(GraphObj *graph, Tensor input, Tensor output, int axis);
 
@@ -17,6 +24,7 @@ class SoftmaxObj : public OperatorObj {
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    vector<int> getInplaceInputs() const override { return {0}; }
 
     int getAxis() const { return axis; }
 
@@ -24,4 +32,14 @@ class SoftmaxObj : public OperatorObj {
     vector<int> getWorkloadVector() const override;
     vector<int> getOpAttrVector() const override;
 };
+
+/**
+ * @brief LogSoftmax along `axis`, x - log(sum(exp(x))).
+ */
+class LogSoftmaxObj : public SoftmaxObj {
+  public:
+    LogSoftmaxObj(GraphObj *graph, Tensor input, Tensor output, int axis);
+
+    OP_CLONE(LogSoftmaxObj);
+};
 } // namespace infini
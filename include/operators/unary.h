@@ -22,6 +22,7 @@ class UnaryObj : public OperatorObj {
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    vector<int> getInplaceInputs() const override { return {0}; }
 
   private:
     vector<int> getWorkloadVector() const override;
@@ -40,6 +41,7 @@ class ClipObj : public OperatorObj {
     std::optional<float> getMax() const { return maxValue; };
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+    vector<int> getInplaceInputs() const override { return {0}; }
 
   private:
     std::optional<float> minValue, maxValue;
@@ -210,6 +212,10 @@ class ShapeObj : public OperatorObj {
     std::string toString() const override;
     int numInputs() const override { return 1; }
     int numOutputs() const override { return 1; }
+
+  private:
+    vector<int> getWorkloadVector() const override;
+    vector<int> getOpAttrVector() const override;
 };
 
 class PReluObj : public OperatorObj {
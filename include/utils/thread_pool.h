@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace infini {
+
+/**
+ * @brief A fixed set of worker threads, each with its own task queue. A task
+ * submitted by a worker goes to the back of its queue, which the worker
+ * serves first, and a task submitted from outside to the front, so that a
+ * single worker runs those in the order they came. Idle workers steal from
+ * the front of the others' queues.
+ */
+class ThreadPool {
+  public:
+    using Task = std::function<void()>;
+
+  private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    // Number of tasks in the queues
+    std::atomic<size_t> queued{0};
+    // Next queue for the tasks submitted from outside the pool
+    std::atomic<size_t> next{0};
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    bool stopping = false;
+
+  public:
+    /**
+     * @param threads The number of workers.
+     * @param init Called by each worker with its index before serving tasks.
+     */
+    explicit ThreadPool(int threads, std::function<void(int)> init = nullptr);
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    int size() const { return workers.size(); }
+
+    void submit(Task task);
+
+  private:
+    void work(int index);
+    bool pop(int index, Task &task);
+};
+
+} // namespace infini
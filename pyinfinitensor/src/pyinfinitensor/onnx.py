@@ -13,6 +13,7 @@ from onnx.helper import (
     make_tensor,
     make_graph,
     make_model,
+    tensor_dtype_to_np_dtype,
 )
 from onnx.checker import (
     check_graph,
@@ -28,6 +29,7 @@ from typing import Dict, List, Any, Tuple, Sequence, Union, Optional
 from functools import reduce
 from onnxsim import simplify
 import copy
+import numpy as np
 import warnings
 
 
@@ -71,6 +73,9 @@ class OnnxStub:
                     dims, input.type.tensor_type.elem_type
                 )
                 tensors[input.name].set_input()
+                for i, d in enumerate(input.type.tensor_type.shape.dim):
+                    if d.dim_param:
+                        tensors[input.name].set_dim_symbol(i, d.dim_param)
 
         for output in model.graph.output:
             dims = _take_shape_dim(output.type.tensor_type.shape)
@@ -235,6 +240,33 @@ class OnnxStub:
                         eps,
                         training != 0,
                     )
+                elif node.op_type == "LayerNormalization":
+                    # The mean and inverse std outputs are for training
+                    assert all(name == "" for name in node.output[1:])
+                    attributes = _parse_attribute(
+                        node, {"axis": -1, "epsilon": 1e-05}
+                    )
+                    tensors[node.output[0]] = self.handler.layerNormalization(
+                        tensors[node.input[0]],
+                        tensors[node.input[1]],
+                        tensors.get(node.output[0]),
+                        tensors[node.input[2]]
+                        if len(node.input) > 2 and node.input[2] != ""
+                        else None,
+                        attributes["epsilon"],
+                        attributes["axis"],
+                    )
+                elif node.op_type == "RMSNormalization":
+                    attributes = _parse_attribute(
+                        node, {"axis": -1, "epsilon": 1e-05}
+                    )
+                    tensors[node.output[0]] = self.handler.rmsNorm(
+                        tensors[node.input[0]],
+                        tensors[node.input[1]],
+                        tensors.get(node.output[0]),
+                        attributes["epsilon"],
+                        attributes["axis"],
+                    )
                 elif node.op_type == "MaxPool":
                     attributes = _parse_attribute(
                         node,
@@ -421,8 +453,12 @@ class OnnxStub:
                         tensors[node.input[0]],
                         tensors.get(node.output[0]),
                     )
-                elif node.op_type == "Softmax":
-                    tensors[node.output[0]] = self.handler.softmax(
+                elif node.op_type in ["Softmax", "LogSoftmax"]:
+                    tensors[node.output[0]] = (
+                        self.handler.softmax
+                        if node.op_type == "Softmax"
+                        else self.handler.log_softmax
+                    )(
                         tensors[node.input[0]],
                         tensors.get(node.output[0]),
                         next(
@@ -583,26 +619,54 @@ class OnnxStub:
                             0,
                         ),
                     )
-                elif node.op_type == "ReduceMean":
-                    tensors[node.output[0]] = self.handler.reduce_mean(
+                elif node.op_type in [
+                    "ReduceL1",
+                    "ReduceL2",
+                    "ReduceLogSum",
+                    "ReduceLogSumExp",
+                    "ReduceMax",
+                    "ReduceMean",
+                    "ReduceMin",
+                    "ReduceProd",
+                    "ReduceSum",
+                    "ReduceSumSquare",
+                ]:
+                    # `axes` is an attribute until opset version 13 or 18, and
+                    # an optional input afterwards
+                    axes = next(
+                        (attr.ints for attr in node.attribute if attr.name == "axes"),
+                        None,
+                    )
+                    if axes is None and len(node.input) > 1 and node.input[1] != "":
+                        axes = _parse_data(data[node.input[1]])
+                    reduce = getattr(
+                        self.handler,
+                        "reduce_"
+                        + "".join(
+                            "_" + c.lower() if c.isupper() else c
+                            for c in node.op_type[len("Reduce") :]
+                        )[1:],
+                    )
+                    tensors[node.output[0]] = reduce(
                         tensors[node.input[0]],
                         tensors.get(node.output[0]),
-                        # NOTE(constroy): `axes` is an attribute until opset version 13.
+                        axes,
                         next(
                             (
-                                attr.ints
+                                attr.i
                                 for attr in node.attribute
-                                if attr.name == "axes"
+                                if attr.name == "keepdims"
                             ),
-                            None,
-                        ),
+                            1,
+                        )
+                        != 0,
                         next(
                             (
                                 attr.i
                                 for attr in node.attribute
-                                if attr.name == "keepdims"
+                                if attr.name == "noop_with_empty_axes"
                             ),
-                            1,
+                            0,
                         )
                         != 0,
                     )
@@ -908,12 +972,30 @@ class OnnxStub:
                     )
                 )
             elif ty == backend.OpTypeId.MatMul:
-                transA, transB = backend.matmul_attrs_of(op)
+                transA, transB, act = backend.matmul_attrs_of(op)
+                if act == backend.ActType.Linear:
+                    gemm_outputs = outputs
+                else:
+                    gemm_outputs = ["{}_gemm".format(name)]
                 ctx.push_node(
                     make_node(
-                        "Gemm", inputs, outputs, name, transA=transA, transB=transB
+                        "Gemm",
+                        inputs,
+                        gemm_outputs,
+                        name,
+                        transA=transA,
+                        transB=transB,
                     )
                 )
+                if act != backend.ActType.Linear:
+                    ctx.push_node(
+                        make_node(
+                            act.name,
+                            gemm_outputs,
+                            outputs,
+                            "{}_{}".format(name, act.name),
+                        )
+                    )
             elif ty == backend.OpTypeId.BatchNormalization:
                 inputs = [inputs[i] for i in [0, 3, 4, 1, 2]]
                 momentum, eps, training = backend.batch_norm_attrs_of(op)
@@ -928,6 +1010,23 @@ class OnnxStub:
                         training_mode=training,
                     )
                 )
+            elif ty in [
+                backend.OpTypeId.LayerNormalization,
+                backend.OpTypeId.RMSNorm,
+            ]:
+                eps, axis = backend.norm_attrs_of(op)
+                ctx.push_node(
+                    make_node(
+                        "LayerNormalization"
+                        if ty == backend.OpTypeId.LayerNormalization
+                        else "RMSNormalization",
+                        inputs,
+                        outputs,
+                        name,
+                        epsilon=eps,
+                        axis=axis,
+                    )
+                )
             elif ty == backend.OpTypeId.MaxPool:
                 kh, kw, dh, dw, ph, pw, sh, sw, ceil_mode = backend.pool_attrs_of(op)
                 ctx.push_node(
@@ -969,7 +1068,6 @@ class OnnxStub:
                 backend.OpTypeId.HardSigmoid,
                 backend.OpTypeId.HardSwish,
                 backend.OpTypeId.Tanh,
-                backend.OpTypeId.Softmax,
                 backend.OpTypeId.Abs,
                 backend.OpTypeId.Identity,
                 backend.OpTypeId.PRelu,
@@ -978,6 +1076,9 @@ class OnnxStub:
                 backend.OpTypeId.Neg,
             ]:
                 ctx.push_node(make_node(ty.name, inputs, outputs, name))
+            elif ty in [backend.OpTypeId.Softmax, backend.OpTypeId.LogSoftmax]:
+                axis = backend.softmax_axis_of(op)
+                ctx.push_node(make_node(ty.name, inputs, outputs, name, axis=axis))
             elif ty == backend.OpTypeId.Flatten:
                 axis = backend.flatten_axis_of(op)
                 ctx.push_node(make_node(ty.name, inputs, outputs, name, axis=axis))
@@ -1024,15 +1125,33 @@ class OnnxStub:
             elif ty == backend.OpTypeId.Gather:
                 axis = backend.gather_axis_of(op)
                 ctx.push_node(make_node(ty.name, inputs, outputs, name, axis=axis))
-            elif ty == backend.OpTypeId.ReduceMean:
-                axes, keepdims = backend.reduce_mean_attrs_of(op)
+            elif ty in [
+                backend.OpTypeId.ReduceL1,
+                backend.OpTypeId.ReduceL2,
+                backend.OpTypeId.ReduceLogSum,
+                backend.OpTypeId.ReduceLogSumExp,
+                backend.OpTypeId.ReduceMax,
+                backend.OpTypeId.ReduceMean,
+                backend.OpTypeId.ReduceMin,
+                backend.OpTypeId.ReduceProd,
+                backend.OpTypeId.ReduceSum,
+                backend.OpTypeId.ReduceSumSquare,
+            ]:
+                axes, keepdims = backend.reduce_attrs_of(op)
                 inputs.append(
                     ctx.push_data_input(
                         name, "axes", TensorProto.INT64, [len(axes)], axes
                     )
                 )
                 ctx.push_node(
-                    make_node(ty.name, inputs, outputs, name, keepdims=keepdims)
+                    make_node(
+                        ty.name,
+                        inputs,
+                        outputs,
+                        name,
+                        keepdims=keepdims,
+                        noop_with_empty_axes=len(axes) == 0,
+                    )
                 )
             elif ty == backend.OpTypeId.Slice:
                 raise Exception("TODO")
@@ -1090,10 +1209,120 @@ class OnnxStub:
     def run(self) -> None:
         self.handler.run()
 
+    def set_symbols(self, **sizes: int) -> None:
+        """Give the symbolic dims of the inputs, named after their dim_param,
+        new sizes without building the graph again. The memory and kernel
+        plans are cached per power-of-two bucket of the sizes."""
+        self.handler.set_symbols(sizes)
+
+    def symbols(self) -> Dict[str, int]:
+        return self.handler.symbols()
+
+    def instantiate(self) -> "OnnxStub":
+        """An executable copy sharing the weights, so that copies can run
+        on different threads at once. The graph must be initialized."""
+        stub = copy.copy(self)
+        stub.handler = self.handler.instantiate()
+        tensors = {}
+        for op in stub.handler.operators():
+            for tensor in op.inputs() + op.outputs():
+                tensors[tensor.fuid()] = tensor
+        stub.inputs = {k: tensors[v.fuid()] for k, v in self.inputs.items()}
+        stub.outputs = {k: tensors[v.fuid()] for k, v in self.outputs.items()}
+        return stub
+
+    def init_io_buffers(self, n: int) -> None:
+        """Allocate n slots of staging buffers for the inputs and outputs,
+        so that a request is copied into one slot while another one runs."""
+        self.handler.init_io_buffers(n)
+
+    def io_buffer(self, name: str, slot: int) -> backend.Tensor:
+        tensor = self.inputs.get(name)
+        if tensor is None:
+            tensor = self.outputs[name]
+        return self.handler.io_buffer(tensor, slot)
+
+    def run_async(self, slot: int = -1) -> backend.RunFuture:
+        """Run in the background without holding the GIL, after the runs
+        submitted before. Call wait() on the result to get the outputs."""
+        return self.handler.run_async(slot)
+
     def get_perf_time(self) -> float:
         self.handler.get_perf_time()
 
 
+class BatchScheduler:
+    """
+    Coalesces single-sample requests into batches, run by a C++ thread on
+    initialized stubs of the same model built for different batch sizes.
+    A batch starts once the largest stub is full, or once its oldest request
+    has waited for max_delay_us. The stubs share the weights of the smallest
+    one, whose memory the others release.
+    """
+
+    def __init__(self, stubs: List[OnnxStub], max_delay_us: int):
+        self.input_names = list(stubs[0].inputs.keys())
+        self.output_names = list(stubs[0].outputs.keys())
+        self.output_types = [
+            (tensor_dtype_to_np_dtype(backend.tensor_dtype(t)), t.shape()[1:])
+            for t in stubs[0].outputs.values()
+        ]
+        self.scheduler = backend.BatchScheduler(
+            [
+                (
+                    stub.handler,
+                    [stub.inputs[name] for name in self.input_names],
+                    [stub.outputs[name] for name in self.output_names],
+                )
+                for stub in stubs
+            ],
+            max_delay_us,
+        )
+
+    def submit(self, inputs: Dict[str, Any]) -> "BatchRequest":
+        """Queue a sample given as arrays without the batch dim."""
+        return BatchRequest(
+            self,
+            self.scheduler.submit(
+                [np.ascontiguousarray(inputs[name]) for name in self.input_names]
+            ),
+        )
+
+    def queue_depth(self) -> int:
+        return self.scheduler.queue_depth()
+
+    def latency_histogram(self) -> List[int]:
+        """Element i counts the requests taking [2^i, 2^(i+1)) us."""
+        return self.scheduler.latency_histogram()
+
+    def latency_percentile(self, q: float) -> float:
+        return self.scheduler.latency_percentile(q)
+
+    def batch_counts(self) -> List[int]:
+        """Element i counts the batches run with i requests."""
+        return self.scheduler.batch_counts()
+
+
+class BatchRequest:
+    def __init__(self, scheduler: BatchScheduler, future: backend.BatchFuture):
+        self.scheduler = scheduler
+        self.future = future
+
+    def done(self) -> bool:
+        return self.future.done()
+
+    def get(self) -> Dict[str, Any]:
+        """Wait for the outputs without holding the GIL."""
+        return {
+            name: np.frombuffer(data, dtype).reshape(shape)
+            for name, data, (dtype, shape) in zip(
+                self.scheduler.output_names,
+                self.future.get(),
+                self.scheduler.output_types,
+            )
+        }
+
+
 def from_onnx(model: ModelProto, runtime):
     stub = OnnxStub(model, runtime)
     return stub.inputs, stub.outputs, stub.handler
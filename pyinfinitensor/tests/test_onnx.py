@@ -110,6 +110,18 @@ class TestStringMethods(unittest.TestCase):
         gemm = make_node("Gemm", ["a", "b", "c"], ["y"], transB=1, name="gemm")
         make_and_import_model(make_graph([gemm], "gemm", [a, b, c], [y]))
 
+    def test_matmul_add_relu(self):
+        x = make_tensor_value_info("x", TensorProto.FLOAT, [1, 2, 3])
+        a = make_tensor_value_info("a", TensorProto.FLOAT, [1, 3, 4])
+        bias = make_tensor("bias", TensorProto.FLOAT, [4], [0.0, 1.0, 2.0, 3.0])
+        y = make_tensor_value_info("y", TensorProto.FLOAT, [1, 2, 4])
+        matmul = make_node("MatMul", ["x", "a"], ["xa"], name="matmul")
+        add = make_node("Add", ["xa", "bias"], ["xab"], name="add")
+        relu = make_node("Relu", ["xab"], ["y"], name="relu")
+        make_and_import_model(
+            make_graph([matmul, add, relu], "matmul_add_relu", [x, a], [y], [bias])
+        )
+
     def test_batch_norm(self):
         x = make_tensor_value_info("x", TensorProto.UINT32, [1, 3, 2, 2])
         scale = make_tensor_value_info("scale", TensorProto.FLOAT, [3])
@@ -127,6 +139,20 @@ class TestStringMethods(unittest.TestCase):
             make_graph([batch_norm], "batchNormalzation", [x, scale, b, mean, var], [y])
         )
 
+    def test_layer_norm(self):
+        x = make_tensor_value_info("x", TensorProto.FLOAT, [2, 5, 8])
+        scale = make_tensor_value_info("scale", TensorProto.FLOAT, [8])
+        bias = make_tensor_value_info("bias", TensorProto.FLOAT, [8])
+        y = make_tensor_value_info("y", TensorProto.FLOAT, [2, 5, 8])
+        norm = make_node(
+            "LayerNormalization",
+            ["x", "scale", "bias"],
+            ["y"],
+            epsilon=1e-6,
+            name="layerNorm",
+        )
+        make_and_import_model(make_graph([norm], "layerNorm", [x, scale, bias], [y]))
+
     def test_max_pool(self):
         x = make_tensor_value_info("x", TensorProto.UINT32, [1, 64, 162, 162])
         y = make_tensor_value_info("y", TensorProto.UINT32, [1, 64, 80, 80])
@@ -258,6 +284,12 @@ class TestStringMethods(unittest.TestCase):
         softmax = make_node("Softmax", ["x"], ["y"], axis=2, name="softmax")
         make_and_import_model(make_graph([softmax], "softmax", [x], [y]))
 
+    def test_log_softmax(self):
+        x = make_tensor_value_info("x", TensorProto.FLOAT, [1, 3, 5, 7])
+        y = make_tensor_value_info("y", TensorProto.FLOAT, [1, 3, 5, 7])
+        logSoftmax = make_node("LogSoftmax", ["x"], ["y"], axis=1, name="logSoftmax")
+        make_and_import_model(make_graph([logSoftmax], "logSoftmax", [x], [y]))
+
     def test_abs(self):
         x = make_tensor_value_info("x", TensorProto.FLOAT, [1, 3, 5, 7])
         y = make_tensor_value_info("y", TensorProto.FLOAT, [1, 3, 5, 7])
@@ -337,6 +369,17 @@ class TestStringMethods(unittest.TestCase):
         )
         make_and_import_model(make_graph([reduceMean], "reduceMean", [data], [reduced]))
 
+    def test_reduce_sum(self):
+        data = make_tensor_value_info("data", TensorProto.FLOAT, [2, 3, 3, 4])
+        reduced = make_tensor_value_info("reduced", TensorProto.FLOAT, [2, 3])
+        axes = make_tensor("axes", TensorProto.INT64, [2], [1, 3])
+        reduceSum = make_node(
+            "ReduceSum", ["data", "axes"], ["reduced"], keepdims=0, name="reduceSum"
+        )
+        make_and_import_model(
+            make_graph([reduceSum], "reduceSum", [data], [reduced], [axes])
+        )
+
     def test_slice(self):
         data = make_tensor_value_info("data", TensorProto.UINT32, [10, 64, 162, 162])
         output = make_tensor_value_info("output", TensorProto.UINT32, [1, 1, 99, 95])
@@ -0,0 +1,193 @@
+#include "core/batch_scheduler.h"
+#include "core/runtime.h"
+#include <cmath>
+
+namespace infini {
+
+void LatencyHistogram::record(std::chrono::microseconds latency) {
+    auto us = std::max<int64_t>(latency.count(), 0);
+    size_t bucket = 0;
+    while (bucket + 1 < counts.size() && (int64_t(2) << bucket) <= us)
+        ++bucket;
+    ++counts[bucket];
+    ++total;
+    sumUs += us;
+}
+
+double LatencyHistogram::percentile(double q) const {
+    IT_ASSERT(0 <= q && q <= 1);
+    uint64_t rank = std::ceil(q * total), seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen > 0 && seen >= rank)
+            return double(int64_t(2) << i);
+    }
+    return 0;
+}
+
+// The bytes of a sample of `t`, whose dim 0 is the batch
+static size_t sampleBytes(const Tensor &t, int batch) {
+    IT_ASSERT(t->getRank() > 0 && t->getDims()[0] == batch,
+              "Dim 0 of the graph inputs and outputs must be the batch");
+    return t->getBytes() / batch;
+}
+
+BatchScheduler::BatchScheduler(vector<Bucket> buckets_,
+                               std::chrono::microseconds maxDelay)
+    : buckets(std::move(buckets_)), maxDelay(maxDelay) {
+    IT_ASSERT(!buckets.empty());
+    auto batchOf = [](const Bucket &bucket) {
+        IT_ASSERT(!bucket.inputs.empty() && !bucket.outputs.empty());
+        return bucket.inputs[0]->getDims()[0];
+    };
+    std::sort(buckets.begin(), buckets.end(),
+              [&](const Bucket &a, const Bucket &b) {
+                  return batchOf(a) < batchOf(b);
+              });
+    for (auto &bucket : buckets) {
+        int batch = batchOf(bucket);
+        IT_ASSERT(batchSizes.empty() || batchSizes.back() < batch,
+                  "Two buckets of the same batch size");
+        batchSizes.emplace_back(batch);
+        vector<size_t> ins, outs;
+        for (auto &t : bucket.inputs)
+            ins.emplace_back(sampleBytes(t, batch));
+        for (auto &t : bucket.outputs)
+            outs.emplace_back(sampleBytes(t, batch));
+        if (inputBytes.empty()) {
+            inputBytes = std::move(ins);
+            outputBytes = std::move(outs);
+        } else {
+            IT_ASSERT(ins == inputBytes && outs == outputBytes,
+                      "The buckets differ in their samples");
+        }
+    }
+    // The buckets are built from the same model, so they keep a single copy
+    // of its weights
+    for (size_t i = 1; i < buckets.size(); ++i)
+        buckets[i].graph->shareWeights(buckets[0].graph);
+    batchCounts.assign(batchSizes.back() + 1, 0);
+    loop = std::thread([this] { serve(); });
+}
+
+BatchScheduler::~BatchScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    loop.join();
+}
+
+std::shared_future<BatchScheduler::Sample>
+BatchScheduler::submit(Sample inputs) {
+    IT_ASSERT(inputs.size() == inputBytes.size());
+    for (size_t i = 0; i < inputs.size(); ++i)
+        IT_ASSERT(inputs[i].size() == inputBytes[i],
+                  "Input " + std::to_string(i) + " is not a single sample");
+    Request request;
+    request.inputs = std::move(inputs);
+    request.enqueued = std::chrono::steady_clock::now();
+    auto future = request.result.get_future().share();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        IT_ASSERT(!stopping);
+        queue.emplace_back(std::move(request));
+    }
+    wakeUp.notify_one();
+    return future;
+}
+
+size_t BatchScheduler::getQueueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
+
+LatencyHistogram BatchScheduler::getLatency() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return latency;
+}
+
+vector<uint64_t> BatchScheduler::getBatchCounts() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return batchCounts;
+}
+
+void BatchScheduler::resetStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    latency = LatencyHistogram();
+    std::fill(batchCounts.begin(), batchCounts.end(), 0);
+}
+
+void BatchScheduler::serve() {
+    size_t maxBatch = batchSizes.back();
+    while (true) {
+        vector<Request> batch;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeUp.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty())
+                return;
+            // Wait for more requests, unless the queue is being drained
+            auto deadline = queue.front().enqueued + maxDelay;
+            wakeUp.wait_until(lock, deadline, [&] {
+                return stopping || queue.size() >= maxBatch;
+            });
+            size_t n = std::min(queue.size(), maxBatch);
+            for (size_t i = 0; i < n; ++i) {
+                batch.emplace_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        runBatch(batch);
+    }
+}
+
+void BatchScheduler::runBatch(vector<Request> &batch) {
+    int n = batch.size();
+    auto &bucket = *std::find_if(
+        buckets.begin(), buckets.end(),
+        [n](const Bucket &b) { return b.inputs[0]->getDims()[0] >= n; });
+    auto runtime = bucket.graph->getRuntime();
+    vector<Sample> results(n);
+    std::exception_ptr error;
+    try {
+        for (size_t i = 0; i < bucket.inputs.size(); ++i) {
+            auto dst = bucket.inputs[i]->getRawDataPtr<uint8_t *>();
+            for (int r = 0; r < n; ++r)
+                runtime->copyBlobFromCPU(dst + r * inputBytes[i],
+                                         batch[r].inputs[i].data(),
+                                         inputBytes[i]);
+        }
+        runtime->run(bucket.graph);
+        for (size_t i = 0; i < bucket.outputs.size(); ++i) {
+            auto src = bucket.outputs[i]->getRawDataPtr<uint8_t *>();
+            for (int r = 0; r < n; ++r) {
+                results[r].emplace_back(outputBytes[i]);
+                runtime->copyBlobToCPU(results[r].back().data(),
+                                       src + r * outputBytes[i],
+                                       outputBytes[i]);
+            }
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // The stats are updated before the callers see the results
+    {
+        auto now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto &request : batch)
+            latency.record(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    now - request.enqueued));
+        ++batchCounts[n];
+    }
+    for (int r = 0; r < n; ++r) {
+        if (error)
+            batch[r].result.set_exception(error);
+        else
+            batch[r].result.set_value(std::move(results[r]));
+    }
+}
+
+} // namespace infini
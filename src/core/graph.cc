@@ -1,4 +1,10 @@
 #include "core/graph.h"
+#include "core/kernel.h"
+#include "operators/batch_norm.h"
+#include "operators/concat.h"
+#include "operators/conv.h"
+#include "operators/pooling.h"
+#include "operators/transpose.h"
 #include <algorithm>
 #include <queue>
 
@@ -29,6 +35,7 @@ GraphObj::GraphObj(Runtime runtime, OpVec ops_in)
 
 void GraphObj::addOperatorAndConnect(const Operator &op) {
     sorted = false;
+    ++version;
     ops.push_back(op);
     for (auto &input : op->getInputs()) {
         input->addTarget(op);
@@ -111,21 +118,619 @@ bool GraphObj::topo_sort() {
 
     // Done.
     this->ops = std::move(sorted);
+    ++version;
     return this->sorted = true;
 }
 
 void GraphObj::optimize() {
+    // Passes that return whether they changed the graph
+    const vector<std::function<bool()>> passes = {
+        [this] { return foldConstants(); },
+        [this] { return eliminateDeadCode(); },
+        [this] { return fuseOperators(); },
+    };
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (auto &pass : passes)
+            changed |= pass();
+    }
+    if (runtime->getDevice() == Device::CPU)
+        assignBlockedLayout();
+    if (weightAllocated)
+        dataMallocAgain();
+}
+
+void GraphObj::detachOperator(const Operator &op) {
+    for (auto &input : op->getInputs()) {
+        auto targets = input->getTargets();
+        if (std::find(targets.begin(), targets.end(), op) == targets.end())
+            continue; // An input used twice is already detached
+        deleteConnection(input, op);
+        if (!input->hasTarget() && !input->getSource() && !input->isInput() &&
+            !input->isOutput())
+            removeTensor(input);
+    }
+    for (auto &output : op->getOutputs()) {
+        output->setSource(nullptr);
+        for (auto &succ : output->getTargets()) {
+            op->removeSuccessors(succ);
+            succ->removePredecessors(op);
+        }
+    }
+    removeOperator(op);
+}
+
+// Write the dims of `shape` into the Shape op output `t`
+template <typename T> static void copyinShape(const Tensor &t, Shape shape) {
+    t->copyin(vector<T>(shape.begin(), shape.end()));
+}
+
+bool GraphObj::foldConstants() {
+    const auto &kernelRegistry = KernelRegistry::getInstance();
+    OpVec foldable;
+    IT_ASSERT(topo_sort() == true);
+    // Tensors whose dims follow the symbols of the graph inputs, which
+    // setSymbols may change
+    std::unordered_set<TensorObj *> symbolic;
+    for (auto &tensor : tensors) {
+        auto symbols = tensor->getDimSymbols();
+        if (!tensor->getSource() &&
+            std::any_of(symbols.begin(), symbols.end(),
+                        [](const string &s) { return !s.empty(); }))
+            symbolic.emplace(tensor.get());
+    }
+    for (auto &op : ops)
+        for (auto &input : op->getInputs())
+            if (symbolic.count(input.get())) {
+                for (auto &output : op->getOutputs())
+                    symbolic.emplace(output.get());
+                break;
+            }
     for (auto &op : ops) {
-        switch (op->getOpType().underlying()) {
-        default:
-            break;
+        auto type = op->getOpType();
+        auto dtype = op->getOutput(0)->getDType();
+        auto kernelAttrs = KernelAttrs{runtime->getDevice(), type.underlying(),
+                                       op->getDType()};
+        // Only the shape changes
+        bool copy = type == OpType::Reshape || type == OpType::Flatten ||
+                    type == OpType::Identity;
+        if (type == OpType::Shape) {
+            if (!(dtype == DataType::Int64 || dtype == DataType::Int32 ||
+                  dtype == DataType::UInt32 || dtype == DataType::Float32) ||
+                symbolic.count(op->getInputs(0).get()))
+                continue;
+        } else if (op->getInputs().empty() ||
+                   !std::all_of(op->getInputs().begin(),
+                                op->getInputs().end(), [](const Tensor &t) {
+                                    return t->isWeight() && t->hasData();
+                                }) ||
+                   (!copy && !kernelRegistry.hasKernel(kernelAttrs))) {
+            continue;
+        }
+        // Evaluate the op into fresh memory, out of the arena
+        for (auto &output : op->getOutputs()) {
+            output->freeData();
+            output->dataMalloc();
+        }
+        if (type == OpType::Shape) {
+            auto shape = op->getInputs(0)->getDims();
+            if (dtype == DataType::Int64)
+                copyinShape<int64_t>(op->getOutput(), shape);
+            else if (dtype == DataType::Int32)
+                copyinShape<int32_t>(op->getOutput(), shape);
+            else if (dtype == DataType::UInt32)
+                copyinShape<uint32_t>(op->getOutput(), shape);
+            else
+                copyinShape<float>(op->getOutput(), shape);
+        } else if (copy) {
+            op->getOutput()->copyData(op->getInputs(0));
+        } else {
+            kernelRegistry.getKernel(kernelAttrs)->compute(op, runtime.get());
         }
+        for (auto &output : op->getOutputs())
+            output->setWeight();
+        foldable.emplace_back(op);
     }
+    for (auto &op : foldable)
+        detachOperator(op);
+    return !foldable.empty();
 }
 
-void GraphObj::dataMalloc(bool useNaiveAllocator) {
+bool GraphObj::eliminateDeadCode() {
+    // Without marked graph outputs, every unread tensor may be one
+    if (std::none_of(tensors.begin(), tensors.end(),
+                     [](const Tensor &t) { return t->isOutput(); }))
+        return false;
+    bool changed = false;
+    // Visit consumers first, so that whole dead chains go in one sweep
+    IT_ASSERT(topo_sort() == true);
+    const OpVec order = ops;
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        auto op = *it;
+        auto outputs = op->getOutputs();
+        if (std::any_of(outputs.begin(), outputs.end(), [](const Tensor &t) {
+                return t->hasTarget() || t->isOutput();
+            }))
+            continue;
+        detachOperator(op);
+        for (auto &output : outputs)
+            removeTensor(output);
+        changed = true;
+    }
+    return changed;
+}
+
+// Indices of the activation inputs of `op` if the CPU kernel of `op` runs on
+// nChw<block>c activations, or nothing if it does not. The other inputs, such
+// as weights, must be constants.
+static optional<vector<int>> blockedLayoutInputs(const Operator &op,
+                                                 int block) {
+    vector<int> ret = {0};
+    switch (op->getOpType().underlying()) {
+    case OpType::Conv: {
+        // Dense or depthwise
+        auto conv = as<ConvObj>(op);
+        int g = conv->getNumGroups();
+        if (g != 1 && (conv->getChannelPerGroup() != 1 ||
+                       g != conv->getOutput()->getDims()[1]))
+            return {};
+        break;
+    }
+    case OpType::MaxPool:
+    case OpType::AveragePool: {
+        auto pool = as<PoolingObj>(op);
+        if (std::get<4>(pool->getPadStrideDilation()) != 1 ||
+            std::get<5>(pool->getPadStrideDilation()) != 1)
+            return {};
+        break;
+    }
+    case OpType::BatchNormalization:
+        if (as<BatchNormObj>(op)->getTrainingMode())
+            return {};
+        break;
+    case OpType::Add:
+    case OpType::Sub:
+    case OpType::Mul:
+    case OpType::Div:
+        // Broadcasting needs the plain layout
+        if (op->getInputs(0)->getDims() != op->getInputs(1)->getDims())
+            return {};
+        ret = {0, 1};
+        break;
+    case OpType::FusedElementWise:
+        // Operands of a single element read the same in any layout
+        ret.clear();
+        for (int i = 0; i < (int)op->getInputs().size(); ++i)
+            if (op->getInputs(i)->getDims() == op->getOutput()->getDims())
+                ret.emplace_back(i);
+        break;
+    case OpType::Relu:
+    case OpType::Sigmoid:
+    case OpType::Tanh:
+    case OpType::HardSigmoid:
+    case OpType::HardSwish:
+    case OpType::Gelu:
+    case OpType::Erf:
+    case OpType::Abs:
+    case OpType::Sqrt:
+    case OpType::Neg:
+        break;
+    default:
+        return {};
+    }
+    if (op->getOutputs().size() != 1 ||
+        !(op->getOutput()->getDType() == DataType::Float32) ||
+        op->getOutput()->getChannelBlock() != 1)
+        return {};
+    auto blockable = [&](const Tensor &t) {
+        return t->getRank() == 4 && t->getDims()[1] % block == 0;
+    };
+    if (!blockable(op->getOutput()))
+        return {};
+    for (int i = 0; i < (int)op->getInputs().size(); ++i) {
+        if (std::find(ret.begin(), ret.end(), i) != ret.end()) {
+            if (!blockable(op->getInputs(i)))
+                return {};
+        } else if (op->getInputs(i)->getSource()) {
+            return {};
+        }
+    }
+    return ret;
+}
+
+void GraphObj::assignBlockedLayout(int block) {
+    IT_ASSERT(block == 8 || block == 16, "Unsupported channel block.");
+    // The MKL kernels read every tensor as plain
+    if (runtime->getDevice() != Device::CPU)
+        return;
+    // tensors may change layout without any op added
+    ++version;
+    std::unordered_map<Operator, vector<int>> candidates;
+    for (auto &op : ops)
+        if (auto inputs = blockedLayoutInputs(op, block))
+            candidates.emplace(op, *inputs);
+    auto isActivationOf = [&](const Tensor &t, const Operator &op) {
+        auto it = candidates.find(op);
+        if (it == candidates.end())
+            return false;
+        for (int i : it->second)
+            if (op->getInputs(i) == t)
+                return true;
+        return false;
+    };
+
+    // Grow connected regions of candidates, and keep those that contain a
+    // convolution: converting the layout is not worth it for the others.
+    std::unordered_set<Operator> region, visited;
+    for (auto &seed : ops) {
+        if (!candidates.count(seed) || visited.count(seed))
+            continue;
+        vector<Operator> component{seed};
+        visited.insert(seed);
+        bool hasConv = false;
+        for (size_t i = 0; i < component.size(); ++i) {
+            auto op = component[i];
+            hasConv |= op->getOpType() == OpType::Conv;
+            // Candidates connected through an activation
+            OpVec neighbors;
+            for (auto &next : op->getOutput()->getTargets())
+                if (isActivationOf(op->getOutput(), next))
+                    neighbors.emplace_back(next);
+            for (int j : candidates.at(op))
+                if (auto prev = op->getInputs(j)->getSource())
+                    if (candidates.count(prev))
+                        neighbors.emplace_back(prev);
+            for (auto &next : neighbors)
+                if (visited.insert(next).second)
+                    component.emplace_back(next);
+        }
+        if (hasConv)
+            region.insert(component.begin(), component.end());
+    }
+
+    // Every activation of the regions, in a deterministic order
+    vector<Tensor> activations;
+    std::unordered_set<Tensor> seen;
+    for (auto &op : ops)
+        if (region.count(op)) {
+            for (int i : candidates.at(op))
+                if (seen.insert(op->getInputs(i)).second)
+                    activations.emplace_back(op->getInputs(i));
+            if (seen.insert(op->getOutput()).second)
+                activations.emplace_back(op->getOutput());
+        }
+    const vector<int> identity = {0, 1, 2, 3};
+    for (auto &t : activations) {
+        OpVec inside, outside;
+        for (auto &op : t->getTargets())
+            (region.count(op) ? inside : outside).emplace_back(op);
+        auto src = t->getSource();
+        bool fromRegion = src && region.count(src);
+        if (fromRegion && outside.empty() && !t->isOutput() &&
+            t->hasTarget()) {
+            t->setChannelBlock(block);
+            continue;
+        }
+        auto blocked = addTensor(t->getDims(), t->getDType());
+        blocked->setChannelBlock(block);
+        if (fromRegion) {
+            // The region writes `blocked`, and `t` becomes its plain copy
+            src->replaceOutput(t, blocked);
+            blocked->setSource(src);
+            for (auto &op : t->getTargets()) {
+                src->removeSuccessors(op);
+                op->removePredecessors(src);
+            }
+            t->setSource(nullptr);
+            addOpWithOutputs<TransposeObj>(blocked, t, identity);
+        } else {
+            addOpWithOutputs<TransposeObj>(t, blocked, identity);
+        }
+        for (auto &op : inside)
+            replaceConnection(t, blocked, op);
+    }
+}
+
+// Whether the output of `op` can share the memory of its input. Graph outputs
+// keep their own memory, which is never reused, except those of in-place
+// updates, which always share it so that the op writes nothing else.
+static bool isAliasable(const Operator &op) {
+    if (!op->isView() && !op->isInplaceUpdate())
+        return false;
+    auto input = op->getInputs(0), output = op->getOutput();
+    return (output->isOthers() || op->isInplaceUpdate()) &&
+           output->getBytes() == input->getBytes() &&
+           output->getChannelBlock() == input->getChannelBlock();
+}
+
+// The inputs of Concats that are produced directly into the output of the
+// Concat, mapped to the output and the byte offset of their slice. Only a
+// Concat along its outermost non-unit axis has contiguous slices, and only an
+// input read by nothing else, written by a non-view op and not itself such a
+// Concat output can be placed there.
+using ConcatSlices =
+    std::unordered_map<TensorObj *, std::pair<TensorObj *, size_t>>;
+
+static ConcatSlices planConcatSlices(const OpVec &ops) {
+    ConcatSlices slices;
+    std::unordered_set<TensorObj *> wholes;
+    for (auto &op : ops) {
+        if (op->getOpType() != OpType::Concat)
+            continue;
+        auto output = op->getOutput();
+        const auto &dims = output->getDims();
+        const int dim = as<ConcatObj>(op)->getDim();
+        if (!(output->isOthers() || output->isOutput()) ||
+            output->getChannelBlock() != 1 ||
+            std::any_of(dims.begin(), dims.begin() + dim,
+                        [](int d) { return d != 1; }))
+            continue;
+        size_t inner = output->getDType().getSize();
+        for (size_t i = dim + 1; i < dims.size(); ++i)
+            inner *= dims[i];
+        auto inputs = op->getInputs();
+        size_t offset = 0;
+        for (auto &input : inputs) {
+            auto t = input.get();
+            auto source = input->getSource();
+            auto readers = input->getTargets();
+            if (input->isOthers() && source && !isAliasable(source) &&
+                readers.size() == 1 && input->getChannelBlock() == 1 &&
+                std::count(inputs.begin(), inputs.end(), input) == 1 &&
+                !wholes.count(t))
+                slices[t] = {output.get(), offset};
+            offset += input->getDims()[dim] * inner;
+        }
+        wholes.emplace(output.get());
+    }
+    return slices;
+}
+
+// The memory blocks needed to run the operators in some order
+struct BufferAssignment {
+    vector<MemoryBuffer> buffers;
+    // the buffer of each non-weight tensor that owns memory
+    std::unordered_map<TensorObj *, int> tensorToBuffer;
+    // the outputs of view operators that share the memory of their input,
+    // mapped to the tensor owning the memory
+    std::unordered_map<TensorObj *, TensorObj *> aliasToOwner;
+};
+
+// Simulate running `order` and record the lifetime of each buffer. Views
+// share the memory of their input, and on CPU the output of an op may take
+// over the memory of an input that is read for the last time. If the ops run
+// `concurrent`ly, the step of an op is its depth in the graph, so that the
+// buffers of ops that may run together are live together. The `slices` of a
+// Concat output live in its buffer, which starts with the first of them.
+static BufferAssignment assignBuffers(const TensorVec &tensors,
+                                      const OpVec &order, bool inplace,
+                                      bool concurrent,
+                                      const LazyAllocator &allocator,
+                                      const ConcatSlices &slices = {}) {
+    BufferAssignment ret;
+    auto &buffers = ret.buffers;
+    auto &tensorToBuffer = ret.tensorToBuffer;
+    auto &aliasToOwner = ret.aliasToOwner;
+    // buffers that are never freed live until the end
+    const int end = order.size();
+    auto newBuffer = [&](TensorObj *tensor, int start) {
+        tensorToBuffer[tensor] = buffers.size();
+        buffers.push_back(
+            {allocator.getAlignedSize(tensor->getBytes()), start, end});
+    };
+    // count the number of times all tensors are used
+    std::unordered_map<TensorObj *, size_t> tensorToRefCount;
+    for (auto &tensor : tensors) {
+        if (tensor->isWeight() || tensor->isKVCache())
+            continue;
+        // aliased below, graph output or not
+        if (auto source = tensor->getSource();
+            source && source->isInplaceUpdate() && isAliasable(source))
+            continue;
+        if (tensor->isInput() || tensor->isOutput()) {
+            // the memory of input and output tensors will not be reused
+            newBuffer(tensor.get(), 0);
+        } else if (!slices.count(tensor.get())) {
+            tensorToRefCount[tensor.get()] = tensor->getTargets().size();
+            // user-created tensors are filled before running
+            if (tensor->getSource() == nullptr)
+                newBuffer(tensor.get(), 0);
+        }
+    }
+    auto ownerOf = [&](TensorObj *tensor) {
+        auto it = aliasToOwner.find(tensor);
+        return it == aliasToOwner.end() ? tensor : it->second;
+    };
+    // concurrent ops may read a tensor after its last reader in `order`
+    auto isSoleReader = [&](TensorObj *tensor, const Operator &op) {
+        for (auto &target : tensor->getTargets())
+            if (target != op)
+                return false;
+        return std::none_of(
+            aliasToOwner.begin(), aliasToOwner.end(),
+            [&](const auto &alias) { return alias.second == tensor; });
+    };
+    std::unordered_map<OperatorObj *, int> depth;
+    // the last step reading each owner so far
+    std::unordered_map<TensorObj *, int> lastUse;
+    for (int index = 0; index < end; ++index) {
+        auto &op = order[index];
+        int step = index;
+        if (concurrent) {
+            step = 0;
+            for (auto &input : op->getInputs())
+                if (auto source = input->getSource())
+                    step = std::max(step, depth.at(source.get()) + 1);
+            depth[op.get()] = step;
+        }
+        auto outputs = op->getOutputs();
+        if (isAliasable(op)) {
+            // the owner is freed once the readers of the alias are done too.
+            // An alias without readers may be a graph output, and keeps the
+            // owner forever like other unread tensors.
+            auto output = op->getOutput().get();
+            auto owner = ownerOf(op->getInputs(0).get());
+            aliasToOwner[output] = owner;
+            if (auto it = tensorToRefCount.find(owner);
+                it != tensorToRefCount.end())
+                it->second += std::max<size_t>(output->getTargets().size(), 1);
+            tensorToRefCount.erase(output);
+            outputs.clear();
+        }
+        auto inputs = op->getInputs();
+        // Graph inputs are never taken over, so that the graph can run again
+        // on them
+        TensorObj *reused = nullptr;
+        if (inplace && outputs.size() == 1 && outputs[0]->isOthers() &&
+            !slices.count(outputs[0].get())) {
+            auto output = outputs[0].get();
+            for (int i : op->getInplaceInputs()) {
+                auto owner = ownerOf(op->getInputs(i).get());
+                auto it = tensorToRefCount.find(owner);
+                size_t uses = std::count_if(
+                    inputs.begin(), inputs.end(), [&](const Tensor &t) {
+                        return ownerOf(t.get()) == owner;
+                    });
+                if (it == tensorToRefCount.end() || it->second != uses ||
+                    !owner->getSource() ||
+                    owner->getBytes() != output->getBytes() ||
+                    owner->getChannelBlock() != output->getChannelBlock() ||
+                    (concurrent && !isSoleReader(owner, op)))
+                    continue;
+                tensorToBuffer[output] = tensorToBuffer[owner];
+                tensorToRefCount.erase(owner);
+                reused = owner;
+                outputs.clear();
+                break;
+            }
+        }
+        // memory should be allocated for the op's output first
+        for (auto &tensor : outputs) {
+            auto t = tensor.get();
+            if (auto it = slices.find(t); it != slices.end())
+                t = it->second.first;
+            if (!tensorToBuffer.count(t)) {
+                if (t->isOthers())
+                    newBuffer(t, step);
+            } else if (t != tensor.get()) {
+                int &start = buffers[tensorToBuffer[t]].start;
+                start = std::min(start, step);
+            }
+        }
+        for (auto &tensor : inputs) {
+            if (tensor->isOthers() && !slices.count(tensor.get())) {
+                auto owner = ownerOf(tensor.get());
+                if (owner == reused)
+                    continue;
+                auto tensorIter = tensorToRefCount.find(owner);
+                // aliases of weights, graph inputs and outputs are not counted
+                if (owner != tensor.get() &&
+                    tensorIter == tensorToRefCount.end())
+                    continue;
+                IT_ASSERT(tensorIter != tensorToRefCount.end());
+                IT_ASSERT(tensorIter->second > 0);
+                int &last = lastUse[owner];
+                last = std::max(last, step);
+                if (--tensorIter->second == 0) {
+                    // this tensor will no longer be used
+                    tensorToRefCount.erase(tensorIter);
+                    buffers[tensorToBuffer[owner]].end = last;
+                }
+            }
+        }
+    }
+    return ret;
+}
+
+// A topological order of `ops` that runs next the ready op growing the live
+// bytes the least, so that branches release their memory before others start.
+// Ties keep the order of `ops`.
+static OpVec scheduleForMemory(const OpVec &ops) {
+    std::unordered_map<Operator, int> pending;
+    std::unordered_map<TensorObj *, size_t> readers;
+    for (auto &op : ops) {
+        int &count = pending[op];
+        for (auto &input : op->getInputs()) {
+            count += input->getSource() != nullptr;
+            readers[input.get()] += 1;
+        }
+    }
+    auto growth = [&](const Operator &op) {
+        long long bytes = 0;
+        if (!isAliasable(op))
+            for (auto &output : op->getOutputs())
+                bytes += output->isOthers() ? output->getBytes() : 0;
+        std::unordered_map<TensorObj *, size_t> uses;
+        for (auto &input : op->getInputs())
+            uses[input.get()] += 1;
+        for (auto &[input, n] : uses)
+            if (input->isOthers() && input->getSource() &&
+                readers[input] == n)
+                bytes -= input->getBytes();
+        return bytes;
+    };
+    // indices in `ops` of the ops whose inputs are ready
+    std::set<int> ready;
+    std::unordered_map<Operator, int> index;
+    for (int i = 0; i < (int)ops.size(); ++i) {
+        index[ops[i]] = i;
+        if (pending[ops[i]] == 0)
+            ready.insert(i);
+    }
+    OpVec order;
+    while (!ready.empty()) {
+        int best = *ready.begin();
+        long long bestGrowth = growth(ops[best]);
+        for (int i : ready)
+            if (long long g = growth(ops[i]); g < bestGrowth)
+                best = i, bestGrowth = g;
+        ready.erase(best);
+        auto &op = ops[best];
+        order.emplace_back(op);
+        for (auto &input : op->getInputs())
+            readers[input.get()] -= 1;
+        for (auto &output : op->getOutputs())
+            for (auto &target : output->getTargets())
+                if (--pending[target] == 0)
+                    ready.insert(index.at(target));
+    }
+    IT_ASSERT(order.size() == ops.size());
+    return order;
+}
+
+// The plans of `planner` for `buffers`, or of all the offset planners if it
+// is Auto
+static vector<MemoryPlan> planBuffers(const vector<MemoryBuffer> &buffers,
+                                      MemoryPlanner planner,
+                                      LazyAllocator &allocator) {
+    vector<MemoryPlan> plans;
+    bool all = planner == MemoryPlanner::Auto;
+    if (all || planner == MemoryPlanner::Greedy)
+        plans.emplace_back(planGreedy(buffers, allocator));
+    if (all || planner == MemoryPlanner::GreedyBySize)
+        plans.emplace_back(planGreedyBySize(buffers));
+    if (all || planner == MemoryPlanner::IntervalColouring)
+        plans.emplace_back(planIntervalColouring(buffers));
+    return plans;
+}
+
+// The plan with the lowest peak, the first one on ties
+static size_t lowestPeak(const vector<MemoryPlan> &plans) {
+    IT_ASSERT(!plans.empty());
+    return std::min_element(plans.begin(), plans.end(),
+                            [](const MemoryPlan &a, const MemoryPlan &b) {
+                                return a.peak < b.peak;
+                            }) -
+           plans.begin();
+}
+
+void GraphObj::dataMalloc(bool useNaiveAllocator, MemoryPlanner planner,
+                          bool concatInPlace) {
     // topological sorting first
     IT_ASSERT(topo_sort() == true);
+    mallocOptions = {useNaiveAllocator, planner, concatInPlace};
+    ++version;
+    ++replans;
     if (useNaiveAllocator) {
         // used for debugging memory out-of-bounds access, tensors will not be
         // released correctly
@@ -134,92 +739,278 @@ void GraphObj::dataMalloc(bool useNaiveAllocator) {
         for (auto &tensor : tensors) {
             tensor->dataMalloc();
         }
+        for (auto &op : ops)
+            if (op->isInplaceUpdate())
+                op->getOutput()->setDataBlob(op->getInputs(0)->getDataBlob());
         return;
     }
-    // count the number of times all tensors are used
-    std::unordered_map<TensorObj *, size_t> tensorToRefCount;
-    // record the memory address offsets of all tensors to be allocated
-    std::unordered_map<TensorObj *, size_t> tensorToOffset;
 
     // reinit allocator
     allocator.init();
-
-    // record all weight tensors, including weight tensors and kvcache
-    // tensors
-    std::unordered_set<TensorObj *> weightTensors;
-    for (auto &tensor : tensors) {
-        if (tensor->isWeight()) {
-            // allocate memory for all weight tensors first, and this memory
-            // will not be freed until the graph is destroyed
-            weightTensors.insert(tensor.get());
-            if (!this->weightAllocated) {
-                tensorToOffset[tensor.get()] =
-                    allocator.allocWeight(tensor->getBytes());
-            }
-        } else if (tensor->isInput() || tensor->isOutput()) {
-            // allocate memory for all input and output tensors, and this memory
-            // will not be reused later
-            tensorToOffset[tensor.get()] = allocator.alloc(tensor->getBytes());
-        } else {
-            tensorToRefCount[tensor.get()] = tensor->getTargets().size();
-            // allocate memory for all user-created tensors
-            if (tensor.get()->getSource() == nullptr) {
-                tensorToOffset[tensor.get()] =
-                    allocator.alloc(tensor->getBytes());
-            }
-        }
-    }
-    // if memory has not yet been allocated for weight tensors,
-    // allocate memory now and do not allocate again in the future.
+    // allocate memory for all weight tensors first, and this memory will not
+    // be freed until the graph is destroyed
     if (!this->weightAllocated) {
         this->weightAllocated = true;
+        std::unordered_map<TensorObj *, size_t> weightToOffset;
+        for (auto &tensor : tensors)
+            if (tensor->isWeight())
+                weightToOffset[tensor.get()] =
+                    allocator.allocWeight(tensor->getBytes());
         // only allocate once for weight tensors
-        for (auto &tensor : weightTensors) {
-            IT_ASSERT(tensorToOffset.find(tensor) != tensorToOffset.end());
+        for (auto &[tensor, offset] : weightToOffset)
             tensor->setDataBlob(make_ref<BlobObj>(
                 tensor->runtime,
-                static_cast<uint8_t *>(allocator.getWeightPtr()) +
-                    tensorToOffset[tensor]));
-        }
+                static_cast<uint8_t *>(allocator.getWeightPtr()) + offset));
     }
-    // traverse in topological order and simulate memory allocation
-    for (auto &op : ops) {
-        // memory should be allocated for the op's output first
-        auto outputs = op->getOutputs();
-        for (auto &tensor : outputs) {
-            if (tensor->isOthers()) {
-                tensorToOffset[tensor.get()] =
-                    allocator.alloc(tensor->getBytes());
-            }
-        }
-        auto inputs = op->getInputs();
-        for (auto &tensor : inputs) {
-            if (tensor->isOthers()) {
-                auto tensorIter = tensorToRefCount.find(tensor.get());
-                IT_ASSERT(tensorIter != tensorToRefCount.end());
-                IT_ASSERT(tensorToRefCount[tensor.get()] > 0);
-                tensorToRefCount[tensor.get()] -= 1;
-                if (tensorToRefCount[tensor.get()] == 0) {
-                    // indicate that this tensor will no longer be used and
-                    // perform memory free
-                    tensorToRefCount.erase(tensor.get());
-                    allocator.free(tensorToOffset[tensor.get()],
-                                   tensor->getBytes());
-                }
-            }
+
+    // KV caches keep their contents across runs and memory plans, so they
+    // get memory of their own
+    for (auto &tensor : tensors)
+        if (tensor->isKVCache())
+            tensor->dataMalloc();
+
+    // oneDNN only lets the output alias the first input, see getInplaceInputs
+    const bool inplace = runtime->getDevice() == Device::CPU;
+    auto cpuRuntime = as<CpuRuntimeObj>(runtime);
+    const bool concurrent = cpuRuntime && cpuRuntime->getInterOpThreads() > 1;
+    // the order does not decide the lifetimes of concurrent ops
+    if (concurrent && planner == MemoryPlanner::Reorder)
+        planner = MemoryPlanner::Auto;
+    ConcatSlices slices;
+    if (concatInPlace && runtime->isCpu())
+        slices = planConcatSlices(ops);
+    auto assignment =
+        assignBuffers(tensors, ops, inplace, concurrent, allocator, slices);
+    memoryPlans.clear();
+    if (planner != MemoryPlanner::Reorder)
+        memoryPlans = planBuffers(assignment.buffers, planner, allocator);
+    if (!concurrent && (planner == MemoryPlanner::Auto ||
+                        planner == MemoryPlanner::Reorder)) {
+        auto order = scheduleForMemory(ops);
+        auto reordered =
+            assignBuffers(tensors, order, inplace, false, allocator, slices);
+        auto plans =
+            planBuffers(reordered.buffers, MemoryPlanner::Auto, allocator);
+        auto &plan = plans[lowestPeak(plans)];
+        plan.planner = MemoryPlanner::Reorder;
+        memoryPlans.emplace_back(std::move(plan));
+        // the current order is kept on ties
+        if (lowestPeak(memoryPlans) == memoryPlans.size() - 1) {
+            ops = std::move(order);
+            assignment = std::move(reordered);
         }
     }
+    // the chosen plan goes first
+    auto chosen = memoryPlans.begin() + lowestPeak(memoryPlans);
+    std::rotate(memoryPlans.begin(), chosen, chosen + 1);
+    const auto &offsets = memoryPlans[0].offsets;
+    allocator.init();
+    allocator.reserve(memoryPlans[0].peak);
 
     // perform actual memory allocation for non-weight tensors
+    auto &[buffers, tensorToBuffer, aliasToOwner] = assignment;
     for (auto &tensor : tensors) {
-        if (!tensor->isWeight()) {
-            IT_ASSERT(tensorToOffset.find(tensor.get()) !=
-                      tensorToOffset.end());
+        if (!tensor->isWeight() && !tensor->isKVCache() &&
+            !aliasToOwner.count(tensor.get()) && !slices.count(tensor.get())) {
+            IT_ASSERT(tensorToBuffer.find(tensor.get()) !=
+                      tensorToBuffer.end());
             tensor->setDataBlob(make_ref<BlobObj>(
                 tensor->runtime, static_cast<uint8_t *>(allocator.getPtr()) +
-                                     tensorToOffset[tensor.get()]));
+                                     offsets[tensorToBuffer[tensor.get()]]));
+        }
+    }
+    // slices point into the Concat output, and aliases share the blob of
+    // their owner
+    for (auto &[slice, place] : slices)
+        slice->setDataBlob(make_ref<BlobObj>(
+            runtime, place.first->getRawDataPtr<uint8_t *>() + place.second));
+    for (auto &[alias, owner] : aliasToOwner)
+        alias->setDataBlob(owner->getDataBlob());
+}
+
+Graph GraphObj::instantiate(const Graph &graph) {
+    IT_ASSERT(graph->weightAllocated, "Allocate the graph memory first");
+    IT_ASSERT(graph->topo_sort() == true);
+    auto instance = make_ref<GraphObj>(graph->runtime);
+    map<UidBaseType, Tensor> tensorPool;
+    for (auto &t : graph->tensors) {
+        auto tensor = instance->addTensor(t->clone());
+        if (t->isWeight())
+            tensor->setDataBlob(t->getDataBlob());
+        tensorPool[t->getFuid()] = tensor;
+    }
+    for (auto &op : graph->ops) {
+        TensorVec inputs, outputs;
+        for (auto &t : op->getInputs())
+            inputs.emplace_back(tensorPool.at(t->getFuid()));
+        for (auto &t : op->getOutputs())
+            outputs.emplace_back(tensorPool.at(t->getFuid()));
+        instance->addOperatorAndConnect(op->clone(inputs, outputs));
+    }
+    instance->weightAllocated = true;
+    instance->weightOwner = graph->weightOwner ? graph->weightOwner : graph;
+    instance->mallocOptions = graph->mallocOptions;
+    instance->dataMallocAgain();
+    return instance;
+}
+
+void GraphObj::shareWeights(const Graph &owner) {
+    IT_ASSERT(weightAllocated && owner->weightAllocated,
+              "Allocate the graph memory first");
+    IT_ASSERT(!weightOwner, "The graph shares the weights of another already");
+    IT_ASSERT(runtime == owner->runtime);
+    auto weightsOf = [](const GraphObj &graph) {
+        TensorVec ans;
+        for (auto &t : graph.tensors)
+            if (t->isWeight())
+                ans.emplace_back(t);
+        return ans;
+    };
+    auto mine = weightsOf(*this), theirs = weightsOf(*owner);
+    IT_ASSERT(mine.size() == theirs.size(), "The graphs differ in weights");
+    bool all = true;
+    for (size_t i = 0; i < mine.size(); ++i) {
+        auto &a = mine[i], &b = theirs[i];
+        bool same = a->getDType() == b->getDType() &&
+                    a->getDims() == b->getDims();
+        if (same) {
+            vector<uint8_t> x(a->getBytes()), y(b->getBytes());
+            runtime->copyBlobToCPU(x.data(), a->getRawDataPtr<void *>(),
+                                   x.size());
+            runtime->copyBlobToCPU(y.data(), b->getRawDataPtr<void *>(),
+                                   y.size());
+            same = x == y;
+        }
+        if (same)
+            a->setDataBlob(b->getDataBlob());
+        all &= same;
+    }
+    if (all)
+        allocator.freeWeight();
+    // the blobs point into the allocator of the owner, which must outlive
+    // this graph
+    weightOwner = owner->weightOwner ? owner->weightOwner : owner;
+}
+
+void GraphObj::inferShapes(const std::map<string, int> &sizes) {
+    IT_ASSERT(topo_sort() == true);
+    std::unordered_map<TensorObj *, Shape> oldShapes;
+    for (auto &tensor : tensors)
+        oldShapes[tensor.get()] = tensor->getDims();
+    for (auto &tensor : tensors) {
+        if (tensor->getSource())
+            continue;
+        auto shape = tensor->getDims();
+        auto symbols = tensor->getDimSymbols();
+        for (size_t i = 0; i < shape.size(); ++i)
+            if (!symbols[i].empty())
+                shape[i] = sizes.at(symbols[i]);
+        IT_ASSERT((!tensor->isWeight() && !tensor->isKVCache()) ||
+                      shape == tensor->getDims(),
+                  "Weights and KV caches can not change their shapes");
+        tensor->setShape(shape);
+    }
+    for (auto &op : ops) {
+        vector<Shape> oldInputShapes;
+        for (auto &input : op->getInputs())
+            oldInputShapes.emplace_back(oldShapes.at(input.get()));
+        op->updateShapeAttributes(oldInputShapes);
+        auto shapes = op->inferShape();
+        IT_ASSERT(shapes && shapes->size() == op->getOutputs().size(),
+                  "Shape inference failed for " + op->toString());
+        for (size_t i = 0; i < shapes->size(); ++i)
+            op->getOutput(i)->setShape(shapes->at(i));
+    }
+}
+
+std::map<string, int> GraphObj::getSymbols() const {
+    std::map<string, int> sizes;
+    for (auto &tensor : tensors) {
+        if (tensor->getSource())
+            continue;
+        auto symbols = tensor->getDimSymbols();
+        for (size_t i = 0; i < symbols.size(); ++i)
+            if (!symbols[i].empty())
+                sizes[symbols[i]] = tensor->getDims()[i];
+    }
+    return sizes;
+}
+
+void GraphObj::setSymbols(const std::map<string, int> &sizes_) {
+    auto sizes = getSymbols();
+    for (auto &[symbol, size] : sizes_) {
+        IT_ASSERT(sizes.count(symbol), "Unknown symbol " + symbol);
+        IT_ASSERT(size > 0);
+        sizes[symbol] = size;
+    }
+    if (!weightAllocated) {
+        inferShapes(sizes);
+        return;
+    }
+    IT_ASSERT(topo_sort() == true);
+    // The plans of the buckets are valid as long as the operators are
+    if (bucketsVersion != version - replans) {
+        shapeBuckets.clear();
+        currentBucket.reset();
+        bucketsVersion = version - replans;
+    }
+    // Keep the execution plan of the current bucket
+    if (currentBucket && executionPlan.version == version)
+        shapeBuckets.at(*currentBucket).executionPlan = executionPlan;
+    auto bucketSizes = sizes;
+    for (auto &[symbol, size] : bucketSizes) {
+        int bucket = 1;
+        while (bucket < size)
+            bucket *= 2;
+        size = bucket;
+    }
+    auto it = shapeBuckets.find(bucketSizes);
+    if (it == shapeBuckets.end()) {
+        inferShapes(bucketSizes);
+        dataMallocAgain();
+        ShapeBucket bucket{ops, memoryPlans, {}, {}};
+        auto base = static_cast<uint8_t *>(allocator.getPtr());
+        // Weights, KV caches and the outputs updating a cache in place keep
+        // their memory across the buckets
+        std::unordered_set<TensorObj *> kept;
+        for (auto &tensor : tensors)
+            if (tensor->isWeight() || tensor->isKVCache())
+                kept.emplace(tensor.get());
+        for (auto &op : ops)
+            if (op->isInplaceUpdate() &&
+                op->getInputs(0)->getDataBlob() ==
+                    op->getOutput()->getDataBlob() &&
+                kept.count(op->getInputs(0).get()))
+                kept.emplace(op->getOutput().get());
+        for (auto &tensor : tensors)
+            if (!kept.count(tensor.get()))
+                bucket.offsets[tensor.get()] =
+                    tensor->getRawDataPtr<uint8_t *>() - base;
+        it = shapeBuckets.emplace(bucketSizes, std::move(bucket)).first;
+    } else {
+        auto &bucket = it->second;
+        // The memory grows to the largest bucket seen
+        if (allocator.getPeak() < bucket.memoryPlans[0].peak) {
+            allocator.init();
+            allocator.reserve(bucket.memoryPlans[0].peak);
+        }
+        auto base = static_cast<uint8_t *>(allocator.getPtr());
+        for (auto &[tensor, offset] : bucket.offsets)
+            tensor->setDataBlob(make_ref<BlobObj>(runtime, base + offset));
+        ops = bucket.ops;
+        memoryPlans = bucket.memoryPlans;
+        ++version;
+        ++replans;
+        // Concurrent plans order the steps by the memory they touch at
+        // the exact shapes, so they are built again
+        if (bucket.executionPlan.version && !bucket.executionPlan.concurrent) {
+            executionPlan = bucket.executionPlan;
+            executionPlan.version = version;
         }
     }
+    bucketsVersion = version - replans;
+    currentBucket = bucketSizes;
+    inferShapes(sizes);
 }
 
 Tensor GraphObj::addTensor(Shape dim, DataType dtype) {
@@ -250,6 +1041,7 @@ OpVec GraphObj::getComputeOps() const {
 }
 
 void GraphObj::deleteConnection(Tensor tensor, Operator op) {
+    ++version;
     // if op is target
     IT_ASSERT(std::find(tensor->getTargets().begin(),
                         tensor->getTargets().end(),
@@ -263,6 +1055,7 @@ void GraphObj::deleteConnection(Tensor tensor, Operator op) {
 
 // add op as a target
 void GraphObj::addConnection(Tensor tensor, Operator op) {
+    ++version;
     tensor->addTarget(op);
     if (tensor->getSource()) {
         tensor->getSource()->addSuccessors(op);
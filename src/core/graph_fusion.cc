@@ -0,0 +1,476 @@
+#include "core/graph.h"
+#include "operators/attention.h"
+#include "operators/batch_norm.h"
+#include "operators/conv.h"
+#include "operators/fused_element_wise.h"
+#include "operators/layer_norm.h"
+#include "operators/matmul.h"
+#include "operators/reduce.h"
+#include "operators/softmax.h"
+#include <cmath>
+
+namespace infini {
+
+// A fusion rule matches a pattern that ends with `op`. On a match, it returns
+// the operator replacing the pattern, which is built on the inputs of the
+// pattern and the output of `op` but not connected, and sets `fused` to the
+// operators of the pattern. Otherwise it returns nullptr.
+using FusionRule = Operator (*)(GraphObj *g, const Operator &op,
+                                OpVec &fused);
+
+// The operator that produces `t`, if `op` is the only reader of `t`
+static Operator soleProducer(const Tensor &t, const Operator &op) {
+    auto targets = t->getTargets();
+    if (targets.size() != 1 || targets[0] != op || t->isOutput())
+        return nullptr;
+    return t->getSource();
+}
+
+static bool isPlainFloat(const TensorVec &tensors) {
+    return std::all_of(tensors.begin(), tensors.end(), [](const Tensor &t) {
+        return t->getDType() == DataType::Float32 && t->getChannelBlock() == 1;
+    });
+}
+
+static bool isConstant(const Tensor &t) {
+    return t->isWeight() && t->hasData() && !t->getSource();
+}
+
+// Conv -> BatchNormalization becomes a Conv whose filters are scaled and whose
+// bias is shifted by the normalization
+static Operator fuseConvBatchNorm(GraphObj *g, const Operator &op,
+                                  OpVec &fused) {
+    if (op->getOpType() != OpType::BatchNormalization)
+        return nullptr;
+    auto bn = as<BatchNormObj>(op);
+    auto conv = soleProducer(bn->getInputs(0), bn);
+    if (bn->getTrainingMode() || !conv || conv->getOpType() != OpType::Conv)
+        return nullptr;
+    auto convObj = as<ConvObj>(conv);
+    if (convObj->getAct() != ActType::None ||
+        !isPlainFloat(conv->getInputs()) || !isPlainFloat(bn->getInputs()) ||
+        !isPlainFloat(bn->getOutputs()))
+        return nullptr;
+    for (size_t i = 1; i < conv->getInputs().size(); ++i)
+        if (!isConstant(conv->getInputs(i)))
+            return nullptr;
+    for (size_t i = 1; i < bn->getInputs().size(); ++i)
+        if (!isConstant(bn->getInputs(i)))
+            return nullptr;
+
+    auto weight = conv->getInputs(1), bias = convObj->getBias();
+    const int f = weight->getDims()[0];
+    const size_t perFilter = weight->size() / f;
+    auto mean = bn->getInputs(1)->getRawDataPtr<float *>();
+    auto var = bn->getInputs(2)->getRawDataPtr<float *>();
+    auto scale = bn->getInputs(3)->getRawDataPtr<float *>();
+    auto shift = bn->getInputs(4)->getRawDataPtr<float *>();
+    auto w = weight->getRawDataPtr<float *>();
+    auto b = bias ? bias->getRawDataPtr<float *>() : nullptr;
+    vector<float> newW(weight->size()), newB(f);
+    for (int j = 0; j < f; ++j) {
+        const float a = scale[j] / std::sqrt(var[j] + bn->getEps());
+        for (size_t k = 0; k < perFilter; ++k)
+            newW[j * perFilter + k] = w[j * perFilter + k] * a;
+        newB[j] = ((b ? b[j] : 0.f) - mean[j]) * a + shift[j];
+    }
+    auto addWeight = [&](const Shape &dims, const vector<float> &data) {
+        auto t = g->addTensor(dims, DataType::Float32);
+        t->setWeight();
+        t->dataMalloc();
+        t->copyin(data);
+        return t;
+    };
+    auto foldedWeight = addWeight(weight->getDims(), newW);
+    auto foldedBias = addWeight({f}, newB);
+
+    fused = {conv, bn};
+    auto [ph, pw, sh, sw, dh, dw] = convObj->getPadStrideDilation();
+    return make_ref<ConvObj>(nullptr, conv->getInputs(0), foldedWeight,
+                             bn->getOutput(), ph, pw, sh, sw, dh, dw,
+                             foldedBias);
+}
+
+// MatMul -> Add(bias) becomes a MatMul with a bias, if the GEMM epilogue can
+// broadcast the bias
+static Operator fuseMatmulBias(GraphObj *g, const Operator &op,
+                               OpVec &fused) {
+    if (op->getOpType() != OpType::Add || !isPlainFloat(op->getInputs()))
+        return nullptr;
+    for (int i = 0; i < 2; ++i) {
+        auto matmul = soleProducer(op->getInputs(i), op);
+        if (!matmul || matmul->getOpType() != OpType::MatMul)
+            continue;
+        auto mm = as<MatmulObj>(matmul);
+        if (mm->getBias() || mm->getAct() != ActType::None ||
+            mm->getOutput()->getDims() != op->getOutput()->getDims() ||
+            !isPlainFloat(mm->getInputs()))
+            continue;
+        auto bias = op->getInputs(1 - i);
+        auto dims = bias->getDims();
+        int rank = dims.size();
+        int biasM = rank >= 2 ? dims[rank - 2] : 1;
+        int biasN = rank >= 1 ? dims[rank - 1] : 1;
+        if ((size_t)biasM * biasN != bias->size() ||
+            (biasM != 1 && biasM != mm->getM()) ||
+            (biasN != 1 && biasN != mm->getN()))
+            continue;
+        fused = {matmul, op};
+        return make_ref<MatmulObj>(nullptr, mm->getInputs(0), mm->getInputs(1),
+                                   op->getOutput(), mm->getTransA(),
+                                   mm->getTransB(), bias);
+    }
+    return nullptr;
+}
+
+// Conv or MatMul -> Relu/Sigmoid/Tanh becomes a Conv or MatMul with the
+// activation in its epilogue
+static Operator fuseActivation(GraphObj *g, const Operator &op,
+                               OpVec &fused) {
+    ActType act;
+    switch (op->getOpType().underlying()) {
+    case OpType::Relu:
+        act = ActType::Relu;
+        break;
+    case OpType::Sigmoid:
+        act = ActType::Sigmoid;
+        break;
+    case OpType::Tanh:
+        act = ActType::Tanh;
+        break;
+    default:
+        return nullptr;
+    }
+    auto prev = soleProducer(op->getInputs(0), op);
+    if (!prev || !isPlainFloat(op->getInputs()) ||
+        !isPlainFloat(op->getOutputs()))
+        return nullptr;
+    if (prev->getOpType() == OpType::Conv) {
+        auto conv = as<ConvObj>(prev);
+        if (conv->getAct() != ActType::None)
+            return nullptr;
+        fused = {prev, op};
+        auto [ph, pw, sh, sw, dh, dw] = conv->getPadStrideDilation();
+        return make_ref<ConvObj>(nullptr, conv->getInputs(0),
+                                 conv->getInputs(1), op->getOutput(), ph, pw,
+                                 sh, sw, dh, dw, conv->getBias(), act);
+    }
+    if (prev->getOpType() == OpType::MatMul) {
+        auto mm = as<MatmulObj>(prev);
+        if (mm->getAct() != ActType::None)
+            return nullptr;
+        fused = {prev, op};
+        return make_ref<MatmulObj>(nullptr, mm->getInputs(0), mm->getInputs(1),
+                                   op->getOutput(), mm->getTransA(),
+                                   mm->getTransB(), mm->getBias(), act);
+    }
+    return nullptr;
+}
+
+// Append `op` to a chain of element-wise steps. The running value is input
+// `running` of `op`, and the other operand of a binary `op` is added to
+// `inputs` if needed.
+static bool appendStep(const Operator &op, int running, TensorVec &inputs,
+                       vector<FusedElementWiseObj::Step> &steps) {
+    auto type = op->getOpType();
+    if (!FusedElementWiseObj::isFusable(type) ||
+        op->getInputs(running)->getDims() != op->getOutput()->getDims())
+        return false;
+    if (!type.isBinary()) {
+        steps.push_back({type, -1, false});
+        return true;
+    }
+    auto other = op->getInputs(1 - running);
+    if (other->getDims() != op->getOutput()->getDims() && other->size() != 1)
+        return false;
+    auto it = std::find(inputs.begin(), inputs.end(), other);
+    if (it == inputs.end())
+        it = inputs.insert(it, other);
+    steps.push_back({type, int(it - inputs.begin()), running == 1});
+    return true;
+}
+
+// MatMul(Q, K) -> Div or Mul(scalar) -> Add(mask) -> Softmax(last axis) ->
+// MatMul(V), as exported from attention layers, becomes an Attention. The
+// scaling and the mask are optional. The batch dims of Q, K and V must agree,
+// as the Attention does not broadcast them.
+static Operator fuseAttention(GraphObj *g, const Operator &op,
+                              OpVec &fused) {
+    auto isPlainMatmul = [](const Operator &op) {
+        if (!op || op->getOpType() != OpType::MatMul)
+            return false;
+        auto mm = as<MatmulObj>(op);
+        return !mm->getBias() && mm->getAct() == ActType::None &&
+               !mm->getTransA() && isPlainFloat(op->getInputs());
+    };
+    if (!isPlainMatmul(op) || as<MatmulObj>(op)->getTransB())
+        return nullptr;
+    auto softmax = soleProducer(op->getInputs(0), op);
+    if (!softmax || softmax->getOpType() != OpType::Softmax ||
+        as<SoftmaxObj>(softmax)->getAxis() !=
+            (int)op->getInputs(0)->getRank() - 1)
+        return nullptr;
+    OpVec chain = {softmax, op};
+    auto prev = soleProducer(softmax->getInputs(0), softmax);
+    Tensor mask;
+    if (prev && prev->getOpType() == OpType::Add &&
+        isPlainFloat(prev->getInputs())) {
+        // The scores come from the scaling or the first MatMul
+        int i = 0;
+        for (; i < 2; ++i) {
+            auto source = soleProducer(prev->getInputs(i), prev);
+            if (source && prev->getInputs(i)->getDims() ==
+                              prev->getOutput()->getDims() &&
+                (source->getOpType() == OpType::Div ||
+                 source->getOpType() == OpType::Mul ||
+                 source->getOpType() == OpType::MatMul))
+                break;
+        }
+        if (i == 2)
+            return nullptr;
+        mask = prev->getInputs(1 - i);
+        chain.insert(chain.begin(), prev);
+        prev = soleProducer(prev->getInputs(i), prev);
+    }
+    float scale = 1;
+    if (prev && (prev->getOpType() == OpType::Div ||
+                 prev->getOpType() == OpType::Mul)) {
+        bool isDiv = prev->getOpType() == OpType::Div;
+        // x / c, or x * c in either order
+        int i = isDiv || prev->getInputs(1)->size() == 1 ? 0 : 1;
+        auto factor = prev->getInputs(1 - i);
+        if (factor->size() != 1 || !isConstant(factor) ||
+            !isPlainFloat({factor}))
+            return nullptr;
+        float c = *factor->getRawDataPtr<float *>();
+        scale = isDiv ? 1 / c : c;
+        chain.insert(chain.begin(), prev);
+        prev = soleProducer(prev->getInputs(i), prev);
+    }
+    if (!isPlainMatmul(prev))
+        return nullptr;
+    auto query = prev->getInputs(0), key = prev->getInputs(1),
+         value = op->getInputs(1);
+    auto qDims = query->getDims(), kDims = key->getDims(),
+         vDims = value->getDims();
+    int rank = qDims.size();
+    if ((int)prev->getOutput()->getRank() != rank ||
+        (int)kDims.size() != rank || (int)vDims.size() != rank ||
+        !std::equal(qDims.begin(), qDims.end() - 2, kDims.begin()) ||
+        !std::equal(qDims.begin(), qDims.end() - 2, vDims.begin()))
+        return nullptr;
+    if (mask && (int)mask->getRank() > rank)
+        return nullptr;
+    chain.insert(chain.begin(), prev);
+    fused = chain;
+    return make_ref<AttentionObj>(nullptr, query, key, value, op->getOutput(),
+                                  scale, !as<MatmulObj>(prev)->getTransB(),
+                                  mask);
+}
+
+// The value of `t`, if it is a constant float scalar
+static optional<float> scalarConstant(const Tensor &t) {
+    if (t->size() != 1 || !isConstant(t) || !isPlainFloat({t}))
+        return {};
+    return *t->getRawDataPtr<float *>();
+}
+
+// The first reduced axis, if `op` is a ReduceMean over the trailing dims of
+// its input that keeps them
+static optional<int> trailingMean(const Operator &op) {
+    if (!op || op->getOpType() != OpType::ReduceMean)
+        return {};
+    auto mean = as<ReduceMeanObj>(op);
+    auto &axes = mean->getAxes();
+    int rank = op->getInputs(0)->getRank();
+    if (!mean->getKeepDims() || axes.empty() || *axes.rbegin() != rank - 1 ||
+        (int)axes.size() != rank - *axes.begin())
+        return {};
+    return *axes.begin();
+}
+
+// ReduceMean -> Sub -> Pow(2) -> ReduceMean -> Add(eps) -> Sqrt -> Div ->
+// Mul(scale), the LayerNormalization of exports before opset 17, becomes a
+// LayerNorm. Without the Sub of the mean it is an RMSNorm, whose Div may
+// also be a Mul by the Reciprocal of the Sqrt. Mul(d, d) may stand for the
+// Pow. An Add(bias) after a LayerNorm without one joins it.
+static Operator fuseNormalization(GraphObj *g, const Operator &op,
+                                  OpVec &fused) {
+    if (!isPlainFloat(op->getInputs()) || !isPlainFloat(op->getOutputs()))
+        return nullptr;
+    auto output = op->getOutput();
+    auto dims = output->getDims();
+    if (op->getOpType() == OpType::Add) {
+        for (int i = 0; i < 2; ++i) {
+            auto norm = soleProducer(op->getInputs(i), op);
+            if (!norm || norm->getOpType() != OpType::LayerNormalization)
+                continue;
+            auto ln = as<LayerNormObj>(norm);
+            auto bias = op->getInputs(1 - i);
+            if (ln->getBias() || !isNormalizedShape(dims, ln->getAxis(), bias))
+                continue;
+            fused = {norm, op};
+            return make_ref<LayerNormObj>(nullptr, norm->getInputs(0),
+                                          norm->getInputs(1), output, bias,
+                                          ln->getEps(), ln->getAxis());
+        }
+        return nullptr;
+    }
+    if (op->getOpType() != OpType::Mul)
+        return nullptr;
+    // Mul(scale) of d / sqrt(...), or of d * reciprocal(sqrt(...))
+    Operator norm, sqrt, reciprocal;
+    Tensor scale, d;
+    for (int i = 0; i < 2 && !sqrt; ++i) {
+        norm = soleProducer(op->getInputs(i), op);
+        scale = op->getInputs(1 - i);
+        if (!norm || norm->getInputs(0)->getDims() != dims)
+            continue;
+        if (norm->getOpType() == OpType::Div) {
+            d = norm->getInputs(0);
+            sqrt = soleProducer(norm->getInputs(1), norm);
+        } else if (norm->getOpType() == OpType::Mul) {
+            for (int j = 0; j < 2 && !sqrt; ++j) {
+                auto r = soleProducer(norm->getInputs(j), norm);
+                if (r && r->getOpType() == OpType::Reciprocal) {
+                    reciprocal = r;
+                    d = norm->getInputs(1 - j);
+                    sqrt = soleProducer(r->getInputs(0), r);
+                }
+            }
+        }
+        if (sqrt && sqrt->getOpType() != OpType::Sqrt)
+            sqrt = reciprocal = nullptr;
+    }
+    if (!sqrt || d->getDims() != dims)
+        return nullptr;
+    // Add(eps) of ReduceMean(d^2)
+    auto addEps = soleProducer(sqrt->getInputs(0), sqrt);
+    if (!addEps || addEps->getOpType() != OpType::Add)
+        return nullptr;
+    optional<float> eps;
+    Operator meanSquare;
+    for (int i = 0; i < 2 && !eps; ++i)
+        if ((eps = scalarConstant(addEps->getInputs(1 - i))))
+            meanSquare = soleProducer(addEps->getInputs(i), addEps);
+    auto axis = trailingMean(meanSquare);
+    if (!eps || !axis || !isNormalizedShape(dims, *axis, scale))
+        return nullptr;
+    auto square = soleProducer(meanSquare->getInputs(0), meanSquare);
+    if (!square || square->getInputs(0) != d ||
+        !(square->getOpType() == OpType::Mul
+              ? square->getInputs(1) == d
+              : square->getOpType() == OpType::Pow &&
+                    scalarConstant(square->getInputs(1)) == 2.f))
+        return nullptr;
+    OpVec chain = {square, meanSquare, addEps, sqrt, norm, op};
+    if (reciprocal)
+        chain.insert(chain.begin() + 4, reciprocal);
+    // d = x - ReduceMean(x) makes it a LayerNorm, if nothing else reads d
+    auto sub = d->getSource();
+    auto readers = d->getTargets();
+    if (sub && sub->getOpType() == OpType::Sub && !reciprocal &&
+        !d->isOutput() &&
+        std::all_of(readers.begin(), readers.end(), [&](const Operator &t) {
+            return t == square || t == norm;
+        })) {
+        auto x = sub->getInputs(0);
+        auto mean = soleProducer(sub->getInputs(1), sub);
+        if (mean && mean->getInputs(0) == x && trailingMean(mean) == axis &&
+            x->getDims() == dims) {
+            chain.insert(chain.begin(), {mean, sub});
+            fused = chain;
+            return make_ref<LayerNormObj>(nullptr, x, scale, output, nullptr,
+                                          *eps, *axis);
+        }
+    }
+    fused = chain;
+    return make_ref<RMSNormObj>(nullptr, d, scale, output, *eps, *axis);
+}
+
+// Element-wise op -> element-wise op becomes a FusedElementWise. Longer
+// chains grow one op at a time, as the fused op is the producer of the next.
+static Operator fuseElementWise(GraphObj *g, const Operator &op,
+                                OpVec &fused) {
+    if (!FusedElementWiseObj::isFusable(op->getOpType()) ||
+        !isPlainFloat(op->getInputs()) || !isPlainFloat(op->getOutputs()))
+        return nullptr;
+    for (int i = 0; i < (int)op->getInputs().size(); ++i) {
+        auto prev = soleProducer(op->getInputs(i), op);
+        if (!prev || !isPlainFloat(prev->getInputs()))
+            continue;
+        TensorVec inputs;
+        vector<FusedElementWiseObj::Step> steps;
+        if (prev->getOpType() == OpType::FusedElementWise) {
+            inputs = prev->getInputs();
+            steps = as<FusedElementWiseObj>(prev)->getSteps();
+        } else {
+            int j = 0, n = prev->getInputs().size();
+            while (j < n && (!FusedElementWiseObj::isFusable(
+                                 prev->getOpType()) ||
+                             prev->getInputs(j)->getDims() !=
+                                 prev->getOutput()->getDims()))
+                ++j;
+            if (j == n)
+                continue;
+            inputs = {prev->getInputs(j)};
+            if (!appendStep(prev, j, inputs, steps))
+                continue;
+        }
+        if (!appendStep(op, i, inputs, steps))
+            continue;
+        fused = {prev, op};
+        return make_ref<FusedElementWiseObj>(nullptr, inputs, op->getOutput(),
+                                             steps);
+    }
+    return nullptr;
+}
+
+bool GraphObj::fuseOperators() {
+    // The fused operators only have native CPU kernels, and the MKL kernels
+    // take no folded activations
+    if (runtime->getDevice() != Device::CPU)
+        return false;
+    // Patterns of element-wise steps go first, as fuseElementWise and
+    // fuseMatmulBias would take them apart
+    static const vector<vector<FusionRule>> passes = {
+        {fuseAttention, fuseNormalization},
+        {fuseConvBatchNorm, fuseMatmulBias, fuseActivation, fuseElementWise}};
+    bool changed = false;
+    for (auto &rules : passes) {
+        IT_ASSERT(topo_sort() == true);
+        // Patterns are matched at their last op, so that the fused op of a
+        // pattern can start the pattern of a later op
+        const OpVec order = ops;
+        std::unordered_set<Operator> removed;
+        for (auto &op : order) {
+            if (removed.count(op))
+                continue;
+            for (auto rule : rules) {
+                OpVec fused;
+                if (auto fusedOp = rule(this, op, fused)) {
+                    replaceOperators(fused, fusedOp);
+                    removed.insert(fused.begin(), fused.end());
+                    break;
+                }
+            }
+        }
+        changed |= !removed.empty();
+    }
+    return changed;
+}
+
+void GraphObj::replaceOperators(const OpVec &fused, const Operator &op) {
+    // Connect the new op first, so that the inputs it shares are kept
+    addOperatorAndConnect(op);
+    for (auto &old : fused) {
+        auto outputs = old->getOutputs();
+        detachOperator(old);
+        for (auto &output : outputs)
+            if (output != op->getOutput())
+                removeTensor(output);
+    }
+    op->getOutput()->setSource(op);
+}
+
+} // namespace infini
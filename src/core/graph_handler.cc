@@ -8,10 +8,12 @@
 #include "operators/element_wise.h"
 #include "operators/expand.h"
 #include "operators/gather.h"
+#include "operators/kvcache.h"
+#include "operators/layer_norm.h"
 #include "operators/matmul.h"
 #include "operators/pad.h"
 #include "operators/pooling.h"
-#include "operators/reduce_mean.h"
+#include "operators/reduce.h"
 #include "operators/reshape.h"
 #include "operators/slice.h"
 #include "operators/softmax.h"
@@ -94,6 +96,35 @@ Tensor GraphHandlerObj::batchNormalization(Tensor input, Tensor output,
     }
 }
 
+Tensor GraphHandlerObj::layerNormalization(Tensor input, Tensor scale,
+                                           Tensor output, Tensor bias,
+                                           float eps, int axis) {
+    if (output) {
+        g->addOpWithOutputs<LayerNormObj>(std::move(input), std::move(scale),
+                                          output, std::move(bias), eps, axis);
+        return output;
+    } else {
+        return g
+            ->addOp<LayerNormObj>(std::move(input), std::move(scale), output,
+                                  std::move(bias), eps, axis)
+            ->getOutput();
+    }
+}
+
+Tensor GraphHandlerObj::rmsNorm(Tensor input, Tensor weight, Tensor output,
+                                float eps, int axis) {
+    if (output) {
+        g->addOpWithOutputs<RMSNormObj>(std::move(input), std::move(weight),
+                                        output, eps, axis);
+        return output;
+    } else {
+        return g
+            ->addOp<RMSNormObj>(std::move(input), std::move(weight), output,
+                                eps, axis)
+            ->getOutput();
+    }
+}
+
 Tensor GraphHandlerObj::maxPool(Tensor input, Tensor output, int kh, int kw,
                                 int dh, int dw, int ph, int pw, int sh, int sw,
                                 int ceilMode) {
@@ -199,6 +230,16 @@ Tensor GraphHandlerObj::softmax(Tensor input, Tensor output, int axis) {
     }
 }
 
+Tensor GraphHandlerObj::logSoftmax(Tensor input, Tensor output, int axis) {
+    if (output) {
+        g->addOpWithOutputs<LogSoftmaxObj>(std::move(input), output, axis);
+        return output;
+    } else {
+        return g->addOp<LogSoftmaxObj>(std::move(input), output, axis)
+            ->getOutput();
+    }
+}
+
 Tensor GraphHandlerObj::flatten(Tensor input, Tensor output, int axis) {
     if (output) {
         g->addOpWithOutputs<FlattenObj>(std::move(input), output, axis);
@@ -279,18 +320,32 @@ Tensor GraphHandlerObj::gatherElements(Tensor data, Tensor indices,
     }
 }
 
-Tensor GraphHandlerObj::reduceMean(Tensor data, Tensor reduced,
-                                   const optional<vector<int>> &axes,
-                                   bool keepdims) {
-    if (reduced) {
-        g->addOpWithOutputs<ReduceMeanObj>(std::move(data), reduced, axes,
-                                           keepdims);
-        return reduced;
-    } else {
-        return g->addOp<ReduceMeanObj>(std::move(data), reduced, axes, keepdims)
-            ->getOutput();
+#define DEFINE_REDUCE_METHOD(name, obj)                                        \
+    Tensor GraphHandlerObj::name(Tensor data, Tensor reduced,                  \
+                                 const optional<vector<int>> &axes,            \
+                                 bool keepdims, bool noopWithEmptyAxes) {      \
+        if (reduced) {                                                         \
+            g->addOpWithOutputs<obj##Obj>(std::move(data), reduced, axes,      \
+                                          keepdims, noopWithEmptyAxes);        \
+            return reduced;                                                    \
+        } else {                                                               \
+            return g                                                           \
+                ->addOp<obj##Obj>(std::move(data), reduced, axes, keepdims,    \
+                                  noopWithEmptyAxes)                           \
+                ->getOutput();                                                 \
+        }                                                                      \
     }
-}
+
+DEFINE_REDUCE_METHOD(reduceL1, ReduceL1)
+DEFINE_REDUCE_METHOD(reduceL2, ReduceL2)
+DEFINE_REDUCE_METHOD(reduceLogSum, ReduceLogSum)
+DEFINE_REDUCE_METHOD(reduceLogSumExp, ReduceLogSumExp)
+DEFINE_REDUCE_METHOD(reduceMax, ReduceMax)
+DEFINE_REDUCE_METHOD(reduceMean, ReduceMean)
+DEFINE_REDUCE_METHOD(reduceMin, ReduceMin)
+DEFINE_REDUCE_METHOD(reduceProd, ReduceProd)
+DEFINE_REDUCE_METHOD(reduceSum, ReduceSum)
+DEFINE_REDUCE_METHOD(reduceSumSquare, ReduceSumSquare)
 
 Tensor GraphHandlerObj::slice(Tensor input, Tensor output,
                               const vector<int> &starts,
@@ -425,6 +480,89 @@ Tensor GraphHandlerObj::where(Tensor inputX, Tensor inputY, Tensor condition,
     }
 }
 
+Tensor GraphHandlerObj::kvcacheAppend(Tensor cache, Tensor input,
+                                      Tensor position, Tensor output) {
+    if (output) {
+        g->addOpWithOutputs<KVCacheAppendObj>(
+            std::move(cache), std::move(input), std::move(position), output);
+        return output;
+    } else {
+        return g
+            ->addOp<KVCacheAppendObj>(std::move(cache), std::move(input),
+                                      std::move(position), output)
+            ->getOutput();
+    }
+}
+
+Tensor GraphHandlerObj::attentionKVCache(Tensor query, Tensor keyCache,
+                                         Tensor valueCache, Tensor position,
+                                         Tensor output) {
+    if (output) {
+        g->addOpWithOutputs<AttentionKVCacheObj>(
+            std::move(query), std::move(keyCache), std::move(valueCache),
+            std::move(position), output);
+        return output;
+    } else {
+        return g
+            ->addOp<AttentionKVCacheObj>(std::move(query), std::move(keyCache),
+                                         std::move(valueCache),
+                                         std::move(position), output)
+            ->getOutput();
+    }
+}
+
+void GraphHandlerObj::init_io_buffers(int n) {
+    IT_ASSERT(n > 0);
+    auto runtime = g->getRuntime();
+    ioBuffers.assign(n, {});
+    for (auto &t : g->getTensors()) {
+        bool isIO = (!t->getSource() && !t->isWeight() && !t->isKVCache()) ||
+                    !t->hasTarget();
+        if (!isIO)
+            continue;
+        for (auto &slot : ioBuffers) {
+            auto buffer =
+                make_ref<TensorObj>(t->getDims(), t->getDType(), runtime);
+            buffer->dataMalloc();
+            slot[t.get()] = buffer;
+        }
+    }
+}
+
+Tensor GraphHandlerObj::io_buffer(Tensor t, int slot) {
+    IT_ASSERT(0 <= slot && slot < (int)ioBuffers.size());
+    auto it = ioBuffers[slot].find(t.get());
+    IT_ASSERT(it != ioBuffers[slot].end(), "Not a graph input or output");
+    return it->second;
+}
+
+std::shared_future<void> GraphHandlerObj::run_async(int slot) {
+    IT_ASSERT(-1 <= slot && slot < (int)ioBuffers.size());
+    {
+        std::lock_guard<std::mutex> lock(*runnerMutex);
+        if (!runner)
+            runner = std::make_unique<ThreadPool>(1);
+    }
+    auto promise = std::make_shared<std::promise<void>>();
+    runner->submit([this, slot, promise] {
+        try {
+            if (slot >= 0)
+                for (auto &[t, buffer] : ioBuffers[slot])
+                    if (!t->getSource())
+                        t->copyData(buffer);
+            g->getRuntime()->run(g);
+            if (slot >= 0)
+                for (auto &[t, buffer] : ioBuffers[slot])
+                    if (t->getSource())
+                        buffer->copyData(t);
+            promise->set_value();
+        } catch (...) {
+            promise->set_exception(std::current_exception());
+        }
+    });
+    return promise->get_future().share();
+}
+
 static CastType inferCastType(Tensor input, int to) {
     auto iType = input->getDType();
     auto oType = DataType(to);
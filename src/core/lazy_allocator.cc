@@ -1,4 +1,5 @@
 #include "core/lazy_allocator.h"
+#include <algorithm>
 #include <utility>
 
 namespace infini {
@@ -102,6 +103,14 @@ size_t LazyAllocator::allocWeight(size_t size) {
     return retAddr;
 }
 
+void LazyAllocator::freeWeight() {
+    if (this->weightPtr != nullptr) {
+        runtime->dealloc(this->weightPtr);
+        this->weightPtr = nullptr;
+    }
+    this->weightPeak = 0;
+}
+
 void LazyAllocator::free(size_t addr, size_t size) {
     IT_ASSERT(this->ptr == nullptr);
     size = getAlignedSize(size);
@@ -164,7 +173,12 @@ void *LazyAllocator::getWeightPtr() {
     return this->weightPtr;
 }
 
-size_t LazyAllocator::getAlignedSize(size_t size) {
+void LazyAllocator::reserve(size_t size) {
+    IT_ASSERT(this->ptr == nullptr);
+    this->peak = std::max(this->peak, getAlignedSize(size));
+}
+
+size_t LazyAllocator::getAlignedSize(size_t size) const {
     return ((size - 1) / this->alignment + 1) * this->alignment;
 }
 
@@ -0,0 +1,137 @@
+#include "core/memory_planner.h"
+#include <algorithm>
+#include <numeric>
+
+namespace infini {
+
+const char *toString(MemoryPlanner planner) {
+    switch (planner) {
+    case MemoryPlanner::Auto:
+        return "Auto";
+    case MemoryPlanner::Greedy:
+        return "Greedy";
+    case MemoryPlanner::GreedyBySize:
+        return "GreedyBySize";
+    case MemoryPlanner::IntervalColouring:
+        return "IntervalColouring";
+    case MemoryPlanner::Reorder:
+        return "Reorder";
+    }
+    IT_TODO_HALT();
+}
+
+static bool isLiveTogether(const MemoryBuffer &a, const MemoryBuffer &b) {
+    return a.start <= b.end && b.start <= a.end;
+}
+
+size_t liveBytesLowerBound(const vector<MemoryBuffer> &buffers) {
+    // (step, change of the live bytes), the frees of a step sort after its
+    // allocations as they happen at the next step
+    vector<std::pair<int, long long>> events;
+    for (auto &buffer : buffers) {
+        events.emplace_back(buffer.start, buffer.size);
+        events.emplace_back(buffer.end + 1, -(long long)buffer.size);
+    }
+    std::sort(events.begin(), events.end());
+    long long live = 0, maxLive = 0;
+    for (size_t i = 0; i < events.size(); ++i) {
+        live += events[i].second;
+        if (i + 1 == events.size() || events[i + 1].first != events[i].first)
+            maxLive = std::max(maxLive, live);
+    }
+    return maxLive;
+}
+
+MemoryPlan planGreedy(const vector<MemoryBuffer> &buffers,
+                      LazyAllocator &allocator) {
+    int steps = 0;
+    for (auto &buffer : buffers)
+        steps = std::max(steps, buffer.end + 1);
+    vector<vector<int>> allocAt(steps), freeAt(steps);
+    for (int i = 0; i < (int)buffers.size(); ++i) {
+        allocAt[buffers[i].start].emplace_back(i);
+        freeAt[buffers[i].end].emplace_back(i);
+    }
+    MemoryPlan plan{MemoryPlanner::Greedy, vector<size_t>(buffers.size()), 0,
+                    liveBytesLowerBound(buffers)};
+    allocator.init();
+    // the outputs of a step are allocated before its inputs are freed
+    for (int step = 0; step < steps; ++step) {
+        for (int i : allocAt[step])
+            plan.offsets[i] = allocator.alloc(buffers[i].size);
+        for (int i : freeAt[step])
+            allocator.free(plan.offsets[i], buffers[i].size);
+    }
+    plan.peak = allocator.getPeak();
+    return plan;
+}
+
+// Place the buffers one by one in `order`, each into a gap left among the
+// placed buffers it is live with: the lowest gap that fits, or the smallest
+// one if `bestFit`. Without such a gap, it goes above them.
+static MemoryPlan placeInOrder(const vector<MemoryBuffer> &buffers,
+                               const vector<int> &order, bool bestFit) {
+    MemoryPlan plan{MemoryPlanner::Auto, vector<size_t>(buffers.size()), 0,
+                    liveBytesLowerBound(buffers)};
+    vector<int> placed;
+    for (int i : order) {
+        auto &buffer = buffers[i];
+        // (offset, end) of the placed buffers live with this one
+        vector<std::pair<size_t, size_t>> taken;
+        for (int j : placed)
+            if (isLiveTogether(buffer, buffers[j]))
+                taken.emplace_back(plan.offsets[j],
+                                   plan.offsets[j] + buffers[j].size);
+        std::sort(taken.begin(), taken.end());
+        size_t offset = 0, top = 0, bestGap = SIZE_MAX;
+        bool found = false;
+        for (auto &[begin, end] : taken) {
+            if (begin > top && begin - top >= buffer.size) {
+                size_t gap = begin - top;
+                if (!found || (bestFit && gap < bestGap)) {
+                    offset = top;
+                    bestGap = gap;
+                    found = true;
+                }
+                if (!bestFit)
+                    break;
+            }
+            top = std::max(top, end);
+        }
+        if (!found)
+            offset = top;
+        plan.offsets[i] = offset;
+        plan.peak = std::max(plan.peak, offset + buffer.size);
+        placed.emplace_back(i);
+    }
+    return plan;
+}
+
+MemoryPlan planGreedyBySize(const vector<MemoryBuffer> &buffers) {
+    vector<int> order(buffers.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return buffers[a].size > buffers[b].size;
+    });
+    auto plan = placeInOrder(buffers, order, true);
+    plan.planner = MemoryPlanner::GreedyBySize;
+    return plan;
+}
+
+MemoryPlan planIntervalColouring(const vector<MemoryBuffer> &buffers) {
+    // the weighted degree of a buffer in the conflict graph, including itself
+    vector<size_t> degree(buffers.size());
+    for (size_t i = 0; i < buffers.size(); ++i)
+        for (size_t j = 0; j < buffers.size(); ++j)
+            if (isLiveTogether(buffers[i], buffers[j]))
+                degree[i] += buffers[j].size;
+    vector<int> order(buffers.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) { return degree[a] > degree[b]; });
+    auto plan = placeInOrder(buffers, order, false);
+    plan.planner = MemoryPlanner::IntervalColouring;
+    return plan;
+}
+
+} // namespace infini
@@ -198,6 +198,11 @@ const char *OpType::toString() const {
         CASE(G2BMM);
         CASE(GBMM);
         CASE(MemBound);
+        CASE(FusedElementWise);
+        CASE(KVCacheAppend);
+        CASE(AttentionKVCache);
+        CASE(Attention);
+        CASE(RMSNorm);
         // TODO
         CASE(ConvTransNHWC);
         CASE(ConvBackwardFilter);
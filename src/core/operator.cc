@@ -36,6 +36,14 @@ void OperatorObj::replaceInput(Tensor t1, Tensor t2) {
     }
 }
 
+void OperatorObj::replaceOutput(Tensor t1, Tensor t2) {
+    for (auto itr = outputs.begin(); itr != outputs.end(); ++itr) {
+        if (*itr == t1) {
+            *itr = t2;
+        }
+    }
+}
+
 OpPerfKey OperatorObj::getOpPerfKey() const {
     auto workloadVector = getWorkloadVector();
     // Calculate hash of workload, i.e. hash with shape. This is different from
@@ -54,6 +62,12 @@ HashType OperatorObj::hash() const {
     return hash;
 }
 
+bool OperatorObj::isAliasedView() const {
+    return isView() && inputs[0]->hasData() && outputs[0]->hasData() &&
+           inputs[0]->getRawDataPtr<void *>() ==
+               outputs[0]->getRawDataPtr<void *>();
+}
+
 bool OperatorObj::checkValid(GraphObj *graph) {
     auto optShapes = inferShape();
     if (!optShapes) // shape inference failed
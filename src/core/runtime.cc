@@ -1,45 +1,174 @@
 #include "core/runtime.h"
 #include "core/blob.h"
+#include "core/execution_plan.h"
+#include "core/graph.h"
 #include "core/kernel.h"
 #include "core/perf_engine.h"
 #include "utils/data_generator.h"
+#include "utils/thread_pool.h"
 #include <chrono>
+#include <condition_variable>
 #include <cstring>
+#include <omp.h>
 namespace infini {
-void CpuRuntimeObj::run(const Graph &graph, bool tune, bool profiling) const {
-    if (!tune && profiling)
-        IT_TODO_HALT();
+ExecutionPlan CpuRuntimeObj::compile(const Graph &graph, bool tune) const {
     const auto &kernelRegistry = KernelRegistry::getInstance();
     auto &perfEngine = PerfEngine::getInstance();
-    // Statistics
-    double totalTime = 0;
-    std::map<OpType, double> opTime;
-    std::map<OpType, int> opCnt;
-
+    ExecutionPlan plan;
+    plan.version = graph->getVersion();
+    plan.tuned = tune;
     for (auto &op : graph->getOperators()) {
+        // Views planned onto the memory of their input have nothing to do
+        if (op->isAliasedView())
+            continue;
         auto kernelAttrs =
             KernelAttrs{device, op->getOpType().underlying(), op->getDType()};
         Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
         auto perfKey = PerfEngine::Key{kernelAttrs, op->getOpPerfKey()};
-        auto perfData = perfEngine.getPerfData(perfKey);
+        PerfRecord record = perfEngine.getPerfData(perfKey);
+        // Tune the kernel if there is no record. Another thread compiling the
+        // same op may store its record first.
+        if (!record && tune)
+            record = perfEngine.addPerfData(perfKey, kernel->tune(op, this));
+        plan.steps.push_back({kernel, op, record});
+    }
+    if (interOpThreads > 1) {
+        // The memory ranges each step reads and writes. Comparing memory
+        // rather than tensors also orders the steps sharing a buffer in the
+        // memory plan, and views aliasing their input.
+        using Range = std::pair<uint8_t *, uint8_t *>;
+        auto rangesOf = [](const TensorVec &tensors) {
+            vector<Range> ranges;
+            for (auto &t : tensors) {
+                auto begin = t->getRawDataPtr<uint8_t *>();
+                ranges.emplace_back(begin, begin + t->getBytes());
+            }
+            return ranges;
+        };
+        auto overlap = [](const vector<Range> &a, const vector<Range> &b) {
+            for (auto &x : a)
+                for (auto &y : b)
+                    if (x.first < y.second && y.first < x.second)
+                        return true;
+            return false;
+        };
+        const int n = plan.steps.size();
+        vector<vector<Range>> reads(n), writes(n);
+        for (int i = 0; i < n; ++i) {
+            reads[i] = rangesOf(plan.steps[i].op->getInputs());
+            writes[i] = rangesOf(plan.steps[i].op->getOutputs());
+        }
+        plan.concurrent = true;
+        plan.successors.assign(n, {});
+        plan.numPredecessors.assign(n, 0);
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < i; ++j)
+                if (overlap(writes[j], reads[i]) ||
+                    overlap(writes[j], writes[i]) ||
+                    overlap(reads[j], writes[i])) {
+                    plan.successors[j].emplace_back(i);
+                    plan.numPredecessors[i] += 1;
+                }
+    }
+    return plan;
+}
+
+void CpuRuntimeObj::setInterOpThreads(int threads) {
+    IT_ASSERT(threads > 0);
+    std::lock_guard<std::mutex> lock(poolMutex);
+    interOpThreads = threads;
+    pool.reset();
+}
 
-        // If no record and disable tuning, run with the default argument
-        if (!perfData && !tune) {
+void CpuRuntimeObj::runConcurrently(const ExecutionPlan &plan) const {
+    std::shared_ptr<ThreadPool> workers;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!pool) {
+            // Each worker gets an equal share of the cores for the OpenMP
+            // regions of its operators
+            int ompThreads =
+                std::max(1, omp_get_max_threads() / interOpThreads);
+            pool = std::make_shared<ThreadPool>(
+                interOpThreads,
+                [ompThreads](int) { omp_set_num_threads(ompThreads); });
+        }
+        workers = pool;
+    }
+    const int n = plan.steps.size();
+    auto pending = std::make_unique<std::atomic<int>[]>(n);
+    for (int i = 0; i < n; ++i)
+        pending[i] = plan.numPredecessors[i];
+    // Steps not yet finished, guarded by doneMutex. The last step notifies
+    // while holding it, so that the wait below, and with it these locals,
+    // outlive every access of a worker.
+    int remaining = n;
+    std::mutex doneMutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+    std::atomic<bool> failed{false};
+    std::function<void(int)> launch = [&](int i) {
+        workers->submit([&, i] {
+            auto &step = plan.steps[i];
+            // After a failure, the remaining steps are only counted down
+            if (!failed) {
+                try {
+                    if (step.record)
+                        step.kernel->compute(step.op, step.record, this);
+                    else
+                        step.kernel->compute(step.op, this);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(doneMutex);
+                    if (!failed.exchange(true))
+                        error = std::current_exception();
+                }
+            }
+            for (int next : plan.successors[i])
+                if (--pending[next] == 0)
+                    launch(next);
+            std::lock_guard<std::mutex> lock(doneMutex);
+            if (--remaining == 0)
+                done.notify_all();
+        });
+    };
+    for (int i = 0; i < n; ++i)
+        if (plan.numPredecessors[i] == 0)
+            launch(i);
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [&] { return remaining == 0; });
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+
+void CpuRuntimeObj::run(const Graph &graph, bool tune, bool profiling) const {
+    if (!tune && profiling)
+        IT_TODO_HALT();
+    auto &plan = graph->getExecutionPlan();
+    if (plan.version != graph->getVersion() || (tune && !plan.tuned) ||
+        plan.concurrent != (interOpThreads > 1))
+        plan = compile(graph, tune);
+    // Profiling times the operators one by one
+    if (plan.concurrent && !profiling) {
+        runConcurrently(plan);
+        return;
+    }
+    // Statistics
+    double totalTime = 0;
+    std::map<OpType, double> opTime;
+    std::map<OpType, int> opCnt;
+
+    for (auto &step : plan.steps) {
+        auto kernel = step.kernel;
+        auto &op = step.op;
+        auto &record = step.record;
+        // If no record, run with the default argument
+        if (!record) {
             kernel->compute(op, this);
             continue;
         }
 
-        // TODO: The copy of record should be eliminated
-        PerfRecord record;
-        // Tune the kernel if there is no record
-        if (!perfData) {
-            // TODO: record is not used
-            // printf("no record data\n");
-            record = kernel->tune(op, this);
-            perfEngine.setPerfData(perfKey, record);
-        } else
-            record = perfData;
-
         if (!profiling) {
             kernel->compute(op, record, this);
             continue;
@@ -66,6 +195,9 @@ double RuntimeObj::getPerfTime(const Graph &graph, bool profiling) const {
     std::map<OpType, int> opCnt;
 
     for (auto &op : graph->getOperators()) {
+        // Views planned onto the memory of their input have nothing to do
+        if (op->isAliasedView())
+            continue;
         auto kernelAttrs =
             KernelAttrs{device, op->getOpType().underlying(), op->getDType()};
         Kernel *kernel = kernelRegistry.getKernel(kernelAttrs);
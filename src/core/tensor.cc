@@ -23,7 +23,10 @@ string TensorObj::toString() const {
     string ret = "Tensor " + std::to_string(guid) + ", Fuid " +
                  std::to_string(fuid) + ", shape " + vecToString(shape) +
                  ", dtype " + dtype.toString() + ", " + runtime->toString() +
-                 ", " + ss.str() + ", " + tensorTypeToString() + "\n";
+                 ", " + ss.str() + ", " + tensorTypeToString();
+    if (channelBlock > 1)
+        ret += ", layout nChw" + std::to_string(channelBlock) + "c";
+    ret += "\n";
     vector<UidBaseType> targetGuids;
     for (const auto &op : targets)
         targetGuids.emplace_back(op.lock()->getGuid());
@@ -152,6 +155,27 @@ void TensorObj::setData(
 
 void TensorObj::setDataBlob(const Blob &blob) { this->data = blob; }
 
+void TensorObj::setDimSymbol(int i, const string &symbol) {
+    IT_ASSERT(0 <= i && i < (int)shape.size());
+    dimSymbols.resize(shape.size());
+    dimSymbols[i] = symbol;
+}
+
+vector<string> TensorObj::getDimSymbols() const {
+    auto ans = dimSymbols;
+    ans.resize(shape.size());
+    return ans;
+}
+
+void TensorObj::setShape(Shape shape_) {
+    IT_ASSERT(shape_.size() == shape.size(), "The rank can not change");
+    shape = std::move(shape_);
+    _size = std::accumulate(shape.begin(), shape.end(), size_t(1),
+                            std::multiplies{});
+    IT_ASSERT(channelBlock == 1 || shape[1] % channelBlock == 0,
+              "Channels must be a multiple of the layout block.");
+}
+
 void TensorObj::load(std::string file_path) { loadTensorData(this, file_path); }
 
 void TensorObj::save(std::string file_path) { saveTensorData(this, file_path); }
@@ -24,6 +24,9 @@ void CudaRuntimeObj::runWithoutSync(const Graph &graph) const {
     const auto &kernelRegistry = KernelRegistry::getInstance();
     auto &perfEngine = PerfEngine::getInstance();
     for (auto &op : graph->getOperators()) {
+        // Views planned onto the memory of their input have nothing to do
+        if (op->isAliasedView())
+            continue;
         // HACK: set correct data type
         auto kernelAttrs =
             KernelAttrs{device, op->getOpType().underlying(), op->getDType()};
@@ -47,6 +50,9 @@ void CudaRuntimeObj::tune(const Graph &graph, bool profiling = false) const {
     std::map<OpType, double> opTime;
     std::map<OpType, int> opCnt;
     for (auto &op : graph->getOperators()) {
+        // Views planned onto the memory of their input have nothing to do
+        if (op->isAliasedView())
+            continue;
         // HACK: set correct data type
         auto kernelAttrs = KernelAttrs{device, op->getOpType().underlying(),
                                        DataType::Float32};
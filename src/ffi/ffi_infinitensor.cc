@@ -1,3 +1,4 @@
+#include "core/batch_scheduler.h"
 #include "core/data_type.h"
 #include "core/graph_handler.h"
 #include "operators/batch_norm.h"
@@ -5,11 +6,13 @@
 #include "operators/conv.h"
 #include "operators/expand.h"
 #include "operators/gather.h"
+#include "operators/layer_norm.h"
 #include "operators/matmul.h"
 #include "operators/pad.h"
 #include "operators/pooling.h"
-#include "operators/reduce_mean.h"
+#include "operators/reduce.h"
 #include "operators/reshape.h"
+#include "operators/softmax.h"
 #include "operators/split.h"
 #include "operators/transpose.h"
 #include "operators/unary.h"
@@ -89,12 +92,24 @@ void export_values(py::module &m) {
         .VALUE(OpType, Pow)
         .VALUE(OpType, Gather)
         .VALUE(OpType, GatherElements)
+        .VALUE(OpType, ReduceL1)
+        .VALUE(OpType, ReduceL2)
+        .VALUE(OpType, ReduceLogSum)
+        .VALUE(OpType, ReduceLogSumExp)
+        .VALUE(OpType, ReduceMax)
         .VALUE(OpType, ReduceMean)
+        .VALUE(OpType, ReduceMin)
+        .VALUE(OpType, ReduceProd)
+        .VALUE(OpType, ReduceSum)
+        .VALUE(OpType, ReduceSumSquare)
         .VALUE(OpType, Reshape)
         .VALUE(OpType, Flatten)
         .VALUE(OpType, Identity)
         .VALUE(OpType, BatchNormalization)
+        .VALUE(OpType, LayerNormalization)
+        .VALUE(OpType, RMSNorm)
         .VALUE(OpType, Softmax)
+        .VALUE(OpType, LogSoftmax)
         .VALUE(OpType, Relu)
         .VALUE(OpType, Gelu)
         .VALUE(OpType, PRelu)
@@ -188,10 +203,11 @@ conv_trans_attrs_of(Operator op) {
                            opw);
 }
 
-static std::tuple<bool, bool> matmul_attrs_of(Operator op) {
+static std::tuple<bool, bool, ActType> matmul_attrs_of(Operator op) {
     IT_ASSERT(op->getOpType() == OpType::MatMul);
     auto matmul = dynamic_cast<const MatmulObj *>(op.get());
-    return std::make_tuple(matmul->getTransA(), matmul->getTransB());
+    return std::make_tuple(matmul->getTransA(), matmul->getTransB(),
+                           matmul->getAct());
 }
 
 static std::tuple<float, float, bool> batch_norm_attrs_of(Operator op) {
@@ -201,6 +217,16 @@ static std::tuple<float, float, bool> batch_norm_attrs_of(Operator op) {
                            batchnorm->getTrainingMode());
 }
 
+static std::tuple<float, int> norm_attrs_of(Operator op) {
+    if (op->getOpType() == OpType::RMSNorm) {
+        auto norm = dynamic_cast<const RMSNormObj *>(op.get());
+        return std::make_tuple(norm->getEps(), norm->getAxis());
+    }
+    IT_ASSERT(op->getOpType() == OpType::LayerNormalization);
+    auto norm = dynamic_cast<const LayerNormObj *>(op.get());
+    return std::make_tuple(norm->getEps(), norm->getAxis());
+}
+
 static std::tuple<int, int, int, int, int, int, int, int, int>
 pool_attrs_of(Operator op) {
     IT_ASSERT(op->getOpType() == OpType::MaxPool ||
@@ -218,12 +244,12 @@ clip_attrs_of(Operator op) {
     return std::make_tuple(clip->getMin(), clip->getMax());
 }
 
-static std::tuple<vector<int>, bool> reduce_mean_attrs_of(Operator op) {
-    IT_ASSERT(op->getOpType() == OpType::ReduceMean);
-    auto reduce_mean = dynamic_cast<const ReduceMeanObj *>(op.get());
-    auto &set = reduce_mean->getAxes();
+static std::tuple<vector<int>, bool> reduce_attrs_of(Operator op) {
+    auto reduce = dynamic_cast<const ReduceBaseObj *>(op.get());
+    IT_ASSERT(reduce);
+    auto &set = reduce->getAxes();
     return std::make_tuple(vector(set.begin(), set.end()),
-                           reduce_mean->getKeepDims());
+                           reduce->getKeepDims());
 }
 
 static int concat_axis_of(Operator op) {
@@ -274,6 +300,12 @@ static vector<int> transpose_permute_of(Operator op) {
     return dynamic_cast<const TransposeObj *>(op.get())->getPermute();
 }
 
+static int softmax_axis_of(Operator op) {
+    IT_ASSERT(op->getOpType() == OpType::Softmax ||
+              op->getOpType() == OpType::LogSoftmax);
+    return dynamic_cast<const SoftmaxObj *>(op.get())->getAxis();
+}
+
 static int flatten_axis_of(Operator op) {
     IT_ASSERT(op->getOpType() == OpType::Flatten);
     return dynamic_cast<const FlattenObj *>(op.get())->getAxis();
@@ -309,9 +341,10 @@ void export_functions(py::module &m) {
         .FUNCTION(conv_trans_attrs_of)
         .FUNCTION(matmul_attrs_of)
         .FUNCTION(batch_norm_attrs_of)
+        .FUNCTION(norm_attrs_of)
         .FUNCTION(pool_attrs_of)
         .FUNCTION(clip_attrs_of)
-        .FUNCTION(reduce_mean_attrs_of)
+        .FUNCTION(reduce_attrs_of)
         .FUNCTION(tensor_dtype)
         .FUNCTION(reshape_shape_of)
         .FUNCTION(expand_shape_of)
@@ -321,6 +354,7 @@ void export_functions(py::module &m) {
         .FUNCTION(split_axis_of)
         .FUNCTION(gather_axis_of)
         .FUNCTION(flatten_axis_of)
+        .FUNCTION(softmax_axis_of)
         .FUNCTION(cast_to_of);
 #undef FUNCTION
 }
@@ -389,7 +423,10 @@ void init_graph_builder(py::module &m) {
         .def("shape", &TensorObj::getDims, policy::move)
         .def("set_weight", &TensorObj::setWeight, policy::move)
         .def("set_input", &TensorObj::setInput, policy::move)
+        .def("set_kvcache", &TensorObj::setKVCache, policy::move)
         .def("set_output", &TensorObj::setOutput, policy::move)
+        .def("set_dim_symbol", &TensorObj::setDimSymbol, policy::move)
+        .def("dim_symbols", &TensorObj::getDimSymbols, policy::move)
         .def("dtype", &TensorObj::getDTypeIndex, policy::automatic)
         .def("copyin_float", &TensorObj::copyin<float>, policy::move)
         .def("copyin_int32", &TensorObj::copyin<int32_t>, policy::move)
@@ -445,6 +482,15 @@ void init_graph_builder(py::module &m) {
         .def("outputs",
              py::overload_cast<>(&OperatorObj::getOutputs, py::const_),
              policy::reference);
+    py::class_<std::shared_future<void>>(m, "RunFuture")
+        .def(
+            "wait",
+            [](const std::shared_future<void> &future) { future.get(); },
+            py::call_guard<py::gil_scoped_release>())
+        .def("done", [](const std::shared_future<void> &future) {
+            return future.wait_for(std::chrono::seconds(0)) ==
+                   std::future_status::ready;
+        });
     py::class_<Handler>(m, "GraphHandler")
         .def(py::init<Runtime>())
         .def("tensor", &Handler::tensor, policy::move)
@@ -452,6 +498,9 @@ void init_graph_builder(py::module &m) {
         .def("convTransposed2d", &Handler::convTransposed2d, policy::move)
         .def("matmul", &Handler::matmul, policy::move)
         .def("batchNormalization", &Handler::batchNormalization, policy::move)
+        .def("layerNormalization", &Handler::layerNormalization,
+             policy::move)
+        .def("rmsNorm", &Handler::rmsNorm, policy::move)
         .def("maxPool", &Handler::maxPool, policy::move)
         .def("avgPool", &Handler::avgPool, policy::move)
         .def("add", &Handler::add, policy::move)
@@ -468,6 +517,7 @@ void init_graph_builder(py::module &m) {
         .def("hardSigmoid", &Handler::hardSigmoid, policy::move)
         .def("hardSwish", &Handler::hardSwish, policy::move)
         .def("softmax", &Handler::softmax, policy::move)
+        .def("log_softmax", &Handler::logSoftmax, policy::move)
         .def("abs", &Handler::abs, policy::move)
         .def("sqrt", &Handler::sqrt, policy::move)
         .def("neg", &Handler::neg, policy::move)
@@ -482,7 +532,16 @@ void init_graph_builder(py::module &m) {
         .def("split", &Handler::split, policy::move)
         .def("gather", &Handler::gather, policy::move)
         .def("gatherElements", &Handler::gatherElements, policy::move)
+        .def("reduce_l1", &Handler::reduceL1, policy::move)
+        .def("reduce_l2", &Handler::reduceL2, policy::move)
+        .def("reduce_log_sum", &Handler::reduceLogSum, policy::move)
+        .def("reduce_log_sum_exp", &Handler::reduceLogSumExp, policy::move)
+        .def("reduce_max", &Handler::reduceMax, policy::move)
         .def("reduce_mean", &Handler::reduceMean, policy::move)
+        .def("reduce_min", &Handler::reduceMin, policy::move)
+        .def("reduce_prod", &Handler::reduceProd, policy::move)
+        .def("reduce_sum", &Handler::reduceSum, policy::move)
+        .def("reduce_sum_square", &Handler::reduceSumSquare, policy::move)
         .def("slice", &Handler::slice, policy::move)
         .def("pad", &Handler::pad, policy::move)
         .def("allReduceSum", &Handler::allReduceSum, policy::move)
@@ -496,14 +555,81 @@ void init_graph_builder(py::module &m) {
         .def("expand", &Handler::expand, policy::move)
         .def("erf", &Handler::erf, policy::move)
         .def("where", &Handler::where, policy::move)
+        .def("kvcache_append", &Handler::kvcacheAppend, policy::move)
+        .def("attention_kvcache", &Handler::attentionKVCache, policy::move)
         .def("topo_sort", &Handler::topo_sort, policy::automatic)
         .def("optimize", &Handler::optimize, policy::automatic)
         .def("operators", &Handler::operators, policy::move)
         .def("data_malloc", &Handler::data_malloc, policy::automatic)
         .def("get_perf_time", &Handler::get_perf_time, policy::automatic)
         .def("tune", &Handler::tune, policy::automatic)
-        .def("run", &Handler::run, policy::automatic)
+        .def("run", &Handler::run, policy::automatic,
+             py::call_guard<py::gil_scoped_release>())
+        .def("set_symbols", &Handler::set_symbols, policy::automatic)
+        .def("symbols", &Handler::symbols, policy::move)
+        .def("instantiate", &Handler::instantiate, policy::move)
+        .def("init_io_buffers", &Handler::init_io_buffers, policy::automatic)
+        .def("io_buffer", &Handler::io_buffer, policy::move)
+        .def("run_async", &Handler::run_async, py::arg("slot") = -1,
+             py::call_guard<py::gil_scoped_release>())
         .def("get_perf_time", &Handler::get_perf_time, policy::automatic);
+    using Sample = BatchScheduler::Sample;
+    py::class_<std::shared_future<Sample>>(m, "BatchFuture")
+        .def("get",
+             [](const std::shared_future<Sample> &future) {
+                 {
+                     py::gil_scoped_release release;
+                     future.wait();
+                 }
+                 py::list outputs;
+                 for (auto &output : future.get())
+                     outputs.append(py::bytes(
+                         reinterpret_cast<const char *>(output.data()),
+                         output.size()));
+                 return outputs;
+             })
+        .def("done", [](const std::shared_future<Sample> &future) {
+            return future.wait_for(std::chrono::seconds(0)) ==
+                   std::future_status::ready;
+        });
+    py::class_<BatchScheduler>(m, "BatchScheduler")
+        .def(py::init([](const vector<std::tuple<Handler *, TensorVec,
+                                                 TensorVec>> &buckets,
+                         int64_t maxDelayUs) {
+                 vector<BatchScheduler::Bucket> ans;
+                 for (auto &[handler, inputs, outputs] : buckets)
+                     ans.push_back({handler->graph(), inputs, outputs});
+                 return std::make_unique<BatchScheduler>(
+                     std::move(ans), std::chrono::microseconds(maxDelayUs));
+             }),
+             py::arg("buckets"), py::arg("max_delay_us"))
+        .def("submit",
+             [](BatchScheduler &self, const vector<py::buffer> &inputs) {
+                 Sample sample;
+                 for (auto &input : inputs) {
+                     py::buffer_info info = input.request();
+                     auto data = static_cast<const uint8_t *>(info.ptr);
+                     sample.emplace_back(data,
+                                         data + info.size * info.itemsize);
+                 }
+                 py::gil_scoped_release release;
+                 return self.submit(std::move(sample));
+             })
+        .def("max_batch_size", &BatchScheduler::getMaxBatchSize)
+        .def("queue_depth", &BatchScheduler::getQueueDepth,
+             py::call_guard<py::gil_scoped_release>())
+        .def("latency_histogram",
+             [](const BatchScheduler &self) {
+                 return self.getLatency().counts;
+             })
+        .def(
+            "latency_percentile",
+            [](const BatchScheduler &self, double q) {
+                return self.getLatency().percentile(q);
+            },
+            py::arg("q"))
+        .def("batch_counts", &BatchScheduler::getBatchCounts)
+        .def("reset_stats", &BatchScheduler::resetStats);
 }
 
 } // namespace infini
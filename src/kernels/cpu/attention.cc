@@ -0,0 +1,130 @@
+#include "operators/attention.h"
+#include "core/kernel.h"
+#include <cmath>
+
+namespace infini {
+
+// A tile of blockQ queries goes over the keys blockK at a time, keeping
+// blockQ x blockK scores and the running max, sum and output of each query
+template <typename T> class BlockedAttention : public CpuKernelWithoutConfig {
+    static constexpr int blockQ = 16, blockK = 64;
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<AttentionObj>(_op);
+        auto qDims = op->getInputs(0)->getDims();
+        auto vDims = op->getInputs(2)->getDims();
+        const int rank = qDims.size();
+        const int seqQ = qDims[rank - 2], dim = qDims[rank - 1],
+                  seqK = vDims[rank - 2], dimV = vDims[rank - 1];
+        const int batch = op->getInputs(0)->size() / (seqQ * dim);
+        const T scale = op->getScale();
+        // key(j, d) is at k[j * kRow + d * kCol]
+        const size_t kRow = op->getTransK() ? 1 : dim,
+                     kCol = op->getTransK() ? seqK : 1;
+        T *q = op->getInputs(0)->getRawDataPtr<T *>();
+        T *k = op->getInputs(1)->getRawDataPtr<T *>();
+        T *v = op->getInputs(2)->getRawDataPtr<T *>();
+        T *y = op->getOutput()->getRawDataPtr<T *>();
+
+        // The strides of the mask along the dims of the scores, which are 0
+        // where it broadcasts
+        auto mask = op->getMask();
+        T *maskPtr = mask ? mask->getRawDataPtr<T *>() : nullptr;
+        vector<size_t> maskStride(rank, 0);
+        if (mask) {
+            auto dims = mask->getDims();
+            size_t stride = 1;
+            for (int i = dims.size() - 1, j = rank - 1; i >= 0; --i, --j) {
+                maskStride[j] = dims[i] == 1 ? 0 : stride;
+                stride *= dims[i];
+            }
+        }
+        auto maskOffset = [&](int b) {
+            size_t offset = 0;
+            for (int i = rank - 3; i >= 0; --i) {
+                offset += b % qDims[i] * maskStride[i];
+                b /= qDims[i];
+            }
+            return offset;
+        };
+
+        const int tiles = (seqQ + blockQ - 1) / blockQ;
+#pragma omp parallel for collapse(2)
+        for (int b = 0; b < batch; ++b) {
+            for (int tile = 0; tile < tiles; ++tile) {
+                const int i0 = tile * blockQ,
+                          rows = std::min(blockQ, seqQ - i0);
+                const T *qb = q + (size_t(b) * seqQ + i0) * dim;
+                const T *kb = k + size_t(b) * seqK * dim;
+                const T *vb = v + size_t(b) * seqK * dimV;
+                T *yb = y + (size_t(b) * seqQ + i0) * dimV;
+                const T *mb = maskPtr ? maskPtr + maskOffset(b) +
+                                            i0 * maskStride[rank - 2]
+                                      : nullptr;
+                vector<T> scores(blockQ * blockK), acc(rows * dimV, 0);
+                vector<T> max(rows, -INFINITY), sum(rows, 0);
+                for (int j0 = 0; j0 < seqK; j0 += blockK) {
+                    const int cols = std::min(blockK, seqK - j0);
+                    for (int r = 0; r < rows; ++r) {
+                        T *s = &scores[r * blockK];
+                        const T *qi = qb + r * dim;
+                        // Walk the keys along their contiguous dim
+                        if (kCol == 1) {
+                            for (int c = 0; c < cols; ++c) {
+                                const T *kj = kb + (j0 + c) * kRow;
+                                T dot = 0;
+                                for (int d = 0; d < dim; ++d)
+                                    dot += qi[d] * kj[d];
+                                s[c] = dot;
+                            }
+                        } else {
+                            for (int c = 0; c < cols; ++c)
+                                s[c] = 0;
+                            for (int d = 0; d < dim; ++d) {
+                                const T *kd = kb + j0 + d * kCol;
+                                for (int c = 0; c < cols; ++c)
+                                    s[c] += qi[d] * kd[c];
+                            }
+                        }
+                        T blockMax = -INFINITY;
+                        for (int c = 0; c < cols; ++c) {
+                            s[c] *= scale;
+                            if (mb)
+                                s[c] += mb[r * maskStride[rank - 2] +
+                                           (j0 + c) * maskStride[rank - 1]];
+                            blockMax = std::max(blockMax, s[c]);
+                        }
+                        // Rescale what was summed under the old max
+                        const T newMax = std::max(max[r], blockMax);
+                        if (newMax == -INFINITY)
+                            continue;
+                        const T rescale = std::exp(max[r] - newMax);
+                        T *out = &acc[r * dimV];
+                        sum[r] *= rescale;
+                        for (int d = 0; d < dimV; ++d)
+                            out[d] *= rescale;
+                        for (int c = 0; c < cols; ++c) {
+                            const T p = std::exp(s[c] - newMax);
+                            const T *vj = vb + size_t(j0 + c) * dimV;
+                            sum[r] += p;
+                            for (int d = 0; d < dimV; ++d)
+                                out[d] += p * vj[d];
+                        }
+                        max[r] = newMax;
+                    }
+                }
+                // Queries that every key is masked from give zeros
+                for (int r = 0; r < rows; ++r)
+                    for (int d = 0; d < dimV; ++d)
+                        yb[r * dimV + d] =
+                            sum[r] > 0 ? acc[r * dimV + d] / sum[r] : T(0);
+            }
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Attention, DataType::Float32,
+                BlockedAttention<float>, "Attention_CPU_float32");
+
+} // namespace infini
@@ -0,0 +1,49 @@
+#include "operators/batch_norm.h"
+#include "core/kernel.h"
+#include <cmath>
+
+namespace infini {
+
+template <typename T> class NaiveBatchNorm : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<BatchNormObj>(_op);
+        IT_ASSERT(!op->getTrainingMode());
+        auto input = op->getInputs(0), output = op->getOutput();
+        T *inptr = input->getRawDataPtr<T *>();
+        T *outptr = output->getRawDataPtr<T *>();
+        auto mean = op->getInputs(1)->getRawDataPtr<float *>();
+        auto var = op->getInputs(2)->getRawDataPtr<float *>();
+        auto scale = op->getInputs(3)->getRawDataPtr<float *>();
+        auto bias = op->getInputs(4)->getRawDataPtr<float *>();
+        auto dims = input->getDims();
+        const int n = dims[0], c = dims[1];
+        const int64_t hw = input->size() / n / c;
+        // y = x * a[c] + b[c]
+        vector<T> a(c), b(c);
+        for (int j = 0; j < c; ++j) {
+            a[j] = scale[j] / std::sqrt(var[j] + op->getEps());
+            b[j] = bias[j] - mean[j] * a[j];
+        }
+        // A blocked layout stores `block` channels side by side per pixel
+        const int block = input->getChannelBlock();
+        IT_ASSERT(output->getChannelBlock() == block);
+#pragma omp parallel for collapse(2)
+        for (int i = 0; i < n; ++i)
+            for (int jb = 0; jb < c / block; ++jb) {
+                const int64_t offset = ((int64_t)i * c + jb * block) * hw;
+                const T *src = inptr + offset;
+                T *dst = outptr + offset;
+                const T *pa = a.data() + jb * block;
+                const T *pb = b.data() + jb * block;
+                for (int64_t p = 0; p < hw; ++p)
+                    for (int l = 0; l < block; ++l)
+                        dst[p * block + l] = src[p * block + l] * pa[l] + pb[l];
+            }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::BatchNormalization, DataType::Float32,
+                NaiveBatchNorm<float>, "BatchNorm_CPU_float32");
+
+} // namespace infini
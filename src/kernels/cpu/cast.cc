@@ -0,0 +1,111 @@
+#include "core/kernel.h"
+#include "operators/unary.h"
+#include "utils/data_convert.h"
+
+namespace infini {
+
+// How elements of a type are stored and read as a value of arithmetic type.
+// Half types are read as float through data_convert.h, and Bool stores
+// whether a value is nonzero.
+template <typename T> struct Scalar {
+    using Storage = T;
+    static T load(T x) { return x; }
+    template <typename V> static T store(V v) { return static_cast<T>(v); }
+};
+template <> struct Scalar<bool> {
+    using Storage = uint8_t;
+    static uint8_t load(uint8_t x) { return x; }
+    template <typename V> static uint8_t store(V v) { return v != V(0); }
+};
+struct Half {
+    using Storage = uint16_t;
+    static float load(uint16_t x) { return fp16_to_float(x); }
+    template <typename V> static uint16_t store(V v) {
+        return float_to_fp16(float(v));
+    }
+};
+struct BHalf {
+    using Storage = uint16_t;
+    static float load(uint16_t x) { return bfp16_to_float(x); }
+    template <typename V> static uint16_t store(V v) {
+        return float_to_bfp16(float(v));
+    }
+};
+
+// Call f with the Scalar, Half or BHalf of `type`
+template <typename F> static void visitType(DataType type, F &&f) {
+    if (type == DataType::Float32)
+        f(Scalar<float>());
+    else if (type == DataType::Double)
+        f(Scalar<double>());
+    else if (type == DataType::Float16)
+        f(Half());
+    else if (type == DataType::BFloat16)
+        f(BHalf());
+    else if (type == DataType::Int8)
+        f(Scalar<int8_t>());
+    else if (type == DataType::Int16)
+        f(Scalar<int16_t>());
+    else if (type == DataType::Int32)
+        f(Scalar<int32_t>());
+    else if (type == DataType::Int64)
+        f(Scalar<int64_t>());
+    else if (type == DataType::UInt8)
+        f(Scalar<uint8_t>());
+    else if (type == DataType::UInt16)
+        f(Scalar<uint16_t>());
+    else if (type == DataType::UInt32)
+        f(Scalar<uint32_t>());
+    else if (type == DataType::UInt64)
+        f(Scalar<uint64_t>());
+    else if (type == DataType::Bool)
+        f(Scalar<bool>());
+    else
+        IT_TODO_HALT_MSG("Cast of " + type.toString() + " is not supported");
+}
+
+template <typename In, typename Out>
+static void castLoop(const typename In::Storage *x, typename Out::Storage *y,
+                     size_t n) {
+#pragma omp parallel for simd if (n > 16384)
+    for (size_t i = 0; i < n; ++i)
+        y[i] = Out::store(In::load(x[i]));
+}
+
+class NaiveCast : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<CastObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        const size_t n = input->size();
+        visitType(input->getDType(), [&](auto in) {
+            visitType(output->getDType(), [&](auto out) {
+                using In = decltype(in);
+                using Out = decltype(out);
+                castLoop<In, Out>(
+                    input->getRawDataPtr<typename In::Storage *>(),
+                    output->getRawDataPtr<typename Out::Storage *>(), n);
+            });
+        });
+    }
+};
+
+#define REGISTER_CAST(type, name)                                              \
+    REGISTER_KERNEL(Device::CPU, OpType::Cast, DataType::type, NaiveCast,      \
+                    "CastNaive_CPU_" name);
+
+REGISTER_CAST(Float32, "float32")
+REGISTER_CAST(Float16, "float16")
+REGISTER_CAST(BFloat16, "bfloat16")
+REGISTER_CAST(Double, "float64")
+REGISTER_CAST(Int8, "int8")
+REGISTER_CAST(Int16, "int16")
+REGISTER_CAST(Int32, "int32")
+REGISTER_CAST(Int64, "int64")
+REGISTER_CAST(UInt8, "uint8")
+REGISTER_CAST(UInt16, "uint16")
+REGISTER_CAST(UInt32, "uint32")
+REGISTER_CAST(UInt64, "uint64")
+REGISTER_CAST(Bool, "bool")
+
+} // namespace infini
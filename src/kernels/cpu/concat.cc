@@ -1,51 +1,56 @@
 #include "operators/concat.h"
 #include "core/kernel.h"
+#include "cpu/cpu_copy.h"
 
 namespace infini {
 
-template <typename T> class NaiveConcat : public CpuKernelWithoutConfig {
+// Each input is a run of contiguous bytes in every outer block of the output,
+// copied as a whole. Elements are moved as bytes, so one kernel serves every
+// type.
+class NaiveConcat : public CpuKernelWithoutConfig {
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<ConcatObj>(_op);
-        auto inputs = op->getInputs(), outputs = op->getOutputs();
-        auto dim = op->getDim();
-        auto output = outputs[0];
-        std::vector<Shape> iDims;
-        for (auto input : inputs)
-            iDims.emplace_back(input->getDims());
+        auto output = op->getOutput();
         const auto &outDim = output->getDims();
-        size_t blockOffsetInner = 1;
-        for (size_t i = outDim.size() - 1; i > (size_t)dim; --i)
-            blockOffsetInner *= outDim[i];
-        size_t blockOffset = outDim[dim] * blockOffsetInner;
-        for (size_t i = 0; i < inputs.size(); ++i) {
-            auto input = inputs[i];
-            auto dimOffset = 0;
-            auto iDim = iDims[i];
-            for (size_t j = 0; j < i; ++j)
-                dimOffset += iDims[j][dim];
-            size_t localBlockOffset = 1;
-            for (size_t i = iDim.size() - 1;
-                 i >= (size_t)dim && i != (size_t)-1; --i)
-                localBlockOffset *= iDim[i];
-            auto innerOffset = blockOffsetInner * dimOffset;
-            auto inSize = input->size();
-            auto inPtr = input->getRawDataPtr<T *>(),
-                 outPtr = output->getRawDataPtr<T *>();
-#pragma omp parallel for
-            for (size_t iOffset = 0; iOffset < inSize; ++iOffset) {
-                auto oOffset = iOffset % localBlockOffset + innerOffset +
-                               iOffset / localBlockOffset * blockOffset;
-                // output->setData(oOffset, input->getData(iOffset));
-                outPtr[oOffset] = inPtr[iOffset];
-            }
+        const int dim = op->getDim();
+        size_t outer = 1, inner = output->getDType().getSize();
+        for (int i = 0; i < dim; ++i)
+            outer *= outDim[i];
+        for (size_t i = dim + 1; i < outDim.size(); ++i)
+            inner *= outDim[i];
+        const size_t blockBytes = outDim[dim] * inner;
+        auto outPtr = output->getRawDataPtr<uint8_t *>();
+        size_t offset = 0;
+        for (auto &input : op->getInputs()) {
+            const size_t run = input->getDims()[dim] * inner;
+            auto inPtr = input->getRawDataPtr<uint8_t *>();
+            // Producers planned onto their slice of the output have written
+            // it already, see GraphObj::dataMalloc
+            if (outer > 1 || inPtr != outPtr + offset)
+                copyBlocks(inPtr, run, outPtr + offset, blockBytes, run,
+                           outer);
+            offset += run;
         }
     }
 };
 
-REGISTER_KERNEL(Device::CPU, OpType::Concat, DataType::UInt32,
-                NaiveConcat<uint32_t>, "ConcatNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Concat, DataType::Float32,
-                NaiveConcat<float>, "ConcatNaive_CPU_float32");
+#define REGISTER_CONCAT(type, name)                                            \
+    REGISTER_KERNEL(Device::CPU, OpType::Concat, DataType::type, NaiveConcat,  \
+                    "ConcatNaive_CPU_" name);
+
+REGISTER_CONCAT(Float32, "float32")
+REGISTER_CONCAT(Float16, "float16")
+REGISTER_CONCAT(BFloat16, "bfloat16")
+REGISTER_CONCAT(Double, "float64")
+REGISTER_CONCAT(Int8, "int8")
+REGISTER_CONCAT(Int16, "int16")
+REGISTER_CONCAT(Int32, "int32")
+REGISTER_CONCAT(Int64, "int64")
+REGISTER_CONCAT(UInt8, "uint8")
+REGISTER_CONCAT(UInt16, "uint16")
+REGISTER_CONCAT(UInt32, "uint32")
+REGISTER_CONCAT(UInt64, "uint64")
+REGISTER_CONCAT(Bool, "bool")
 
 } // namespace infini
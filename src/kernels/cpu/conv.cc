@@ -1,60 +1,604 @@
 #include "operators/conv.h"
 #include "core/kernel.h"
+#include "cpu/cpu_gemm.h"
+#include <algorithm>
+#include <limits>
 
 namespace infini {
 
-template <typename T> class NaiveConv : public CpuKernelWithoutConfig {
-    void compute(const Operator &_op,
-                 const RuntimeObj *context) const override {
-        auto op = as<ConvObj>(_op);
-        T *iptr = op->getInputs(0)->getRawDataPtr<T *>();
-        T *wptr = op->getInputs(1)->getRawDataPtr<T *>();
-        T *optr = op->getOutput()->getRawDataPtr<T *>();
-        //  Clang will give an error of " reference to local binding 'sh'
-        //  declared in enclosing function" if we write like this:
-        //        auto [n, c, h, w, f, r, s] = op->getNCHWFRS();
-        int n, c, h, w, f, r, s;
+enum class ConvCpuAlgo {
+    Im2colGemm,   // Unfold each image into a matrix, then one large GEMM
+    ImplicitGemm, // Unfold and multiply one tile of output pixels at a time
+    WinogradF2x2, // Winograd F(2x2, 3x3)
+    WinogradF4x4, // Winograd F(4x4, 3x3)
+    Depthwise,    // Per-channel sliding window
+    Blocked,      // Channel-blocked input and output layouts
+};
+
+struct ConvCpuPerfRecordObj : public PerfRecordObj {
+    ConvCpuAlgo algo = ConvCpuAlgo::Im2colGemm;
+    void to_json(json &j) override {
+        j["type"] = 3;
+        j["data"] = std::make_tuple(enum_to_underlying(algo), time);
+    }
+    static PerfRecord from_json(const json &j) {
+        ConvCpuPerfRecordObj tmp;
+        auto [Algo, Time] = j["data"].get<tuple<int, double>>();
+        tmp.algo = (ConvCpuAlgo)Algo;
+        tmp.time = Time;
+        return make_ref<ConvCpuPerfRecordObj>(tmp);
+    }
+};
+
+using ConvCpuPerfRecord = Ref<ConvCpuPerfRecordObj>;
+
+namespace {
+
+template <typename T> struct ConvArgs {
+    const T *in, *weight, *bias;
+    T *out;
+    int n, c, h, w, f, r, s;
+    int ph, pw, sh, sw, dh, dw;
+    int g, cpg, fpg, oh, ow;
+    int block; // Channel block of the input and output layouts
+    ActType act;
+
+    explicit ConvArgs(const ConvObj *op) {
+        in = op->getInputs(0)->getRawDataPtr<T *>();
+        weight = op->getInputs(1)->getRawDataPtr<T *>();
+        auto biasTensor = op->getBias();
+        bias = biasTensor ? biasTensor->getRawDataPtr<T *>() : nullptr;
+        out = op->getOutput()->getRawDataPtr<T *>();
         std::tie(n, c, h, w, f, r, s) = op->getNCHWFRS();
-        int ph, pw, sh, sw, dh, dw;
         std::tie(ph, pw, sh, sw, dh, dw) = op->getPadStrideDilation();
-        int cpg = op->getChannelPerGroup();
-        int g = op->getNumGroups();
+        cpg = op->getChannelPerGroup();
+        g = op->getNumGroups();
         IT_ASSERT(f % g == 0, "Illegal number of channel");
+        fpg = f / g;
         auto outDim = op->getOutput()->getDims();
-        int oh = outDim[2], ow = outDim[3];
-        for (int nn = 0; nn < n; nn++) {
+        oh = outDim[2], ow = outDim[3];
+        block = op->getInputs(0)->getChannelBlock();
+        IT_ASSERT(op->getOutput()->getChannelBlock() == block,
+                  "Conv input and output must share the channel block.");
+        act = op->getAct();
+    }
+
+    bool isDepthwise() const { return cpg == 1 && fpg == 1; }
+    bool isWinograd() const {
+        return std::is_same_v<T, float> && g == 1 && r == 3 && s == 3 &&
+               sh == 1 && sw == 1 && dh == 1 && dw == 1;
+    }
+    bool isPointwise() const {
+        return r == 1 && s == 1 && ph == 0 && pw == 0 && sh == 1 && sw == 1;
+    }
+    // Rows of the unfolded matrix of one group
+    int64_t unfoldedRows() const { return (int64_t)cpg * r * s; }
+};
+
+// Output positions [lo, hi) of a sliding window whose input position
+// x * stride + offset lies inside [0, size).
+pair<int, int> validRange(int outSize, int stride, int offset, int size) {
+    int lo = offset >= 0 ? 0 : (-offset + stride - 1) / stride;
+    int hi = size - offset <= 0 ? 0 : (size - 1 - offset) / stride + 1;
+    hi = std::min(hi, outSize);
+    return {std::min(lo, hi), hi};
+}
+
+// Unfold the receptive fields of output pixels [p0, p0 + np) of image `nn`
+// and group `gi` into a (cpg * r * s) x np row-major matrix. Padding is
+// materialized as zeros.
+template <typename T>
+void im2col(const ConvArgs<T> &a, int nn, int gi, int64_t p0, int64_t np,
+            T *col) {
+    const int64_t rows = a.unfoldedRows();
+#pragma omp parallel for
+    for (int64_t row = 0; row < rows; ++row) {
+        const int cc = row / (a.r * a.s), rr = row / a.s % a.r,
+                  ss = row % a.s;
+        const T *plane =
+            a.in + ((int64_t)nn * a.c + gi * a.cpg + cc) * a.h * a.w;
+        const int offW = ss * a.dw - a.pw;
+        const auto [xlo, xhi] = validRange(a.ow, a.sw, offW, a.w);
+        T *dst = col + row * np;
+        int oy = p0 / a.ow, ox = p0 % a.ow;
+        for (int64_t p = 0; p < np; ox = 0, ++oy) {
+            const int len = std::min<int64_t>(a.ow - ox, np - p);
+            const int iy = oy * a.sh + rr * a.dh - a.ph;
+            T *seg = dst + p - ox; // seg[x] is output column x of this row
+            p += len;
+            if (iy < 0 || iy >= a.h) {
+                std::fill_n(seg + ox, len, T(0));
+                continue;
+            }
+            const T *src = plane + (int64_t)iy * a.w + offW;
+            const int end = ox + len;
+            const int lo = std::clamp(xlo, ox, end),
+                      hi = std::clamp(xhi, lo, end);
+            std::fill(seg + ox, seg + lo, T(0));
+            if (a.sw == 1)
+                std::copy(src + lo, src + hi, seg + lo);
+            else
+                for (int x = lo; x < hi; ++x)
+                    seg[x] = src[(int64_t)x * a.sw];
+            std::fill(seg + hi, seg + end, T(0));
+        }
+    }
+}
+
+template <typename T>
+GemmEpilogue<T> groupEpilogue(const ConvArgs<T> &a, int gi) {
+    GemmEpilogue<T> ep;
+    ep.bias = a.bias ? a.bias + gi * a.fpg : nullptr;
+    ep.biasRs = 1; // One bias per output channel, i.e. per row of C
+    ep.act = a.act;
+    return ep;
+}
+
+template <typename T> void convIm2colGemm(const ConvArgs<T> &a) {
+    const int64_t k = a.unfoldedRows(), pixels = (int64_t)a.oh * a.ow;
+    // A pointwise convolution needs no unfolding: each image already is the
+    // k x pixels matrix.
+    vector<T> col(a.isPointwise() ? 0 : k * pixels);
+    for (int nn = 0; nn < a.n; ++nn)
+        for (int gi = 0; gi < a.g; ++gi) {
+            const T *b = a.in + ((int64_t)nn * a.c + gi * a.cpg) * a.h * a.w;
+            if (!a.isPointwise()) {
+                im2col(a, nn, gi, 0, pixels, col.data());
+                b = col.data();
+            }
+            cpuGemm<T>(false, false, a.fpg, pixels, k,
+                       a.weight + gi * a.fpg * k, b,
+                       a.out + ((int64_t)nn * a.f + gi * a.fpg) * pixels,
+                       groupEpilogue(a, gi));
+        }
+}
+
+template <typename T> void convImplicitGemm(const ConvArgs<T> &a) {
+    const int64_t k = a.unfoldedRows(), pixels = (int64_t)a.oh * a.ow;
+    // Size the pixel tiles so that their unfolded panel stays in L2
+    const int64_t tile =
+        std::clamp<int64_t>(128 * 1024 / k / 16 * 16, 64, 512);
+    const int64_t pixelTiles = (pixels + tile - 1) / tile;
+    const int64_t tiles = (int64_t)a.n * a.g * pixelTiles;
+#pragma omp parallel
+    {
+        vector<T> col(k * tile), cTmp((int64_t)a.fpg * tile);
+#pragma omp for schedule(dynamic)
+        for (int64_t t = 0; t < tiles; ++t) {
+            const int nn = t / (a.g * pixelTiles), gi = t / pixelTiles % a.g;
+            const int64_t p0 = t % pixelTiles * tile,
+                          np = std::min(tile, pixels - p0);
+            im2col(a, nn, gi, p0, np, col.data());
+            cpuGemm<T>(false, false, a.fpg, np, k, a.weight + gi * a.fpg * k,
+                       col.data(), cTmp.data(), groupEpilogue(a, gi));
+            T *dst = a.out + ((int64_t)nn * a.f + gi * a.fpg) * pixels + p0;
+            for (int i = 0; i < a.fpg; ++i)
+                std::copy_n(cTmp.data() + i * np, np, dst + i * pixels);
+        }
+    }
+}
+
+template <typename T> void convDepthwise(const ConvArgs<T> &a) {
+#pragma omp parallel for
+    for (int64_t nc = 0; nc < (int64_t)a.n * a.c; ++nc) {
+        const int cc = nc % a.c;
+        const T *plane = a.in + nc * a.h * a.w, *wt = a.weight + cc * a.r * a.s;
+        for (int oy = 0; oy < a.oh; ++oy) {
+            T *row = a.out + (nc * a.oh + oy) * a.ow;
+            std::fill_n(row, a.ow, a.bias ? a.bias[cc] : T(0));
+            for (int rr = 0; rr < a.r; ++rr) {
+                const int iy = oy * a.sh + rr * a.dh - a.ph;
+                if (iy < 0 || iy >= a.h)
+                    continue;
+                for (int ss = 0; ss < a.s; ++ss) {
+                    const int offW = ss * a.dw - a.pw;
+                    const auto [lo, hi] = validRange(a.ow, a.sw, offW, a.w);
+                    const T *src = plane + (int64_t)iy * a.w + offW;
+                    const T wv = wt[rr * a.s + ss];
+                    if (a.sw == 1) {
+#pragma omp simd
+                        for (int ox = lo; ox < hi; ++ox)
+                            row[ox] += wv * src[ox];
+                    } else {
+                        for (int ox = lo; ox < hi; ++ox)
+                            row[ox] += wv * src[(int64_t)ox * a.sw];
+                    }
+                }
+            }
+            for (int ox = 0; ox < a.ow; ++ox)
+                row[ox] = cpuActivation(row[ox], a.act);
+        }
+    }
+}
+
+// Dense convolution of nChw<B>c input into nChw<B>c output, as an implicit
+// GEMM of output pixels x filters. Ordering the reduction as (c / B, r, s, B)
+// turns unfolding into copies of whole B-channel pixels, and every row of the
+// product holds the B-channel output pixels of all filter blocks.
+template <typename T> void convBlockedGemm(const ConvArgs<T> &a) {
+    IT_ASSERT(a.g == 1, "Unsupported groups in blocked conv.");
+    const int B = a.block, cb = a.c / B, fb = a.f / B;
+    const int64_t k = a.unfoldedRows(), pixels = (int64_t)a.oh * a.ow;
+    // Filters as a k x f matrix
+    vector<T> wt(k * a.f);
+#pragma omp parallel for
+    for (int ff = 0; ff < a.f; ++ff)
+        for (int cc = 0; cc < a.c; ++cc)
+            for (int rs = 0; rs < a.r * a.s; ++rs)
+                wt[(((int64_t)cc / B * a.r * a.s + rs) * B + cc % B) * a.f +
+                   ff] = a.weight[((int64_t)ff * a.c + cc) * a.r * a.s + rs];
+    GemmEpilogue<T> ep;
+    ep.bias = a.bias;
+    ep.biasCs = 1; // One bias per output channel, i.e. per column of C
+    ep.act = a.act;
+    const int64_t tile =
+        std::clamp<int64_t>(128 * 1024 / k / 16 * 16, 64, 512);
+    const int64_t pixelTiles = (pixels + tile - 1) / tile;
+#pragma omp parallel
+    {
+        vector<T> col(tile * k), cTmp(tile * a.f);
+#pragma omp for schedule(dynamic)
+        for (int64_t t = 0; t < a.n * pixelTiles; ++t) {
+            const int nn = t / pixelTiles;
+            const int64_t p0 = t % pixelTiles * tile,
+                          np = std::min(tile, pixels - p0);
+            for (int64_t i = 0; i < np; ++i) {
+                const int oy = (p0 + i) / a.ow, ox = (p0 + i) % a.ow;
+                T *dst = col.data() + i * k;
+                for (int ci = 0; ci < cb; ++ci)
+                    for (int rr = 0; rr < a.r; ++rr) {
+                        const int iy = oy * a.sh + rr * a.dh - a.ph;
+                        for (int ss = 0; ss < a.s; ++ss, dst += B) {
+                            const int ix = ox * a.sw + ss * a.dw - a.pw;
+                            if (iy < 0 || iy >= a.h || ix < 0 || ix >= a.w)
+                                std::fill_n(dst, B, T(0));
+                            else
+                                std::copy_n(
+                                    a.in + (((int64_t)nn * cb + ci) * a.h +
+                                                iy) * a.w * B +
+                                        (int64_t)ix * B,
+                                    B, dst);
+                        }
+                    }
+            }
+            cpuGemm<T>(false, false, np, a.f, k, col.data(), wt.data(),
+                       cTmp.data(), ep);
+            for (int fo = 0; fo < fb; ++fo) {
+                T *dst = a.out + (((int64_t)nn * fb + fo) * pixels + p0) * B;
+                for (int64_t i = 0; i < np; ++i)
+                    std::copy_n(cTmp.data() + i * a.f + fo * B, B,
+                                dst + i * B);
+            }
+        }
+    }
+}
+
+// Depthwise convolution of nChw<B>c input into nChw<B>c output. Each output
+// pixel accumulates B channels at once.
+template <typename T, int B> void convBlockedDepthwise(const ConvArgs<T> &a) {
+    const int rs = a.r * a.s;
+    // Weights as [c / B][r][s][B]
+    vector<T> wt((int64_t)a.c * rs);
+    for (int cc = 0; cc < a.c; ++cc)
+        for (int k = 0; k < rs; ++k)
+            wt[((int64_t)cc / B * rs + k) * B + cc % B] =
+                a.weight[(int64_t)cc * rs + k];
+#pragma omp parallel for collapse(2)
+    for (int nn = 0; nn < a.n; ++nn)
+        for (int cb = 0; cb < a.c / B; ++cb) {
+            const int64_t plane = (int64_t)nn * a.c / B + cb;
+            const T *src = a.in + plane * a.h * a.w * B;
+            T *dst = a.out + plane * a.oh * a.ow * B;
+            const T *wc = wt.data() + (int64_t)cb * rs * B;
+            for (int oy = 0; oy < a.oh; ++oy)
+                for (int ox = 0; ox < a.ow; ++ox) {
+                    T acc[B];
+                    for (int l = 0; l < B; ++l)
+                        acc[l] = a.bias ? a.bias[cb * B + l] : T(0);
+                    for (int rr = 0; rr < a.r; ++rr) {
+                        const int iy = oy * a.sh + rr * a.dh - a.ph;
+                        if (iy < 0 || iy >= a.h)
+                            continue;
+                        for (int ss = 0; ss < a.s; ++ss) {
+                            const int ix = ox * a.sw + ss * a.dw - a.pw;
+                            if (ix < 0 || ix >= a.w)
+                                continue;
+                            const T *px = src + ((int64_t)iy * a.w + ix) * B;
+                            const T *wk = wc + (rr * a.s + ss) * B;
+#pragma omp simd
+                            for (int l = 0; l < B; ++l)
+                                acc[l] += px[l] * wk[l];
+                        }
+                    }
+                    T *o = dst + ((int64_t)oy * a.ow + ox) * B;
+                    for (int l = 0; l < B; ++l)
+                        o[l] = cpuActivation(acc[l], a.act);
+                }
+        }
+}
+
+// Transforms of Winograd F(M x M, 3 x 3), see Lavin and Gray, "Fast
+// Algorithms for Convolutional Neural Networks". The filter transform G is a
+// plain matrix since it runs once per filter. The input transform B^T and the
+// output transform A^T are written out to skip their zero coefficients; each
+// call transforms L independent vectors, where element k of vector l is
+// x[k * xs + l].
+template <int M> struct WinogradF3;
+
+template <> struct WinogradF3<2> {
+    static constexpr float G[4][3] = {
+        {1, 0, 0}, {.5f, .5f, .5f}, {.5f, -.5f, .5f}, {0, 0, 1}};
+
+    template <int L>
+    static void inputTransform(const float *x, int xs, float *o, int os) {
+        for (int l = 0; l < L; ++l) {
+            const float x0 = x[l], x1 = x[xs + l], x2 = x[2 * xs + l],
+                        x3 = x[3 * xs + l];
+            o[l] = x0 - x2;
+            o[os + l] = x1 + x2;
+            o[2 * os + l] = x2 - x1;
+            o[3 * os + l] = x1 - x3;
+        }
+    }
+
+    template <int L>
+    static void outputTransform(const float *x, int xs, float *o, int os) {
+        for (int l = 0; l < L; ++l) {
+            const float x1 = x[xs + l], x2 = x[2 * xs + l];
+            o[l] = x[l] + x1 + x2;
+            o[os + l] = x1 - x2 - x[3 * xs + l];
+        }
+    }
+};
+
+template <> struct WinogradF3<4> {
+    static constexpr float G[6][3] = {{1.f / 4, 0, 0},
+                                      {-1.f / 6, -1.f / 6, -1.f / 6},
+                                      {-1.f / 6, 1.f / 6, -1.f / 6},
+                                      {1.f / 24, 1.f / 12, 1.f / 6},
+                                      {1.f / 24, -1.f / 12, 1.f / 6},
+                                      {0, 0, 1}};
+
+    template <int L>
+    static void inputTransform(const float *x, int xs, float *o, int os) {
+        for (int l = 0; l < L; ++l) {
+            const float x0 = x[l], x1 = x[xs + l], x2 = x[2 * xs + l],
+                        x3 = x[3 * xs + l], x4 = x[4 * xs + l],
+                        x5 = x[5 * xs + l];
+            o[l] = 4 * x0 - 5 * x2 + x4;
+            o[os + l] = x3 + x4 - 4 * (x1 + x2);
+            o[2 * os + l] = x4 - x3 + 4 * (x1 - x2);
+            o[3 * os + l] = x4 - x2 + 2 * (x3 - x1);
+            o[4 * os + l] = x4 - x2 + 2 * (x1 - x3);
+            o[5 * os + l] = 4 * x1 - 5 * x3 + x5;
+        }
+    }
+
+    template <int L>
+    static void outputTransform(const float *x, int xs, float *o, int os) {
+        for (int l = 0; l < L; ++l) {
+            const float x1 = x[xs + l], x2 = x[2 * xs + l], x3 = x[3 * xs + l],
+                        x4 = x[4 * xs + l];
+            const float s12 = x1 + x2, d12 = x1 - x2, s34 = x3 + x4,
+                        d34 = x3 - x4;
+            o[l] = x[l] + s12 + s34;
+            o[os + l] = d12 + 2 * d34;
+            o[2 * os + l] = s12 + 4 * s34;
+            o[3 * os + l] = d12 + 8 * d34 + x[5 * xs + l];
+        }
+    }
+};
+
+// Winograd convolution in three passes: transform the filters and the input
+// tiles, multiply the transformed values with one GEMM per point of the
+// (M + 2) x (M + 2) tile, then transform the products back to the output.
+// Input and output tiles are transformed `Lanes` horizontally adjacent tiles
+// at a time, so the transforms vectorize across tiles and every point of the
+// transformed tile is stored contiguously.
+template <int M> void convWinograd(const ConvArgs<float> &a) {
+    using W = WinogradF3<M>;
+    constexpr int A = M + 2, Lanes = 8;
+    const int c = a.c, f = a.f, tilesH = (a.oh + M - 1) / M,
+              tilesW = (a.ow + M - 1) / M;
+    const int64_t tiles = (int64_t)a.n * tilesH * tilesW;
+    // U[xi][f][c], V[xi][c][tiles] and P[xi][f][tiles] for each point xi
+    vector<float> U((int64_t)A * A * f * c), V(A * A * c * tiles),
+        P(A * A * f * tiles);
+
+#pragma omp parallel for
+    for (int64_t fc = 0; fc < (int64_t)f * c; ++fc) {
+        const float *wt = a.weight + fc * 9;
+        float tmp[A][3];
+        for (int i = 0; i < A; ++i)
+            for (int j = 0; j < 3; ++j)
+                tmp[i][j] = W::G[i][0] * wt[j] + W::G[i][1] * wt[3 + j] +
+                            W::G[i][2] * wt[6 + j];
+        for (int i = 0; i < A; ++i)
+            for (int j = 0; j < A; ++j)
+                U[(i * A + j) * f * c + fc] = tmp[i][0] * W::G[j][0] +
+                                              tmp[i][1] * W::G[j][1] +
+                                              tmp[i][2] * W::G[j][2];
+    }
+
+#pragma omp parallel for
+    for (int64_t plane = 0; plane < (int64_t)a.n * c; ++plane) {
+        const int nn = plane / c, cc = plane % c;
+        const float *src = a.in + plane * a.h * a.w;
+        for (int ty = 0; ty < tilesH; ++ty)
+            for (int tx0 = 0; tx0 < tilesW; tx0 += Lanes) {
+                const int lanes = std::min(Lanes, tilesW - tx0),
+                          y0 = ty * M - a.ph, x0 = tx0 * M - a.pw;
+                const bool interior = lanes == Lanes && y0 >= 0 &&
+                                      y0 + A <= a.h && x0 >= 0 &&
+                                      x0 + (Lanes - 1) * M + A <= a.w;
+                float d[A][A][Lanes], tmp[A][A][Lanes], v[A][A][Lanes];
+                for (int i = 0; i < A; ++i)
+                    for (int j = 0; j < A; ++j)
+                        for (int l = 0; l < Lanes; ++l) {
+                            const int y = y0 + i, x = x0 + l * M + j;
+                            d[i][j][l] = interior || (l < lanes && y >= 0 &&
+                                                      y < a.h && x >= 0 &&
+                                                      x < a.w)
+                                             ? src[(int64_t)y * a.w + x]
+                                             : 0.f;
+                        }
+                // v = B^T d B: transform the columns, then the rows
+                for (int j = 0; j < A; ++j)
+                    W::template inputTransform<Lanes>(
+                        &d[0][j][0], A * Lanes, &tmp[0][j][0], A * Lanes);
+                for (int i = 0; i < A; ++i)
+                    W::template inputTransform<Lanes>(&tmp[i][0][0], Lanes,
+                                                      &v[i][0][0], Lanes);
+                const int64_t t0 = ((int64_t)nn * tilesH + ty) * tilesW + tx0;
+                for (int i = 0; i < A; ++i)
+                    for (int j = 0; j < A; ++j)
+                        std::copy_n(v[i][j], lanes,
+                                    &V[((i * A + j) * c + cc) * tiles + t0]);
+            }
+    }
+
+    vector<int64_t> offsetU(A * A), offsetV(A * A);
+    for (int xi = 0; xi < A * A; ++xi) {
+        offsetU[xi] = (int64_t)xi * f * c;
+        offsetV[xi] = xi * c * tiles;
+    }
+    cpuGemmBatched<float>(false, false, A * A, f, tiles, c, U.data(),
+                          offsetU.data(), V.data(), offsetV.data(), P.data());
+
 #pragma omp parallel for
-            for (int ff = 0; ff < f; ff++) {
-                for (int hh = 0; hh < oh; hh++)
-                    for (int ww = 0; ww < ow; ww++) {
-                        int gidx = ff / (f / g);
-                        T val = 0;
-                        for (int cc = 0; cc < cpg; cc++)
-                            for (int rr = 0; rr < r; rr++)
-                                for (int ss = 0; ss < s; ss++) {
-                                    // clang-format off
-                                int posH = hh * sh + rr * dh - ph;
-                                int posW = ww * sw + ss * dw - pw;
-                                if (posH < 0 || posH >= h || posW < 0 || posW >= w)
-                                    continue;
-                                auto iOffset = posW + w * (posH + h * ((cc + gidx * cpg) + c * nn)),
-                                    wOffset = ss + s * (rr + r * (cc + cpg * ff));
-                                auto inputVal = iptr[iOffset], weightVal = wptr[wOffset];
-                                val += weightVal * inputVal;
-                                    // clang-format on
-                                }
-                        // TODO: check correctness, oh & ow or h & w?
-                        auto oOffset = ww + ow * (hh + oh * (ff + f * nn));
-                        optr[oOffset] = val;
+    for (int64_t plane = 0; plane < (int64_t)a.n * f; ++plane) {
+        const int nn = plane / f, ff = plane % f;
+        float *dst = a.out + plane * a.oh * a.ow;
+        const float bias = a.bias ? a.bias[ff] : 0.f;
+        for (int ty = 0; ty < tilesH; ++ty)
+            for (int tx0 = 0; tx0 < tilesW; tx0 += Lanes) {
+                const int lanes = std::min(Lanes, tilesW - tx0);
+                const int64_t t0 = ((int64_t)nn * tilesH + ty) * tilesW + tx0;
+                float m[A][A][Lanes], tmp[M][A][Lanes], y[M][M][Lanes];
+                for (int i = 0; i < A; ++i)
+                    for (int j = 0; j < A; ++j) {
+                        const float *src =
+                            &P[((i * A + j) * f + ff) * tiles + t0];
+                        for (int l = 0; l < Lanes; ++l)
+                            m[i][j][l] = l < lanes ? src[l] : 0.f;
                     }
+                // y = A^T m A: transform the columns, then the rows
+                for (int j = 0; j < A; ++j)
+                    W::template outputTransform<Lanes>(
+                        &m[0][j][0], A * Lanes, &tmp[0][j][0], A * Lanes);
+                for (int i = 0; i < M; ++i)
+                    W::template outputTransform<Lanes>(&tmp[i][0][0], Lanes,
+                                                       &y[i][0][0], Lanes);
+                for (int i = 0; i < M && ty * M + i < a.oh; ++i) {
+                    float *row = dst + (int64_t)(ty * M + i) * a.ow;
+                    for (int l = 0; l < lanes; ++l)
+                        for (int j = 0; j < M && (tx0 + l) * M + j < a.ow; ++j)
+                            row[(tx0 + l) * M + j] =
+                                cpuActivation(y[i][j][l] + bias, a.act);
+                }
+            }
+    }
+}
+
+} // namespace
+
+template <typename T> class NativeConv : public Kernel {
+    // Algorithms that can run `op`, most preferred first
+    static vector<ConvCpuAlgo> candidates(const ConvArgs<T> &a) {
+        vector<ConvCpuAlgo> ret;
+        // The other algorithms expect plain layouts
+        if (a.block != 1)
+            return {ConvCpuAlgo::Blocked};
+        if (a.isDepthwise())
+            ret.emplace_back(ConvCpuAlgo::Depthwise);
+        // The transforms dominate when there are few channels
+        if (a.isWinograd() && a.c >= 16 && a.f >= 16)
+            ret.emplace_back(ConvCpuAlgo::WinogradF2x2);
+        // Materializing a huge unfolded image hurts more than tiling does
+        if (a.unfoldedRows() * a.oh * a.ow * sizeof(T) > (64 << 20)) {
+            ret.emplace_back(ConvCpuAlgo::ImplicitGemm);
+            ret.emplace_back(ConvCpuAlgo::Im2colGemm);
+        } else {
+            ret.emplace_back(ConvCpuAlgo::Im2colGemm);
+            ret.emplace_back(ConvCpuAlgo::ImplicitGemm);
+        }
+        if (a.isWinograd()) {
+            if (a.c < 16 || a.f < 16)
+                ret.emplace_back(ConvCpuAlgo::WinogradF2x2);
+            ret.emplace_back(ConvCpuAlgo::WinogradF4x4);
+        }
+        return ret;
+    }
+
+    static void run(const ConvArgs<T> &a, ConvCpuAlgo algo) {
+        IT_ASSERT((a.block != 1) == (algo == ConvCpuAlgo::Blocked),
+                  "Conv algorithm does not match the layout.");
+        switch (algo) {
+        case ConvCpuAlgo::Im2colGemm:
+            return convIm2colGemm(a);
+        case ConvCpuAlgo::ImplicitGemm:
+            return convImplicitGemm(a);
+        case ConvCpuAlgo::Depthwise:
+            IT_ASSERT(a.isDepthwise());
+            return convDepthwise(a);
+        case ConvCpuAlgo::WinogradF2x2:
+        case ConvCpuAlgo::WinogradF4x4:
+            IT_ASSERT(a.isWinograd());
+            if constexpr (std::is_same_v<T, float>) {
+                if (algo == ConvCpuAlgo::WinogradF2x2)
+                    return convWinograd<2>(a);
+                return convWinograd<4>(a);
             }
+            break;
+        case ConvCpuAlgo::Blocked:
+            if (!a.isDepthwise())
+                return convBlockedGemm(a);
+            if (a.block == 8)
+                return convBlockedDepthwise<T, 8>(a);
+            if (a.block == 16)
+                return convBlockedDepthwise<T, 16>(a);
+            break;
+        }
+        IT_TODO_HALT();
+    }
+
+    void compute(const Operator &_op, const PerfRecord &_record,
+                 const RuntimeObj *context) const override {
+        auto op = as<ConvObj>(_op);
+        auto record = as<ConvCpuPerfRecordObj>(_record);
+        run(ConvArgs<T>(op.get()), record->algo);
+    }
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<ConvObj>(_op);
+        ConvArgs<T> args(op.get());
+        run(args, candidates(args).front());
+    }
+
+    PerfRecord tune(const Operator &_op,
+                    const RuntimeObj *context) const override {
+        auto op = as<ConvObj>(_op);
+        ConvArgs<T> args(op.get());
+        ConvCpuPerfRecordObj ret;
+        ret.time = std::numeric_limits<double>::max();
+        // Try every algorithm applicable to this shape
+        for (auto algo : candidates(args)) {
+            ConvCpuPerfRecordObj record;
+            record.algo = algo;
+            record.time = timeit([&]() { run(args, algo); }, []() {}, 1, 3);
+            if (ret.time > record.time)
+                ret = record;
         }
+        return make_ref<ConvCpuPerfRecordObj>(ret);
     }
 };
 
 REGISTER_KERNEL(Device::CPU, OpType::Conv, DataType::UInt32,
-                NaiveConv<uint32_t>, "ConvNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Conv, DataType::Float32, NaiveConv<float>,
-                "ConvNaive_CPU_float32");
+                NativeConv<uint32_t>, "Conv_CPU_uint32");
+REGISTER_KERNEL(Device::CPU, OpType::Conv, DataType::Float32,
+                NativeConv<float>, "Conv_CPU_float32");
+
+REGISTER_CONSTRUCTOR(3, ConvCpuPerfRecordObj::from_json);
 
 } // namespace infini
@@ -0,0 +1,52 @@
+#include "cpu/cpu_math.h"
+
+namespace infini {
+
+// Each function below is cloned per instruction set, and calls through an
+// ifunc resolved for the running CPU. The approximations inline into every
+// clone and vectorize at its width.
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__)
+#define CPU_MATH_DISPATCH                                                      \
+    __attribute__((target_clones("arch=skylake-avx512", "arch=haswell",      \
+                                 "default")))
+#else
+#define CPU_MATH_DISPATCH
+#endif
+
+CPU_MATH_DISPATCH void vecExp(const float *x, float *y, size_t n) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+        y[i] = x[i] > 88.7228394f ? INFINITY : expApprox(x[i]);
+}
+
+CPU_MATH_DISPATCH void vecLog(const float *x, float *y, size_t n) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+        y[i] = logApprox(x[i]);
+}
+
+CPU_MATH_DISPATCH void vecTanh(const float *x, float *y, size_t n) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+        y[i] = tanhApprox(x[i]);
+}
+
+CPU_MATH_DISPATCH void vecSigmoid(const float *x, float *y, size_t n) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+        y[i] = sigmoidApprox(x[i]);
+}
+
+CPU_MATH_DISPATCH void vecErf(const float *x, float *y, size_t n) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+        y[i] = erfApprox(x[i]);
+}
+
+CPU_MATH_DISPATCH void vecGelu(const float *x, float *y, size_t n) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+        y[i] = geluApprox(x[i]);
+}
+
+} // namespace infini
@@ -1,113 +1,174 @@
 #include "operators/element_wise.h"
 #include "core/kernel.h"
+#include "cpu/cpu_broadcast.h"
+#include <cmath>
 
 namespace infini {
-template <typename T> class NativeElementWise : public CpuKernelWithoutConfig {
-    virtual T doCompute(T val0, T val1) const = 0;
+
+// y[i] = f(a[i * sa], b[i * sb]) for i < len. A stride of 0 reads a single
+// element, which is hoisted so that every case vectorizes.
+template <typename T, typename F>
+static void binaryRow(const T *a, const T *b, T *y, int64_t len, bool sa,
+                      bool sb, F f) {
+    if (sa && sb) {
+#pragma omp simd
+        for (int64_t i = 0; i < len; ++i)
+            y[i] = f(a[i], b[i]);
+    } else if (sa) {
+        const T v = *b;
+#pragma omp simd
+        for (int64_t i = 0; i < len; ++i)
+            y[i] = f(a[i], v);
+    } else if (sb) {
+        const T v = *a;
+#pragma omp simd
+        for (int64_t i = 0; i < len; ++i)
+            y[i] = f(v, b[i]);
+    } else
+        std::fill_n(y, len, f(*a, *b));
+}
+
+// The output is split into rows along the last dim of the plan, see
+// forEachRow
+template <typename T, typename F>
+static void broadcastBinary(const T *a, const T *b, T *y,
+                            const BroadcastPlan &plan, F f) {
+    // Elements per chunk
+    constexpr int64_t chunk = 16384;
+    const auto &dims = plan.dims;
+    const auto &sa = plan.strides[0], &sb = plan.strides[1];
+    if (dims.empty())
+        return binaryRow(a, b, y, 1, true, true, f);
+    const int64_t len = dims.back();
+    const bool ra = sa.back(), rb = sb.back();
+    // Same shape or a scalar: a single row, which is split instead
+    if (plan.rows() == 1) {
+#pragma omp parallel for if (len > chunk)
+        for (int64_t start = 0; start < len; start += chunk)
+            binaryRow(a + (ra ? start : 0), b + (rb ? start : 0), y + start,
+                      std::min(chunk, len - start), ra, rb, f);
+        return;
+    }
+    forEachRow(
+        plan,
+        [&](int64_t r, const int64_t *offsets) {
+            binaryRow(a + offsets[0], b + offsets[1], y + r * len, len, ra,
+                      rb, f);
+        },
+        chunk);
+}
+
+template <typename T, typename F>
+class NativeElementWise : public CpuKernelWithoutConfig {
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<ElementWiseObj>(_op);
         T *inptr0 = op->getInputs(0)->getRawDataPtr<T *>();
         T *inptr1 = op->getInputs(1)->getRawDataPtr<T *>();
         T *outptr = op->getOutput()->getRawDataPtr<T *>();
+        // Blocked layouts are only handled without broadcasting, where the
+        // memory order does not matter
+        if (op->getOutput()->getChannelBlock() != 1)
+            for (auto &input : op->getInputs())
+                IT_ASSERT(input->getDims() == op->getOutput()->getDims() &&
+                          input->getChannelBlock() ==
+                              op->getOutput()->getChannelBlock());
+        BroadcastPlan plan(
+            op->getOutput()->getDims(),
+            {op->getInputs(0)->getDims(), op->getInputs(1)->getDims()});
+        broadcastBinary(inptr0, inptr1, outptr, plan, F());
+    }
+};
 
-        int a[4] = {1, 1, 1, 1};
-        int b[4] = {1, 1, 1, 1};
-        int c[4] = {1, 1, 1, 1};
-        auto a_input = op->getInputs(0)->getDims();
-        auto b_input = op->getInputs(1)->getDims();
-        auto c_output = op->getOutput()->getDims();
-        std::copy(a_input.begin(), a_input.end(), a + (4 - a_input.size()));
-        std::copy(b_input.begin(), b_input.end(), b + (4 - b_input.size()));
-        std::copy(c_output.begin(), c_output.end(), c + (4 - c_output.size()));
-
-        auto n = op->getOutput()->size();
-        for (size_t i = 0; i < n; ++i) {
-            int c0_index = i / (c[1] * c[2] * c[3]);
-            int c1_index = (i % (c[1] * c[2] * c[3])) / (c[2] * c[3]);
-            int c2_index = ((i % (c[1] * c[2] * c[3])) % (c[2] * c[3])) / c[3];
-            int c3_index = ((i % (c[1] * c[2] * c[3])) % (c[2] * c[3])) % c[3];
+// Floor division and its remainder, whose sign follows the divisor
+template <typename T> static T floorDiv(T a, T b) {
+    if constexpr (std::is_floating_point_v<T>)
+        return std::floor(a / b);
+    else if constexpr (std::is_signed_v<T>)
+        return a / b - (a % b != 0 && (a % b < 0) != (b < 0));
+    else
+        return a / b;
+}
+template <typename T> static T floorMod(T a, T b) {
+    if constexpr (std::is_floating_point_v<T>) {
+        T r = std::fmod(a, b);
+        return r != 0 && (r < 0) != (b < 0) ? r + b : r;
+    } else if constexpr (std::is_signed_v<T>) {
+        T r = a % b;
+        return r != 0 && (r < 0) != (b < 0) ? r + b : r;
+    } else
+        return a % b;
+}
 
-            int a0_index = c0_index % a[0];
-            int a1_index = c1_index % a[1];
-            int a2_index = c2_index % a[2];
-            int a3_index = c3_index % a[3];
+#define DEFINE_BINARY_FUNCTOR(name, expr)                                      \
+    struct name##Functor {                                                     \
+        template <typename T> T operator()(T a, T b) const { return expr; }    \
+    };                                                                         \
+    template <typename T>                                                      \
+    using Naive##name = NativeElementWise<T, name##Functor>;
 
-            int b0_index = c0_index % b[0];
-            int b1_index = c1_index % b[1];
-            int b2_index = c2_index % b[2];
-            int b3_index = c3_index % b[3];
-            outptr[i] = doCompute(
-                inptr0[a0_index * a[1] * a[2] * a[3] + a1_index * a[2] * a[3] +
-                       a2_index * a[3] + a3_index],
-                inptr1[b0_index * b[1] * b[2] * b[3] + b1_index * b[2] * b[3] +
-                       b2_index * b[3] + b3_index]);
-        }
-    }
-};
+DEFINE_BINARY_FUNCTOR(Add, a + b)
+DEFINE_BINARY_FUNCTOR(Sub, a - b)
+DEFINE_BINARY_FUNCTOR(Mul, a * b)
+DEFINE_BINARY_FUNCTOR(Div, T(a / b))
+DEFINE_BINARY_FUNCTOR(Pow, T(std::pow(a, b)))
+DEFINE_BINARY_FUNCTOR(Max, std::max(a, b))
+DEFINE_BINARY_FUNCTOR(Min, std::min(a, b))
+// ONNX Mod takes the sign of the divisor for integers, and is fmod, with the
+// sign of the dividend, for floats
+DEFINE_BINARY_FUNCTOR(Mod, std::is_floating_point_v<T> ? T(std::fmod(a, b))
+                                                        : floorMod(a, b))
+DEFINE_BINARY_FUNCTOR(FloorDiv, floorDiv(a, b))
+DEFINE_BINARY_FUNCTOR(FloorMod, floorMod(a, b))
+DEFINE_BINARY_FUNCTOR(SquaredDifference, (a - b) * (a - b))
+DEFINE_BINARY_FUNCTOR(Equal, T(a == b))
+DEFINE_BINARY_FUNCTOR(GreaterEqual, T(a >= b))
+DEFINE_BINARY_FUNCTOR(GreaterThan, T(a > b))
+DEFINE_BINARY_FUNCTOR(LessEqual, T(a <= b))
+DEFINE_BINARY_FUNCTOR(LessThan, T(a < b))
+DEFINE_BINARY_FUNCTOR(And, T(a != T(0) && b != T(0)))
+DEFINE_BINARY_FUNCTOR(Or, T(a != T(0) || b != T(0)))
+DEFINE_BINARY_FUNCTOR(Xor, T((a != T(0)) != (b != T(0))))
+DEFINE_BINARY_FUNCTOR(BitAnd, T(a & b))
+DEFINE_BINARY_FUNCTOR(BitOr, T(a | b))
+DEFINE_BINARY_FUNCTOR(BitXor, T(a ^ b))
+DEFINE_BINARY_FUNCTOR(BitLeftShift, T(a << b))
 
-template <typename T> class NaiveAdd : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return val0 + val1; }
-};
-template <typename T> class NaiveSub : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return val0 - val1; }
-};
-template <typename T> class NaiveMul : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return val0 * val1; }
-};
-template <typename T> class NaiveDiv : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return (T)(val0 / val1); }
-};
-template <typename T> class NaiveEqual : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return (T)(val0 == val1); }
-};
-template <typename T> class NaiveGreaterEqual : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return (T)(val0 >= val1); }
-};
-template <typename T> class NaiveGreaterThan : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return (T)(val0 > val1); }
-};
-template <typename T> class NaiveLessEqual : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return (T)(val0 <= val1); }
-};
-template <typename T> class NaiveLessThan : public NativeElementWise<T> {
-    T doCompute(T val0, T val1) const override { return (T)(val0 < val1); }
-};
+// Integer kernels of an op, and all kernels of an op
+#define REGISTER_INTEGER_ELEMENT_WISE(type, kernel, name)                      \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Int32,                \
+                    kernel<int32_t>, name "Naive_CPU_int32");                  \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Int64,                \
+                    kernel<int64_t>, name "Naive_CPU_int64");                  \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::UInt32,               \
+                    kernel<uint32_t>, name "Naive_CPU_uint32");
+#define REGISTER_ELEMENT_WISE(type, kernel, name)                              \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Float32,              \
+                    kernel<float>, name "Naive_CPU_float32");                  \
+    REGISTER_INTEGER_ELEMENT_WISE(type, kernel, name)
 
-REGISTER_KERNEL(Device::CPU, OpType::Add, DataType::UInt32, NaiveAdd<uint32_t>,
-                "addNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Add, DataType::Float32, NaiveAdd<float>,
-                "addNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Sub, DataType::UInt32, NaiveSub<uint32_t>,
-                "subNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Sub, DataType::Float32, NaiveSub<float>,
-                "subNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Mul, DataType::UInt32, NaiveMul<uint32_t>,
-                "mulNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Mul, DataType::Float32, NaiveMul<float>,
-                "mulNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Div, DataType::UInt32, NaiveDiv<uint32_t>,
-                "divNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Div, DataType::Float32, NaiveDiv<float>,
-                "divNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Equal, DataType::UInt32,
-                NaiveEqual<uint32_t>, "equalNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Equal, DataType::Float32,
-                NaiveEqual<float>, "equalNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::GreaterOrEqual, DataType::UInt32,
-                NaiveGreaterEqual<uint32_t>, "greaterEqualNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::GreaterOrEqual, DataType::Float32,
-                NaiveGreaterEqual<float>, "greaterEqualNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Greater, DataType::UInt32,
-                NaiveGreaterThan<uint32_t>, "greaterThanNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Greater, DataType::Float32,
-                NaiveGreaterThan<float>, "greaterThanNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::LessOrEqual, DataType::UInt32,
-                NaiveLessEqual<uint32_t>, "lessEqualNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::LessOrEqual, DataType::Float32,
-                NaiveLessEqual<float>, "lessEqualNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Less, DataType::UInt32,
-                NaiveLessThan<uint32_t>, "lessEqualNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Less, DataType::Float32,
-                NaiveLessThan<float>, "lessEqualNaive_CPU_float32");
+REGISTER_ELEMENT_WISE(Add, NaiveAdd, "add")
+REGISTER_ELEMENT_WISE(Sub, NaiveSub, "sub")
+REGISTER_ELEMENT_WISE(Mul, NaiveMul, "mul")
+REGISTER_ELEMENT_WISE(Div, NaiveDiv, "div")
+REGISTER_ELEMENT_WISE(Pow, NaivePow, "pow")
+REGISTER_ELEMENT_WISE(Max, NaiveMax, "max")
+REGISTER_ELEMENT_WISE(Min, NaiveMin, "min")
+REGISTER_ELEMENT_WISE(Mod, NaiveMod, "mod")
+REGISTER_ELEMENT_WISE(FloorDiv, NaiveFloorDiv, "floorDiv")
+REGISTER_ELEMENT_WISE(FloorMod, NaiveFloorMod, "floorMod")
+REGISTER_ELEMENT_WISE(SquaredDifference, NaiveSquaredDifference,
+                      "squaredDifference")
+REGISTER_ELEMENT_WISE(Equal, NaiveEqual, "equal")
+REGISTER_ELEMENT_WISE(GreaterOrEqual, NaiveGreaterEqual, "greaterEqual")
+REGISTER_ELEMENT_WISE(Greater, NaiveGreaterThan, "greaterThan")
+REGISTER_ELEMENT_WISE(LessOrEqual, NaiveLessEqual, "lessEqual")
+REGISTER_ELEMENT_WISE(Less, NaiveLessThan, "lessThan")
+REGISTER_ELEMENT_WISE(And, NaiveAnd, "and")
+REGISTER_ELEMENT_WISE(Or, NaiveOr, "or")
+REGISTER_ELEMENT_WISE(Xor, NaiveXor, "xor")
+REGISTER_INTEGER_ELEMENT_WISE(BitwiseAnd, NaiveBitAnd, "bitAnd")
+REGISTER_INTEGER_ELEMENT_WISE(BitwiseOr, NaiveBitOr, "bitOr")
+REGISTER_INTEGER_ELEMENT_WISE(BitwiseXor, NaiveBitXor, "bitXor")
+REGISTER_INTEGER_ELEMENT_WISE(BitShift, NaiveBitLeftShift, "bitLeftShift")
 }; // namespace infini
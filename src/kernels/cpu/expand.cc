@@ -0,0 +1,39 @@
+#include "operators/expand.h"
+#include "core/kernel.h"
+#include "cpu/cpu_broadcast.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+// Rows along the last dim of the broadcast are copied when the input spans
+// them and filled with one element when it does not
+template <typename T> class NaiveExpand : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<ExpandObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        auto x = input->getRawDataPtr<T *>();
+        auto y = output->getRawDataPtr<T *>();
+        BroadcastPlan plan(output->getDims(), {input->getDims()});
+        if (plan.dims.empty()) {
+            *y = *x;
+            return;
+        }
+        const int64_t len = plan.dims.back();
+        const bool spans = plan.strides[0].back();
+        if (plan.rows() == 1 && spans)
+            return copyBlocks(reinterpret_cast<const uint8_t *>(x), 0,
+                              reinterpret_cast<uint8_t *>(y), 0,
+                              len * sizeof(T), 1);
+        forEachRow(plan, [&](int64_t r, const int64_t *offsets) {
+            if (spans)
+                std::memcpy(y + r * len, x + offsets[0], len * sizeof(T));
+            else
+                std::fill_n(y + r * len, len, x[offsets[0]]);
+        });
+    }
+};
+
+REGISTER_KERNEL_BY_SIZE(Expand, NaiveExpand, "ExpandNaive")
+
+} // namespace infini
@@ -0,0 +1,125 @@
+#include "operators/fused_element_wise.h"
+#include "core/kernel.h"
+#include "cpu/cpu_math.h"
+#include <cmath>
+
+namespace infini {
+
+using Step = FusedElementWiseObj::Step;
+
+template <typename T, typename F>
+static void unaryStep(T *x, int len, F f) {
+#pragma omp simd
+    for (int i = 0; i < len; ++i)
+        x[i] = f(x[i]);
+}
+
+// `y` is a single element if `scalar`, or the matching tile otherwise
+template <typename T, typename F>
+static void binaryStep(T *x, const T *y, bool scalar, bool reversed, int len,
+                       F f) {
+    if (scalar) {
+        const T v = *y;
+        if (reversed)
+            unaryStep(x, len, [&](T a) { return f(v, a); });
+        else
+            unaryStep(x, len, [&](T a) { return f(a, v); });
+    } else if (reversed) {
+#pragma omp simd
+        for (int i = 0; i < len; ++i)
+            x[i] = f(y[i], x[i]);
+    } else {
+#pragma omp simd
+        for (int i = 0; i < len; ++i)
+            x[i] = f(x[i], y[i]);
+    }
+}
+
+template <typename T>
+static void applyStep(const Step &step, T *x, const T *y, bool scalar,
+                      int len) {
+    switch (step.type.underlying()) {
+    case OpType::Add:
+        return binaryStep(x, y, scalar, step.reversed, len,
+                          [](T a, T b) { return a + b; });
+    case OpType::Sub:
+        return binaryStep(x, y, scalar, step.reversed, len,
+                          [](T a, T b) { return a - b; });
+    case OpType::Mul:
+        return binaryStep(x, y, scalar, step.reversed, len,
+                          [](T a, T b) { return a * b; });
+    case OpType::Div:
+        return binaryStep(x, y, scalar, step.reversed, len,
+                          [](T a, T b) { return a / b; });
+    case OpType::Relu:
+        return unaryStep(x, len, [](T a) { return std::max(T(0), a); });
+    case OpType::Sigmoid:
+        return vecSigmoid(x, x, len);
+    case OpType::Tanh:
+        return vecTanh(x, x, len);
+    case OpType::HardSigmoid:
+        return unaryStep(x, len, [](T a) {
+            return std::max(T(0), std::min(T(1), T(0.2) * a + T(0.5)));
+        });
+    case OpType::HardSwish:
+        return unaryStep(x, len, [](T a) {
+            return a * std::max(T(0), std::min(T(1), a * T(1.0 / 6.0) +
+                                                         T(0.5)));
+        });
+    case OpType::Gelu:
+        return vecGelu(x, x, len);
+    case OpType::Erf:
+        return vecErf(x, x, len);
+    case OpType::Abs:
+        return unaryStep(x, len, [](T a) { return std::abs(a); });
+    case OpType::Sqrt:
+        return unaryStep(x, len, [](T a) { return std::sqrt(a); });
+    case OpType::Neg:
+        return unaryStep(x, len, [](T a) { return -a; });
+    default:
+        IT_TODO_HALT();
+    }
+}
+
+template <typename T> class NaiveFusedElementWise : public CpuKernelWithoutConfig {
+    // Elements per tile. A tile stays in L1 while all steps run on it.
+    static constexpr int Tile = 1024;
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<FusedElementWiseObj>(_op);
+        const auto &steps = op->getSteps();
+        const int64_t n = op->getOutput()->size();
+        vector<const T *> inptrs;
+        vector<bool> scalar;
+        for (auto &input : op->getInputs()) {
+            inptrs.emplace_back(input->getRawDataPtr<T *>());
+            scalar.emplace_back(input->size() == 1 && n != 1);
+            // Memory order only matters if the layouts differ
+            IT_ASSERT(scalar.back() || input->getChannelBlock() ==
+                                           op->getOutput()->getChannelBlock());
+        }
+        T *outptr = op->getOutput()->getRawDataPtr<T *>();
+#pragma omp parallel for
+        for (int64_t start = 0; start < n; start += Tile) {
+            const int len = std::min<int64_t>(Tile, n - start);
+            T x[Tile];
+            std::copy_n(inptrs[0] + start, len, x);
+            for (auto &step : steps) {
+                const T *y = nullptr;
+                bool s = false;
+                if (step.input >= 0) {
+                    s = scalar[step.input];
+                    y = inptrs[step.input] + (s ? 0 : start);
+                }
+                applyStep(step, x, y, s, len);
+            }
+            std::copy_n(x, len, outptr + start);
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::FusedElementWise, DataType::Float32,
+                NaiveFusedElementWise<float>, "FusedElementWise_CPU_float32");
+
+} // namespace infini
@@ -0,0 +1,121 @@
+#include "operators/gather.h"
+#include "core/kernel.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+// The indices of `indices` into an axis of `len`, with negative ones counted
+// from its end
+static vector<int64_t> readIndices(const Tensor &indices, int64_t len) {
+    vector<int64_t> ret(indices->size());
+    if (indices->getDType() == DataType::Int32) {
+        auto ptr = indices->getRawDataPtr<int32_t *>();
+        std::copy(ptr, ptr + ret.size(), ret.begin());
+    } else {
+        auto ptr = indices->getRawDataPtr<int64_t *>();
+        std::copy(ptr, ptr + ret.size(), ret.begin());
+    }
+    for (auto &index : ret) {
+        index += index < 0 ? len : 0;
+        IT_ASSERT(index >= 0 && index < len, "Gather index out of range");
+    }
+    return ret;
+}
+
+// Each index selects a block of the input after the axis, copied as a whole
+// for every outer block. Elements are moved as bytes, so one kernel serves
+// every type.
+class NaiveGather : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<GatherObj>(_op);
+        auto input = op->getInputs(0);
+        const auto &dims = input->getDims();
+        const int axis = op->getAxis();
+        size_t outer = 1, inner = input->getDType().getSize();
+        for (int i = 0; i < axis; ++i)
+            outer *= dims[i];
+        for (size_t i = axis + 1; i < dims.size(); ++i)
+            inner *= dims[i];
+        const int64_t len = dims[axis];
+        const auto index = readIndices(op->getInputs(1), len);
+        const int64_t n = index.size();
+        auto src = input->getRawDataPtr<uint8_t *>();
+        auto dst = op->getOutput()->getRawDataPtr<uint8_t *>();
+#pragma omp parallel for collapse(2) if (outer * n * inner > (1 << 16))
+        for (size_t o = 0; o < outer; ++o)
+            for (int64_t k = 0; k < n; ++k)
+                std::memcpy(dst + (o * n + k) * inner,
+                            src + (o * len + index[k]) * inner, inner);
+    }
+};
+
+// out[o][k][i] = in[o][index[o][k][i]][i], with o over the dims before the
+// axis and i over the dims after it
+template <typename T, typename I>
+static void gatherElements(const T *in, const I *index, T *out, int64_t outer,
+                           int64_t len, int64_t n, int64_t inner) {
+    bool valid = true;
+#pragma omp parallel for reduction(&& : valid) if (outer * n * inner > 16384)
+    for (int64_t i = 0; i < outer * n * inner; ++i)
+        valid = valid && index[i] >= -len && index[i] < len;
+    IT_ASSERT(valid, "GatherElements index out of range");
+#pragma omp parallel for collapse(2) if (outer * n * inner > 16384)
+    for (int64_t o = 0; o < outer; ++o)
+        for (int64_t k = 0; k < n; ++k) {
+            const I *ix = index + (o * n + k) * inner;
+            const T *x = in + o * len * inner;
+            T *y = out + (o * n + k) * inner;
+            for (int64_t i = 0; i < inner; ++i) {
+                const int64_t j = ix[i] < 0 ? ix[i] + len : ix[i];
+                y[i] = x[j * inner + i];
+            }
+        }
+}
+
+template <typename T>
+class NaiveGatherElements : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<GatherElementsObj>(_op);
+        auto input = op->getInputs(0), indices = op->getInputs(1);
+        const auto &dims = indices->getDims();
+        const int axis = op->getAxis();
+        int64_t outer = 1, inner = 1;
+        for (int i = 0; i < axis; ++i)
+            outer *= dims[i];
+        for (size_t i = axis + 1; i < dims.size(); ++i)
+            inner *= dims[i];
+        auto in = input->getRawDataPtr<T *>();
+        auto out = op->getOutput()->getRawDataPtr<T *>();
+        const int64_t len = input->getDims()[axis], n = dims[axis];
+        if (indices->getDType() == DataType::Int32)
+            gatherElements(in, indices->getRawDataPtr<int32_t *>(), out, outer,
+                           len, n, inner);
+        else
+            gatherElements(in, indices->getRawDataPtr<int64_t *>(), out, outer,
+                           len, n, inner);
+    }
+};
+
+#define REGISTER_GATHER(type, name)                                            \
+    REGISTER_KERNEL(Device::CPU, OpType::Gather, DataType::type, NaiveGather,  \
+                    "GatherNaive_CPU_" name);
+
+REGISTER_GATHER(Float32, "float32")
+REGISTER_GATHER(Float16, "float16")
+REGISTER_GATHER(BFloat16, "bfloat16")
+REGISTER_GATHER(Double, "float64")
+REGISTER_GATHER(Int8, "int8")
+REGISTER_GATHER(Int16, "int16")
+REGISTER_GATHER(Int32, "int32")
+REGISTER_GATHER(Int64, "int64")
+REGISTER_GATHER(UInt8, "uint8")
+REGISTER_GATHER(UInt16, "uint16")
+REGISTER_GATHER(UInt32, "uint32")
+REGISTER_GATHER(UInt64, "uint64")
+REGISTER_GATHER(Bool, "bool")
+REGISTER_KERNEL_BY_SIZE(GatherElements, NaiveGatherElements,
+                        "GatherElementsNaive")
+
+} // namespace infini
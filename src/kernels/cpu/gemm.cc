@@ -0,0 +1,376 @@
+#include "cpu/cpu_gemm.h"
+#include <algorithm>
+#include <cstring>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define INFINI_CPU_X86 1
+#endif
+
+namespace infini {
+
+namespace {
+
+// Blocking sizes. A kc-deep sliver of packed B (kc * nr elements) stays in L1
+// while the microkernel walks the packed mc x kc block of A out of L2.
+constexpr int KC = 256;
+constexpr int MC = 144; // Divisible by every microkernel's mr
+constexpr int NC = 512; // Divisible by every microkernel's nr
+constexpr int BufferAlign = 64;
+
+// A microkernel computes an mr x nr tile of C from a packed mr x kc sliver of
+// A and a packed kc x nr sliver of B. If `accumulate` is false the tile is
+// overwritten, otherwise the product is added to it.
+template <typename T>
+using MicroKernelFn = void (*)(int kc, const T *a, const T *b, T *c, int ldc,
+                               bool accumulate);
+
+template <typename T> struct MicroKernel {
+    int mr, nr;
+    MicroKernelFn<T> fn;
+};
+
+template <typename T, int MR, int NR>
+inline __attribute__((always_inline)) void
+microKernelRef(int kc, const T *a, const T *b, T *c, int ldc,
+               bool accumulate) {
+    T acc[MR][NR] = {};
+    for (int p = 0; p < kc; ++p, a += MR, b += NR)
+        for (int i = 0; i < MR; ++i)
+            for (int j = 0; j < NR; ++j)
+                acc[i][j] += a[i] * b[j];
+    for (int i = 0; i < MR; ++i)
+        for (int j = 0; j < NR; ++j)
+            c[i * ldc + j] = accumulate ? c[i * ldc + j] + acc[i][j]
+                                        : acc[i][j];
+}
+
+template <typename T>
+void microKernelGeneric(int kc, const T *a, const T *b, T *c, int ldc,
+                        bool accumulate) {
+    microKernelRef<T, 4, 16>(kc, a, b, c, ldc, accumulate);
+}
+
+#ifdef INFINI_CPU_X86
+__attribute__((target("avx2"))) void
+microKernelU32Avx2(int kc, const uint32_t *a, const uint32_t *b, uint32_t *c,
+                   int ldc, bool accumulate) {
+    microKernelRef<uint32_t, 4, 16>(kc, a, b, c, ldc, accumulate);
+}
+
+// 6 x 16 tile: 12 ymm accumulators, 2 ymm for B and 1 for the broadcast of A.
+__attribute__((target("avx2,fma"))) void
+microKernelF32Avx2(int kc, const float *a, const float *b, float *c, int ldc,
+                   bool accumulate) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps();
+    __m256 c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps();
+    __m256 c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps();
+    __m256 c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+    for (int p = 0; p < kc; ++p, a += 6, b += 16) {
+        __m256 b0 = _mm256_load_ps(b), b1 = _mm256_load_ps(b + 8), ai;
+        ai = _mm256_broadcast_ss(a + 0);
+        c00 = _mm256_fmadd_ps(ai, b0, c00), c01 = _mm256_fmadd_ps(ai, b1, c01);
+        ai = _mm256_broadcast_ss(a + 1);
+        c10 = _mm256_fmadd_ps(ai, b0, c10), c11 = _mm256_fmadd_ps(ai, b1, c11);
+        ai = _mm256_broadcast_ss(a + 2);
+        c20 = _mm256_fmadd_ps(ai, b0, c20), c21 = _mm256_fmadd_ps(ai, b1, c21);
+        ai = _mm256_broadcast_ss(a + 3);
+        c30 = _mm256_fmadd_ps(ai, b0, c30), c31 = _mm256_fmadd_ps(ai, b1, c31);
+        ai = _mm256_broadcast_ss(a + 4);
+        c40 = _mm256_fmadd_ps(ai, b0, c40), c41 = _mm256_fmadd_ps(ai, b1, c41);
+        ai = _mm256_broadcast_ss(a + 5);
+        c50 = _mm256_fmadd_ps(ai, b0, c50), c51 = _mm256_fmadd_ps(ai, b1, c51);
+    }
+#define STORE_ROW(i)                                                           \
+    if (accumulate) {                                                          \
+        c##i##0 = _mm256_add_ps(c##i##0, _mm256_loadu_ps(c + i * ldc));        \
+        c##i##1 = _mm256_add_ps(c##i##1, _mm256_loadu_ps(c + i * ldc + 8));    \
+    }                                                                          \
+    _mm256_storeu_ps(c + i * ldc, c##i##0);                                    \
+    _mm256_storeu_ps(c + i * ldc + 8, c##i##1);
+    STORE_ROW(0) STORE_ROW(1) STORE_ROW(2) STORE_ROW(3) STORE_ROW(4)
+    STORE_ROW(5)
+#undef STORE_ROW
+}
+
+// 8 x 32 tile: 16 zmm accumulators.
+__attribute__((target("avx512f"))) void
+microKernelF32Avx512(int kc, const float *a, const float *b, float *c,
+                     int ldc, bool accumulate) {
+    __m512 c00 = _mm512_setzero_ps(), c01 = _mm512_setzero_ps();
+    __m512 c10 = _mm512_setzero_ps(), c11 = _mm512_setzero_ps();
+    __m512 c20 = _mm512_setzero_ps(), c21 = _mm512_setzero_ps();
+    __m512 c30 = _mm512_setzero_ps(), c31 = _mm512_setzero_ps();
+    __m512 c40 = _mm512_setzero_ps(), c41 = _mm512_setzero_ps();
+    __m512 c50 = _mm512_setzero_ps(), c51 = _mm512_setzero_ps();
+    __m512 c60 = _mm512_setzero_ps(), c61 = _mm512_setzero_ps();
+    __m512 c70 = _mm512_setzero_ps(), c71 = _mm512_setzero_ps();
+    for (int p = 0; p < kc; ++p, a += 8, b += 32) {
+        __m512 b0 = _mm512_load_ps(b), b1 = _mm512_load_ps(b + 16), ai;
+#define FMA_ROW(i)                                                             \
+    ai = _mm512_set1_ps(a[i]);                                                 \
+    c##i##0 = _mm512_fmadd_ps(ai, b0, c##i##0);                                \
+    c##i##1 = _mm512_fmadd_ps(ai, b1, c##i##1);
+        FMA_ROW(0) FMA_ROW(1) FMA_ROW(2) FMA_ROW(3)
+        FMA_ROW(4) FMA_ROW(5) FMA_ROW(6) FMA_ROW(7)
+#undef FMA_ROW
+    }
+#define STORE_ROW(i)                                                           \
+    if (accumulate) {                                                          \
+        c##i##0 = _mm512_add_ps(c##i##0, _mm512_loadu_ps(c + i * ldc));        \
+        c##i##1 = _mm512_add_ps(c##i##1, _mm512_loadu_ps(c + i * ldc + 16));   \
+    }                                                                          \
+    _mm512_storeu_ps(c + i * ldc, c##i##0);                                    \
+    _mm512_storeu_ps(c + i * ldc + 16, c##i##1);
+    STORE_ROW(0) STORE_ROW(1) STORE_ROW(2) STORE_ROW(3) STORE_ROW(4)
+    STORE_ROW(5) STORE_ROW(6) STORE_ROW(7)
+#undef STORE_ROW
+}
+#endif
+
+template <typename T> MicroKernel<T> selectMicroKernel();
+
+template <> MicroKernel<float> selectMicroKernel<float>() {
+#ifdef INFINI_CPU_X86
+    if (__builtin_cpu_supports("avx512f"))
+        return {8, 32, microKernelF32Avx512};
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return {6, 16, microKernelF32Avx2};
+#endif
+    return {4, 16, microKernelGeneric<float>};
+}
+
+template <> MicroKernel<uint32_t> selectMicroKernel<uint32_t>() {
+#ifdef INFINI_CPU_X86
+    if (__builtin_cpu_supports("avx2"))
+        return {4, 16, microKernelU32Avx2};
+#endif
+    return {4, 16, microKernelGeneric<uint32_t>};
+}
+
+template <typename T> const MicroKernel<T> &getMicroKernel() {
+    static const MicroKernel<T> kernel = selectMicroKernel<T>();
+    return kernel;
+}
+
+// Element (i, j) of a matrix lives at `ptr[i * rs + j * cs]`, which covers
+// both the plain and the transposed storage.
+template <typename T> struct StridedMatrix {
+    const T *ptr;
+    int64_t rs, cs;
+    const T &at(int64_t i, int64_t j) const { return ptr[i * rs + j * cs]; }
+};
+
+// Pack an mc x kc block of A into slivers of mr rows, each stored as kc
+// consecutive columns of mr elements. Rows past mc are zero-filled.
+template <typename T>
+void packA(const StridedMatrix<T> &a, int mc, int kc, int mr, T *buf) {
+    for (int ir = 0; ir < mc; ir += mr) {
+        int rows = std::min(mr, mc - ir);
+        for (int p = 0; p < kc; ++p, buf += mr) {
+            if (rows == mr && a.rs == 1) {
+                memcpy(buf, &a.at(ir, p), mr * sizeof(T));
+                continue;
+            }
+            for (int i = 0; i < rows; ++i)
+                buf[i] = a.at(ir + i, p);
+            for (int i = rows; i < mr; ++i)
+                buf[i] = T(0);
+        }
+    }
+}
+
+// Pack a kc x nc block of B into slivers of nr columns, each stored as kc
+// consecutive rows of nr elements. Columns past nc are zero-filled.
+template <typename T>
+void packB(const StridedMatrix<T> &b, int kc, int nc, int nr, T *buf) {
+    for (int jr = 0; jr < nc; jr += nr) {
+        int cols = std::min(nr, nc - jr);
+        for (int p = 0; p < kc; ++p, buf += nr) {
+            if (cols == nr && b.cs == 1) {
+                memcpy(buf, &b.at(p, jr), nr * sizeof(T));
+                continue;
+            }
+            for (int j = 0; j < cols; ++j)
+                buf[j] = b.at(p, jr + j);
+            for (int j = cols; j < nr; ++j)
+                buf[j] = T(0);
+        }
+    }
+}
+
+template <typename T> class AlignedBuffer {
+    vector<T> storage;
+    T *aligned;
+
+  public:
+    explicit AlignedBuffer(size_t size)
+        : storage(size + BufferAlign / sizeof(T)) {
+        auto addr = reinterpret_cast<uintptr_t>(storage.data());
+        aligned = reinterpret_cast<T *>((addr + BufferAlign - 1) /
+                                        BufferAlign * BufferAlign);
+    }
+    T *get() { return aligned; }
+};
+
+template <typename T, ActType Act>
+void applyEpilogueImpl(const GemmEpilogue<T> &ep, T *c, int64_t ldc, int i0,
+                       int j0, int rows, int cols) {
+    for (int i = 0; i < rows; ++i) {
+        T *row = c + i * ldc;
+        if (ep.bias) {
+            const T *bias = ep.bias + (i0 + i) * ep.biasRs;
+            if (ep.biasCs == 0)
+                for (int j = 0; j < cols; ++j)
+                    row[j] = cpuActivation(row[j] + bias[0], Act);
+            else
+                for (int j = 0; j < cols; ++j)
+                    row[j] = cpuActivation(row[j] + bias[j0 + j], Act);
+        } else {
+            for (int j = 0; j < cols; ++j)
+                row[j] = cpuActivation(row[j], Act);
+        }
+    }
+}
+
+// Apply the epilogue to the rows x cols block of C at (i0, j0), where `c`
+// points at the block. The activation is a template argument so that the
+// inner loops stay branch-free.
+template <typename T>
+void applyEpilogue(const GemmEpilogue<T> &ep, T *c, int64_t ldc, int i0,
+                   int j0, int rows, int cols) {
+    switch (ep.act) {
+    case ActType::None:
+        return applyEpilogueImpl<T, ActType::None>(ep, c, ldc, i0, j0, rows,
+                                                   cols);
+    case ActType::Relu:
+        return applyEpilogueImpl<T, ActType::Relu>(ep, c, ldc, i0, j0, rows,
+                                                   cols);
+    case ActType::Sigmoid:
+        return applyEpilogueImpl<T, ActType::Sigmoid>(ep, c, ldc, i0, j0,
+                                                      rows, cols);
+    case ActType::Tanh:
+        return applyEpilogueImpl<T, ActType::Tanh>(ep, c, ldc, i0, j0, rows,
+                                                   cols);
+    }
+}
+
+// Compute the mc x nc tile of C at (i0, j0) over the full k extent. The
+// epilogue is applied to each microkernel tile once its last k block is done,
+// while the tile is still in L1.
+template <typename T>
+void computeTile(const MicroKernel<T> &uk, const StridedMatrix<T> &a,
+                 const StridedMatrix<T> &b, T *c, int n, int k, int i0,
+                 int mc, int j0, int nc, T *aPack, T *bPack, T *cTmp,
+                 const GemmEpilogue<T> &ep) {
+    const int mr = uk.mr, nr = uk.nr;
+    if (k == 0) {
+        for (int i = 0; i < mc; ++i)
+            std::fill_n(c + (int64_t)(i0 + i) * n + j0, nc, T(0));
+        if (!ep.empty())
+            applyEpilogue(ep, c + (int64_t)i0 * n + j0, n, i0, j0, mc, nc);
+        return;
+    }
+    for (int pc = 0; pc < k; pc += KC) {
+        int kc = std::min(KC, k - pc);
+        bool accumulate = pc > 0, last = pc + kc == k;
+        packB({&b.at(pc, j0), b.rs, b.cs}, kc, nc, nr, bPack);
+        packA({&a.at(i0, pc), a.rs, a.cs}, mc, kc, mr, aPack);
+        for (int jr = 0; jr < nc; jr += nr) {
+            int cols = std::min(nr, nc - jr);
+            for (int ir = 0; ir < mc; ir += mr) {
+                int rows = std::min(mr, mc - ir);
+                T *cPtr = c + (int64_t)(i0 + ir) * n + j0 + jr;
+                const T *aSliver = aPack + (int64_t)ir * kc;
+                const T *bSliver = bPack + (int64_t)jr * kc;
+                if (rows == mr && cols == nr) {
+                    uk.fn(kc, aSliver, bSliver, cPtr, n, accumulate);
+                } else {
+                    // Edge tile: compute a full tile aside and copy the valid
+                    // part
+                    uk.fn(kc, aSliver, bSliver, cTmp, nr, false);
+                    for (int i = 0; i < rows; ++i)
+                        for (int j = 0; j < cols; ++j)
+                            cPtr[(int64_t)i * n + j] =
+                                accumulate ? cPtr[(int64_t)i * n + j] +
+                                                 cTmp[i * nr + j]
+                                           : cTmp[i * nr + j];
+                }
+                if (last && !ep.empty())
+                    applyEpilogue(ep, cPtr, n, i0 + ir, j0 + jr, rows, cols);
+            }
+        }
+    }
+}
+
+} // namespace
+
+template <typename T>
+void cpuGemmBatched(bool transA, bool transB, int b, int m, int n, int k,
+                    const T *A, const int64_t *offsetA, const T *B,
+                    const int64_t *offsetB, T *C,
+                    const GemmEpilogue<T> &epilogue) {
+    if (b == 0 || m == 0 || n == 0)
+        return;
+    const auto &uk = getMicroKernel<T>();
+    // Logical strides of op(A) (m x k) and op(B) (k x n)
+    const int64_t aRs = transA ? 1 : k, aCs = transA ? m : 1;
+    const int64_t bRs = transB ? 1 : n, bCs = transB ? k : 1;
+
+    // Callers that already run in parallel (e.g. one GEMM per conv tile) get
+    // a serial GEMM, so the blocks are sized for a single thread.
+    int threads = 1;
+#ifdef _OPENMP
+    if (!omp_in_parallel())
+        threads = omp_get_max_threads();
+#endif
+    // Shrink the blocks of C until there are enough tiles to keep every
+    // thread busy, but never below a few microkernel tiles per block.
+    int mc = MC, nc = NC;
+    auto numTiles = [&]() {
+        return (int64_t)b * ((m + mc - 1) / mc) * ((n + nc - 1) / nc);
+    };
+    while (numTiles() < 2 * threads && nc > 4 * uk.nr)
+        nc = std::max(uk.nr, nc / 2 / uk.nr * uk.nr);
+    while (numTiles() < 2 * threads && mc > 4 * uk.mr)
+        mc = std::max(uk.mr, mc / 2 / uk.mr * uk.mr);
+    mc = std::min(mc, (m + uk.mr - 1) / uk.mr * uk.mr);
+    nc = std::min(nc, (n + uk.nr - 1) / uk.nr * uk.nr);
+    const int mBlocks = (m + mc - 1) / mc, nBlocks = (n + nc - 1) / nc;
+    const int64_t tiles = (int64_t)b * mBlocks * nBlocks;
+    const bool parallel = threads > 1 && tiles > 1 &&
+                          (double)b * m * n * std::max(k, 1) >= 64 * 1024;
+
+#pragma omp parallel if (parallel)
+    {
+        AlignedBuffer<T> aPack((size_t)mc * KC), bPack((size_t)KC * nc),
+            cTmp((size_t)uk.mr * uk.nr);
+#pragma omp for schedule(dynamic)
+        for (int64_t t = 0; t < tiles; ++t) {
+            int bi = t / (mBlocks * nBlocks);
+            int ib = t / nBlocks % mBlocks, jb = t % nBlocks;
+            int i0 = ib * mc, j0 = jb * nc;
+            StridedMatrix<T> a{A + offsetA[bi], aRs, aCs};
+            StridedMatrix<T> bm{B + offsetB[bi], bRs, bCs};
+            computeTile(uk, a, bm, C + (int64_t)bi * m * n, n, k, i0,
+                        std::min(mc, m - i0), j0, std::min(nc, n - j0),
+                        aPack.get(), bPack.get(), cTmp.get(), epilogue);
+        }
+    }
+}
+
+template void cpuGemmBatched<float>(bool, bool, int, int, int, int,
+                                    const float *, const int64_t *,
+                                    const float *, const int64_t *, float *,
+                                    const GemmEpilogue<float> &);
+template void cpuGemmBatched<uint32_t>(bool, bool, int, int, int, int,
+                                       const uint32_t *, const int64_t *,
+                                       const uint32_t *, const int64_t *,
+                                       uint32_t *,
+                                       const GemmEpilogue<uint32_t> &);
+
+} // namespace infini
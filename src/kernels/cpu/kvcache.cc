@@ -0,0 +1,97 @@
+#include "operators/kvcache.h"
+#include "core/kernel.h"
+#include <cmath>
+#include <cstring>
+
+namespace infini {
+
+static int64_t readPosition(const Tensor &position) {
+    int64_t pos = position->getDType() == DataType::Int32
+                      ? *position->getRawDataPtr<int32_t *>()
+                      : *position->getRawDataPtr<int64_t *>();
+    IT_ASSERT(pos >= 0, "Negative KV cache position");
+    return pos;
+}
+
+class NaiveKVCacheAppend : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<KVCacheAppendObj>(_op);
+        auto cache = op->getInputs(0), input = op->getInputs(1);
+        auto dims = cache->getDims();
+        int rank = dims.size();
+        size_t maxLength = dims[rank - 2], n = input->getDims()[rank - 2];
+        size_t pos = readPosition(op->getInputs(2));
+        IT_ASSERT(pos + n <= maxLength, "The KV cache is full");
+        size_t outer = cache->size() / (maxLength * dims[rank - 1]);
+        size_t row = dims[rank - 1] * cache->getDType().getSize();
+        auto dst = cache->getRawDataPtr<uint8_t *>();
+        auto src = input->getRawDataPtr<uint8_t *>();
+        // Only the new rows are written
+#pragma omp parallel for if (outer > 1)
+        for (size_t o = 0; o < outer; ++o)
+            std::memcpy(dst + (o * maxLength + pos) * row, src + o * n * row,
+                        n * row);
+        // The output is always planned onto the cache
+        IT_ASSERT(op->getOutput()->getRawDataPtr<uint8_t *>() == dst);
+    }
+};
+
+template <typename T>
+class NaiveAttentionKVCache : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<AttentionKVCacheObj>(_op);
+        auto qDims = op->getInputs(0)->getDims();
+        auto kDims = op->getInputs(1)->getDims();
+        const int batch = qDims[0], heads = qDims[1], n = qDims[2],
+                  dim = qDims[3], kvHeads = kDims[1], maxLength = kDims[2];
+        const int64_t pos = readPosition(op->getInputs(3));
+        IT_ASSERT(pos + n <= maxLength, "Attending past the KV cache");
+        const int group = heads / kvHeads;
+        const T scale = 1 / std::sqrt(T(dim));
+        T *q = op->getInputs(0)->getRawDataPtr<T *>();
+        T *k = op->getInputs(1)->getRawDataPtr<T *>();
+        T *v = op->getInputs(2)->getRawDataPtr<T *>();
+        T *y = op->getOutput()->getRawDataPtr<T *>();
+        const int rows = batch * heads * n;
+#pragma omp parallel for
+        for (int r = 0; r < rows; ++r) {
+            int i = r % n, h = r / n % heads, b = r / n / heads;
+            size_t kv = (size_t(b) * kvHeads + h / group) * maxLength * dim;
+            const T *qi = q + size_t(r) * dim;
+            T *yi = y + size_t(r) * dim;
+            std::fill_n(yi, dim, T(0));
+            // A single pass over the valid prefix with a running max and
+            // sum, instead of storing the scores
+            T max = -INFINITY, sum = 0;
+            for (int64_t j = 0; j <= pos + i; ++j) {
+                const T *kj = k + kv + j * dim, *vj = v + kv + j * dim;
+                T s = 0;
+                for (int d = 0; d < dim; ++d)
+                    s += qi[d] * kj[d];
+                s *= scale;
+                if (s > max) {
+                    T rescale = std::exp(max - s);
+                    sum *= rescale;
+                    for (int d = 0; d < dim; ++d)
+                        yi[d] *= rescale;
+                    max = s;
+                }
+                T p = std::exp(s - max);
+                sum += p;
+                for (int d = 0; d < dim; ++d)
+                    yi[d] += p * vj[d];
+            }
+            for (int d = 0; d < dim; ++d)
+                yi[d] /= sum;
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::KVCacheAppend, DataType::Float32,
+                NaiveKVCacheAppend, "KVCacheAppend_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::AttentionKVCache, DataType::Float32,
+                NaiveAttentionKVCache<float>, "AttentionKVCache_CPU_float32");
+
+} // namespace infini
@@ -0,0 +1,118 @@
+#include "operators/layer_norm.h"
+#include "core/kernel.h"
+#include <cmath>
+
+namespace infini {
+
+// The normalized elements are the rows of [outer, len]. The statistics of a
+// row are taken in a single pass over its memory, so each row is read twice
+// in total: once for them and once to write the output.
+
+// The elements of a row summed at a time. A chunk stays in L1, so its second
+// pass is not a memory pass.
+static constexpr int chunk = 256;
+
+// Mean and variance of a row. The mean is taken relative to the first
+// element, as the differences of nearby floats are exact: a mean far from
+// zero then costs no digits, neither here nor where it is subtracted. The
+// chunks are reduced exactly with two passes each, and merged with the
+// parallel form of Welford's update.
+static void rowMoments(const float *x, int len, float shift, float &mean,
+                       float &var) {
+    double runMean = 0, m2 = 0;
+    int n = 0;
+    for (int c0 = 0; c0 < len; c0 += chunk) {
+        const int width = std::min(chunk, len - c0);
+        const float *xc = x + c0;
+        float sum = 0;
+#pragma omp simd reduction(+ : sum)
+        for (int i = 0; i < width; ++i)
+            sum += xc[i] - shift;
+        const float chunkMean = sum / width;
+        float sq = 0;
+#pragma omp simd reduction(+ : sq)
+        for (int i = 0; i < width; ++i)
+            sq += (xc[i] - shift - chunkMean) * (xc[i] - shift - chunkMean);
+        const double delta = chunkMean - runMean;
+        const int total = n + width;
+        runMean += delta * width / total;
+        m2 += sq + delta * delta * n * width / total;
+        n = total;
+    }
+    mean = runMean;
+    var = m2 / len;
+}
+
+class NativeLayerNorm : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<LayerNormObj>(_op);
+        auto input = op->getInputs(0);
+        const int len = op->getInputs(1)->size();
+        const size_t outer = input->size() / len;
+        const float eps = op->getEps();
+        const float *x = input->getRawDataPtr<float *>();
+        const float *scale = op->getInputs(1)->getRawDataPtr<float *>();
+        const float *bias =
+            op->getBias() ? op->getBias()->getRawDataPtr<float *>() : nullptr;
+        float *y = op->getOutput()->getRawDataPtr<float *>();
+#pragma omp parallel for if (outer * len > 4096)
+        for (size_t o = 0; o < outer; ++o) {
+            const float *xo = x + o * len;
+            float *yo = y + o * len;
+            const float shift = xo[0];
+            float mean, var;
+            rowMoments(xo, len, shift, mean, var);
+            const float inv = 1 / std::sqrt(var + eps);
+            if (bias) {
+#pragma omp simd
+                for (int i = 0; i < len; ++i)
+                    yo[i] = (xo[i] - shift - mean) * inv * scale[i] + bias[i];
+            } else {
+#pragma omp simd
+                for (int i = 0; i < len; ++i)
+                    yo[i] = (xo[i] - shift - mean) * inv * scale[i];
+            }
+        }
+    }
+};
+
+class NativeRMSNorm : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<RMSNormObj>(_op);
+        auto input = op->getInputs(0);
+        const int len = op->getInputs(1)->size();
+        const size_t outer = input->size() / len;
+        const float eps = op->getEps();
+        const float *x = input->getRawDataPtr<float *>();
+        const float *weight = op->getInputs(1)->getRawDataPtr<float *>();
+        float *y = op->getOutput()->getRawDataPtr<float *>();
+#pragma omp parallel for if (outer * len > 4096)
+        for (size_t o = 0; o < outer; ++o) {
+            const float *xo = x + o * len;
+            float *yo = y + o * len;
+            // Squares are never cancelled, so a plain sum is accurate
+            double sq = 0;
+            for (int c0 = 0; c0 < len; c0 += chunk) {
+                const int width = std::min(chunk, len - c0);
+                float part = 0;
+#pragma omp simd reduction(+ : part)
+                for (int i = c0; i < c0 + width; ++i)
+                    part += xo[i] * xo[i];
+                sq += part;
+            }
+            const float inv = 1 / std::sqrt(float(sq / len) + eps);
+#pragma omp simd
+            for (int i = 0; i < len; ++i)
+                yo[i] = xo[i] * inv * weight[i];
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::LayerNormalization, DataType::Float32,
+                NativeLayerNorm, "LayerNormalization_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::RMSNorm, DataType::Float32,
+                NativeRMSNorm, "RMSNorm_CPU_float32");
+
+} // namespace infini
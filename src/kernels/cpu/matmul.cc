@@ -1,33 +1,86 @@
 #include "operators/matmul.h"
 #include "core/kernel.h"
+#include "cpu/cpu_gemm.h"
 
 namespace infini {
 
-template <typename T> class NaiveMatmul : public CpuKernelWithoutConfig {
+// Element offsets of every broadcast batch of an input inside its tensor.
+// `outBatch` holds the leading (batch) dims of the output, `inBatch` those of
+// the input, aligned to the right as in numpy broadcasting.
+static vector<int64_t> batchOffsets(const Shape &outBatch, const Shape &inBatch,
+                                    int64_t matrixSize) {
+    int64_t batch = 1;
+    for (auto d : outBatch)
+        batch *= d;
+    vector<int64_t> offsets(batch);
+    const int rank = outBatch.size(), shift = rank - inBatch.size();
+    for (int64_t i = 0; i < batch; ++i) {
+        int64_t rest = i, offset = 0, stride = matrixSize;
+        for (int d = rank - 1; d >= shift; --d) {
+            int inDim = inBatch[d - shift];
+            if (inDim != 1)
+                offset += rest % outBatch[d] * stride;
+            rest /= outBatch[d];
+            stride *= inDim;
+        }
+        offsets[i] = offset;
+    }
+    return offsets;
+}
+
+// Describe the bias of `op` for the GEMM epilogue. The bias is broadcast to
+// the m x n output matrix and shared by all batches.
+template <typename T>
+static GemmEpilogue<T> matmulEpilogue(const MatmulObj *op) {
+    GemmEpilogue<T> ep;
+    ep.act = op->getAct();
+    if (!std::is_floating_point_v<T>)
+        IT_ASSERT(ep.act == ActType::None || ep.act == ActType::Relu,
+                  "Only Relu can be fused into an integer matmul.");
+    auto bias = op->getBias();
+    if (!bias)
+        return ep;
+    auto dims = bias->getDims();
+    int rank = dims.size();
+    int biasM = rank >= 2 ? dims[rank - 2] : 1;
+    int biasN = rank >= 1 ? dims[rank - 1] : 1;
+    IT_ASSERT((size_t)biasM * biasN == bias->size(),
+              "Matmul bias can not have batch dimensions.");
+    IT_ASSERT(biasM == 1 || biasM == op->getM());
+    IT_ASSERT(biasN == 1 || biasN == op->getN());
+    ep.bias = bias->getRawDataPtr<T *>();
+    ep.biasRs = biasM == 1 ? 0 : biasN;
+    ep.biasCs = biasN == 1 ? 0 : 1;
+    return ep;
+}
+
+template <typename T> class NativeMatmul : public CpuKernelWithoutConfig {
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<MatmulObj>(_op);
-        IT_ASSERT(op->getInputs().size() == 2, "Bias is not supported yet.");
         T *A = op->getInputs(0)->getRawDataPtr<T *>();
         T *B = op->getInputs(1)->getRawDataPtr<T *>();
         T *C = op->getOutput()->getRawDataPtr<T *>();
-        IT_ASSERT(op->getTransA() == false && op->getTransB() == false);
-        IT_ASSERT(op->getAct() == ActType::None);
-        const int M = op->getM(), N = op->getN(), K = op->getK();
-        for (int i = 0; i < M; i++) {
-            for (int j = 0; j < N; j++) {
-                C[i * N + j] = 0;
-                for (int k = 0; k < K; k++) {
-                    C[i * N + j] += A[i * K + k] * B[k * N + j];
-                }
-            }
-        }
+        const int b = op->getB(), m = op->getM(), n = op->getN(),
+                  k = op->getK();
+        auto shapeA = op->getInputs(0)->getDims(),
+             shapeB = op->getInputs(1)->getDims(),
+             shapeC = op->getOutput()->getDims();
+        Shape batchA(shapeA.begin(), shapeA.end() - 2),
+            batchB(shapeB.begin(), shapeB.end() - 2),
+            batchC(shapeC.begin(), shapeC.end() - 2);
+        auto offsetA = batchOffsets(batchC, batchA, (int64_t)m * k);
+        auto offsetB = batchOffsets(batchC, batchB, (int64_t)k * n);
+        IT_ASSERT((int)offsetA.size() == b);
+        cpuGemmBatched<T>(op->getTransA(), op->getTransB(), b, m, n, k, A,
+                          offsetA.data(), B, offsetB.data(), C,
+                          matmulEpilogue<T>(op.get()));
     }
 };
 
 REGISTER_KERNEL(Device::CPU, OpType::MatMul, DataType::UInt32,
-                NaiveMatmul<uint32_t>, "MatmulNaive_CPU_uint32");
+                NativeMatmul<uint32_t>, "Matmul_CPU_uint32");
 REGISTER_KERNEL(Device::CPU, OpType::MatMul, DataType::Float32,
-                NaiveMatmul<float>, "MatmulNaive_CPU_float32");
+                NativeMatmul<float>, "Matmul_CPU_float32");
 
 } // namespace infini
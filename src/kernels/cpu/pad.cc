@@ -0,0 +1,64 @@
+#include "operators/pad.h"
+#include "core/kernel.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+// The output is zeroed, and the input copied into it in rows spanning the
+// dims after the last padded one. Elements are moved as bytes, so one kernel
+// serves every type.
+class NaivePad : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<PadObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        const auto &inDims = input->getDims(), &outDims = output->getDims();
+        const auto pads = op->getPads();
+        const int rank = inDims.size();
+        auto src = input->getRawDataPtr<uint8_t *>();
+        auto dst = output->getRawDataPtr<uint8_t *>();
+        int last = rank - 1;
+        while (last >= 0 && pads[last] == 0 && pads[last + rank] == 0)
+            --last;
+        if (last < 0)
+            return copyBlocks(src, 0, dst, 0, input->getBytes(), 1);
+        // Byte strides of the input and output
+        vector<int64_t> inStride(rank), outStride(rank);
+        int64_t in = input->getDType().getSize(), out = in;
+        for (int i = rank - 1; i >= 0; --i) {
+            inStride[i] = in;
+            outStride[i] = out;
+            in *= inDims[i];
+            out *= outDims[i];
+        }
+        std::memset(dst, 0, output->getBytes());
+        int64_t base = 0;
+        for (int i = 0; i <= last; ++i)
+            base += pads[i] * outStride[i];
+        vector<int64_t> dims(inDims.begin(), inDims.begin() + last),
+            srcStrides(inStride.begin(), inStride.begin() + last),
+            dstStrides(outStride.begin(), outStride.begin() + last);
+        copyRows(src, srcStrides, dst + base, dstStrides, dims,
+                 inDims[last] * inStride[last]);
+    }
+};
+
+#define REGISTER_PAD(type, name)                                               \
+    REGISTER_KERNEL(Device::CPU, OpType::Pad, DataType::type, NaivePad,        \
+                    "PadNaive_CPU_" name);
+
+REGISTER_PAD(Float32, "float32")
+REGISTER_PAD(Float16, "float16")
+REGISTER_PAD(BFloat16, "bfloat16")
+REGISTER_PAD(Double, "float64")
+REGISTER_PAD(Int8, "int8")
+REGISTER_PAD(Int16, "int16")
+REGISTER_PAD(Int32, "int32")
+REGISTER_PAD(Int64, "int64")
+REGISTER_PAD(UInt8, "uint8")
+REGISTER_PAD(UInt16, "uint16")
+REGISTER_PAD(UInt32, "uint32")
+REGISTER_PAD(UInt64, "uint64")
+REGISTER_PAD(Bool, "bool")
+
+} // namespace infini
@@ -3,8 +3,10 @@
 
 namespace infini {
 template <typename T> class NativePooling : public CpuKernelWithoutConfig {
+    // Pool the window at (posh, posw) of a plane whose pixel (h, w) is
+    // inptr[(h * iw + w) * stride].
     virtual T getPoolingValue(int kh, int kw, int posh, int posw, int ih,
-                              int iw, T *inptr) const = 0;
+                              int iw, T *inptr, int stride) const = 0;
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<PoolingObj>(_op);
@@ -16,18 +18,22 @@ template <typename T> class NativePooling : public CpuKernelWithoutConfig {
             IT_TODO_HALT(); // To support dailated pooling
         auto outDim = op->getOutput()->getDims();
         int oh = outDim[2], ow = outDim[3];
+        // Channel j of a blocked layout interleaves with the rest of its block
+        const int block = op->getInputs(0)->getChannelBlock();
+        IT_ASSERT(op->getOutput()->getChannelBlock() == block);
         for (auto i = 0; i < n; i++) {
             for (auto j = 0; j < c; j++) {
-                auto inoffset = i * (c * ih * iw) + j * ih * iw;
+                auto inoffset =
+                    (i * c + j / block * block) * ih * iw + j % block;
+                auto outbase =
+                    (i * c + j / block * block) * oh * ow + j % block;
                 for (auto h = 0; h < oh; h++) {
                     for (auto w = 0; w < ow; w++) {
                         // TODO: verify ceil mode
-                        T val =
-                            getPoolingValue(kh, kw, h * sh - ph, w * sw - pw,
-                                            ih, iw, inptr + inoffset);
-                        auto outoffset =
-                            w + h * ow + j * (oh * ow) + i * (c * oh * ow);
-                        outptr[outoffset] = val;
+                        T val = getPoolingValue(kh, kw, h * sh - ph,
+                                                w * sw - pw, ih, iw,
+                                                inptr + inoffset, block);
+                        outptr[outbase + (h * ow + w) * block] = val;
                     }
                 }
             }
@@ -37,7 +43,7 @@ template <typename T> class NativePooling : public CpuKernelWithoutConfig {
 
 template <typename T> class NaiveMaxPool : public NativePooling<T> {
     T getPoolingValue(int kh, int kw, int posh, int posw, int ih, int iw,
-                      T *inptr) const override {
+                      T *inptr, int stride) const override {
         T maxval = 0;
         for (auto k = 0; k < kh; k++) {
             for (auto l = 0; l < kw; l++) {
@@ -45,7 +51,7 @@ template <typename T> class NaiveMaxPool : public NativePooling<T> {
                 auto inPosW = posw + l;
                 if (inPosH < 0 || inPosH >= ih || inPosW < 0 || inPosW >= iw)
                     continue;
-                auto offset = (posh + k) * iw + posw + l;
+                auto offset = ((posh + k) * iw + posw + l) * stride;
                 auto val = inptr[offset];
                 if (maxval < val)
                     maxval = val;
@@ -57,7 +63,7 @@ template <typename T> class NaiveMaxPool : public NativePooling<T> {
 
 template <typename T> class NaiveAvgPool : public NativePooling<T> {
     T getPoolingValue(int kh, int kw, int posh, int posw, int ih, int iw,
-                      T *inptr) const override {
+                      T *inptr, int stride) const override {
         T sum = 0;
         for (auto k = 0; k < kh; k++) {
             for (auto l = 0; l < kw; l++) {
@@ -65,7 +71,7 @@ template <typename T> class NaiveAvgPool : public NativePooling<T> {
                 auto inPosW = posw + l;
                 if (inPosH < 0 || inPosH >= ih || inPosW < 0 || inPosW >= iw)
                     continue;
-                auto offset = (posh + k) * iw + posw + l;
+                auto offset = ((posh + k) * iw + posw + l) * stride;
                 sum += inptr[offset];
             }
         }
@@ -0,0 +1,289 @@
+#include "operators/reduce.h"
+#include "core/kernel.h"
+#include "cpu/cpu_math.h"
+#include <cmath>
+#include <limits>
+
+namespace infini {
+
+// A reduction is acc = combine(acc, map(x)) from init, then finalize(acc)
+// over the `count` reduced elements. `shift` is the max of the elements for
+// LogSumExp, which maps them to exp(x - shift), and 0 otherwise.
+template <typename T> struct SumReducer {
+    static constexpr bool shifted = false;
+    static T init() { return T(0); }
+    static T map(T x, T) { return x; }
+    static T combine(T a, T b) { return a + b; }
+    static T finalize(T acc, int64_t, T) { return acc; }
+};
+template <typename T> struct MeanReducer : SumReducer<T> {
+    static T finalize(T acc, int64_t count, T) { return acc / T(count); }
+};
+template <typename T> struct SumSquareReducer : SumReducer<T> {
+    static T map(T x, T) { return x * x; }
+};
+template <typename T> struct L1Reducer : SumReducer<T> {
+    static T map(T x, T) { return x < T(0) ? -x : x; }
+};
+template <typename T> struct L2Reducer : SumSquareReducer<T> {
+    static T finalize(T acc, int64_t, T) { return std::sqrt(acc); }
+};
+template <typename T> struct LogSumReducer : SumReducer<T> {
+    static T finalize(T acc, int64_t, T) { return std::log(acc); }
+};
+template <typename T> struct LogSumExpReducer : SumReducer<T> {
+    static constexpr bool shifted = true;
+    static T map(T x, T shift) { return expApprox(x - shift); }
+    static T finalize(T acc, int64_t, T shift) {
+        return shift + std::log(acc);
+    }
+};
+template <typename T> struct ProdReducer : SumReducer<T> {
+    static T init() { return T(1); }
+    static T combine(T a, T b) { return a * b; }
+};
+template <typename T> struct MaxReducer : SumReducer<T> {
+    static T init() {
+        return std::numeric_limits<T>::has_infinity
+                   ? -std::numeric_limits<T>::infinity()
+                   : std::numeric_limits<T>::lowest();
+    }
+    static T combine(T a, T b) { return a > b ? a : b; }
+};
+template <typename T> struct MinReducer : SumReducer<T> {
+    static T init() {
+        return std::numeric_limits<T>::has_infinity
+                   ? std::numeric_limits<T>::infinity()
+                   : std::numeric_limits<T>::max();
+    }
+    static T combine(T a, T b) { return a < b ? a : b; }
+};
+
+// Fold R over load(0), ..., load(n - 1) in eight interleaved lanes, which
+// vectorize, halving long ranges first. The pairwise halving bounds the
+// rounding error of a sum by about log2(n / 256) + 256 ulp instead of n.
+template <typename T, typename R, typename L>
+static T reduceRange(L load, int64_t begin, int64_t n, T shift) {
+    if (n > 256) {
+        const int64_t half = n / 16 * 8;
+        return R::combine(reduceRange<T, R>(load, begin, half, shift),
+                          reduceRange<T, R>(load, begin + half, n - half,
+                                            shift));
+    }
+    T acc[8];
+    for (auto &a : acc)
+        a = R::init();
+    int64_t i = 0;
+    for (; i + 8 <= n; i += 8)
+        for (int j = 0; j < 8; ++j)
+            acc[j] = R::combine(acc[j], R::map(load(begin + i + j), shift));
+    for (; i < n; ++i)
+        acc[0] = R::combine(acc[0], R::map(load(begin + i), shift));
+    for (int w = 4; w > 0; w /= 2)
+        for (int j = 0; j < w; ++j)
+            acc[j] = R::combine(acc[j], acc[j + w]);
+    return acc[0];
+}
+
+// Elements per task
+constexpr int64_t chunk = 16384;
+
+// out[o] = R(x[o * len], ..., x[o * len + len - 1]). Long rows are cut into
+// chunks reduced in parallel, and their results combined pairwise.
+template <typename T, typename R>
+static void reduceRows(const T *x, T *out, int64_t rows, int64_t len) {
+    auto rowOf = [&](const T *row, int64_t n, T shift) {
+        return reduceRange<T, R>([row](int64_t i) { return row[i]; }, 0, n,
+                                 shift);
+    };
+    if (rows > 1 || len <= chunk) {
+#pragma omp parallel for if (rows * len > chunk)
+        for (int64_t o = 0; o < rows; ++o) {
+            const T *row = x + o * len;
+            T shift = 0;
+            if constexpr (R::shifted)
+                shift = reduceRange<T, MaxReducer<T>>(
+                    [row](int64_t i) { return row[i]; }, 0, len, T(0));
+            out[o] = R::finalize(rowOf(row, len, shift), len, shift);
+        }
+        return;
+    }
+    const int64_t parts = (len + chunk - 1) / chunk;
+    vector<T> partial(parts);
+    T shift = 0;
+    if constexpr (R::shifted) {
+#pragma omp parallel for
+        for (int64_t p = 0; p < parts; ++p)
+            partial[p] = reduceRange<T, MaxReducer<T>>(
+                [x](int64_t i) { return x[i]; }, p * chunk,
+                std::min(chunk, len - p * chunk), T(0));
+        shift = reduceRange<T, MaxReducer<T>>(
+            [&](int64_t i) { return partial[i]; }, 0, parts, T(0));
+    }
+#pragma omp parallel for
+    for (int64_t p = 0; p < parts; ++p)
+        partial[p] =
+            rowOf(x + p * chunk, std::min(chunk, len - p * chunk), shift);
+    // The partial results are combined as they are, without mapping
+    struct Combine : R {
+        static T map(T x, T) { return x; }
+    };
+    out[0] = R::finalize(
+        reduceRange<T, Combine>([&](int64_t i) { return partial[i]; }, 0,
+                                parts, T(0)),
+        len, shift);
+}
+
+// out[o][i] = R over r of x[o][r][i], accumulated across a block of `inner`
+// at a time, whose loads are contiguous and vectorize. Rows of r are summed
+// in blocks of 128 first, which bounds the rounding error as in reduceRange.
+template <typename T, typename R>
+static void reduceStrided(const T *x, T *out, int64_t outer, int64_t len,
+                          int64_t inner) {
+    constexpr int64_t width = 256, block = 128;
+    const int64_t blocks = (inner + width - 1) / width;
+#pragma omp parallel for collapse(2) if (outer * len * inner > chunk)
+    for (int64_t o = 0; o < outer; ++o)
+        for (int64_t b = 0; b < blocks; ++b) {
+            const int64_t i0 = b * width, w = std::min(width, inner - i0);
+            const T *src = x + o * len * inner + i0;
+            T shift[width], acc[width], part[width];
+            for (int64_t i = 0; i < w; ++i)
+                shift[i] = 0, acc[i] = R::init();
+            if constexpr (R::shifted) {
+                for (int64_t i = 0; i < w; ++i)
+                    shift[i] = MaxReducer<T>::init();
+                for (int64_t r = 0; r < len; ++r)
+                    for (int64_t i = 0; i < w; ++i)
+                        shift[i] = MaxReducer<T>::combine(
+                            shift[i], src[r * inner + i]);
+            }
+            for (int64_t r0 = 0; r0 < len; r0 += block) {
+                for (int64_t i = 0; i < w; ++i)
+                    part[i] = R::init();
+                for (int64_t r = r0; r < std::min(len, r0 + block); ++r)
+#pragma omp simd
+                    for (int64_t i = 0; i < w; ++i)
+                        part[i] = R::combine(
+                            part[i], R::map(src[r * inner + i], shift[i]));
+                for (int64_t i = 0; i < w; ++i)
+                    acc[i] = R::combine(acc[i], part[i]);
+            }
+            T *dst = out + o * inner + i0;
+            for (int64_t i = 0; i < w; ++i)
+                dst[i] = R::finalize(acc[i], len, shift[i]);
+        }
+}
+
+/**
+ * @brief The reduction with the dims of size 1 dropped and the adjacent dims
+ * that are both reduced or both kept merged. Reduced dims next to each other
+ * then make one (outer, reduced, inner) problem, and are reduced along rows
+ * when innermost and strided otherwise. Reduced dims with kept dims between
+ * them take the offsets of the reduced elements from a table.
+ */
+template <typename T, typename R>
+class NaiveReduce : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<ReduceBaseObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        const T *x = input->getRawDataPtr<T *>();
+        T *y = output->getRawDataPtr<T *>();
+        // noop_with_empty_axes
+        if (op->getAxes().empty()) {
+            std::copy_n(x, input->size(), y);
+            return;
+        }
+        const auto &shape = input->getDims();
+        Shape dims;
+        vector<bool> reduced;
+        for (size_t i = 0; i < shape.size(); ++i) {
+            if (shape[i] == 1)
+                continue;
+            const bool r = op->isReduced(i);
+            if (!dims.empty() && reduced.back() == r)
+                dims.back() *= shape[i];
+            else {
+                dims.emplace_back(shape[i]);
+                reduced.emplace_back(r);
+            }
+        }
+        int64_t count = 1;
+        int groups = 0, at = -1;
+        for (size_t i = 0; i < dims.size(); ++i)
+            if (reduced[i]) {
+                count *= dims[i];
+                ++groups;
+                at = i;
+            }
+        // A single reduced group, or none when every reduced dim is 1
+        if (groups <= 1) {
+            int64_t outer = 1, inner = 1;
+            for (int i = 0; i < int(dims.size()); ++i)
+                (i < at || at < 0 ? outer : inner) *= i == at ? 1 : dims[i];
+            if (inner == 1)
+                reduceRows<T, R>(x, y, outer, count);
+            else
+                reduceStrided<T, R>(x, y, outer, count, inner);
+            return;
+        }
+        // Element strides of the kept dims, and offsets of the reduced
+        // elements
+        vector<int64_t> kept, keptStride, offsets{0};
+        int64_t stride = 1;
+        for (int i = dims.size() - 1; i >= 0; --i) {
+            if (reduced[i]) {
+                const size_t n = offsets.size();
+                for (int64_t k = 1; k < dims[i]; ++k)
+                    for (size_t j = 0; j < n; ++j)
+                        offsets.emplace_back(offsets[j] + k * stride);
+            } else {
+                kept.insert(kept.begin(), dims[i]);
+                keptStride.insert(keptStride.begin(), stride);
+            }
+            stride *= dims[i];
+        }
+        const int64_t outputs = output->size();
+#pragma omp parallel for if (outputs * count > chunk)
+        for (int64_t o = 0; o < outputs; ++o) {
+            int64_t base = 0, rest = o;
+            for (int i = kept.size() - 1; i >= 0; --i) {
+                base += rest % kept[i] * keptStride[i];
+                rest /= kept[i];
+            }
+            const T *src = x + base;
+            auto load = [&](int64_t i) { return src[offsets[i]]; };
+            T shift = 0;
+            if constexpr (R::shifted)
+                shift = reduceRange<T, MaxReducer<T>>(load, 0, count, T(0));
+            y[o] = R::finalize(reduceRange<T, R>(load, 0, count, shift), count,
+                               shift);
+        }
+    }
+};
+
+// Float kernels of a reduction, and float and integer kernels of one
+#define REGISTER_FLOAT_REDUCE(type, reducer, name)                             \
+    template <typename T> using Naive##type = NaiveReduce<T, reducer<T>>;      \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Float32,              \
+                    Naive##type<float>, name "Naive_CPU_float32");
+#define REGISTER_REDUCE(type, reducer, name)                                   \
+    REGISTER_FLOAT_REDUCE(type, reducer, name)                                 \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Int32,                \
+                    Naive##type<int32_t>, name "Naive_CPU_int32");             \
+    REGISTER_KERNEL(Device::CPU, OpType::type, DataType::Int64,                \
+                    Naive##type<int64_t>, name "Naive_CPU_int64");
+
+REGISTER_REDUCE(ReduceSum, SumReducer, "reduceSum")
+REGISTER_REDUCE(ReduceMean, MeanReducer, "reduceMean")
+REGISTER_REDUCE(ReduceSumSquare, SumSquareReducer, "reduceSumSquare")
+REGISTER_REDUCE(ReduceL1, L1Reducer, "reduceL1")
+REGISTER_REDUCE(ReduceProd, ProdReducer, "reduceProd")
+REGISTER_REDUCE(ReduceMax, MaxReducer, "reduceMax")
+REGISTER_REDUCE(ReduceMin, MinReducer, "reduceMin")
+REGISTER_FLOAT_REDUCE(ReduceL2, L2Reducer, "reduceL2")
+REGISTER_FLOAT_REDUCE(ReduceLogSum, LogSumReducer, "reduceLogSum")
+REGISTER_FLOAT_REDUCE(ReduceLogSumExp, LogSumExpReducer, "reduceLogSumExp")
+
+} // namespace infini
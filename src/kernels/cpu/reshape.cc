@@ -0,0 +1,35 @@
+#include "operators/reshape.h"
+#include "core/kernel.h"
+#include <cstring>
+
+namespace infini {
+// Only runs when the output was not planned onto the input memory, e.g. with
+// the naive allocator
+class CopyCpu : public CpuKernelWithoutConfig {
+    void compute(const Operator &op,
+                 const RuntimeObj *context) const override {
+        auto inData = op->getInputs(0)->getRawDataPtr<void *>();
+        auto outData = op->getOutput()->getRawDataPtr<void *>();
+        if (inData != outData)
+            std::memcpy(outData, inData, op->getInputs(0)->getBytes());
+    }
+};
+// reshape/flatten/identity all act as copying from input to output.
+REGISTER_KERNEL(Device::CPU, OpType::Reshape, DataType::Float32, CopyCpu,
+                "Reshape_CPU_Float32");
+REGISTER_KERNEL(Device::CPU, OpType::Reshape, DataType::UInt32, CopyCpu,
+                "Reshape_CPU_UInt32");
+REGISTER_KERNEL(Device::CPU, OpType::Reshape, DataType::Int64, CopyCpu,
+                "Reshape_CPU_Int64");
+REGISTER_KERNEL(Device::CPU, OpType::Reshape, DataType::Int32, CopyCpu,
+                "Reshape_CPU_Int32");
+REGISTER_KERNEL(Device::CPU, OpType::Flatten, DataType::Float32, CopyCpu,
+                "Flatten_CPU_Float32");
+REGISTER_KERNEL(Device::CPU, OpType::Flatten, DataType::UInt32, CopyCpu,
+                "Flatten_CPU_UInt32");
+REGISTER_KERNEL(Device::CPU, OpType::Identity, DataType::Float32, CopyCpu,
+                "Identity_CPU_Float32");
+REGISTER_KERNEL(Device::CPU, OpType::Identity, DataType::UInt32, CopyCpu,
+                "Identity_CPU_UInt32");
+
+} // namespace infini
@@ -0,0 +1,50 @@
+#include "core/kernel.h"
+#include "operators/unary.h"
+
+namespace infini {
+
+template <typename T> static void writeDims(const Shape &dims, void *out) {
+    std::copy(dims.begin(), dims.end(), static_cast<T *>(out));
+}
+
+// Shapes that follow the symbols of the graph are not folded into
+// constants, see GraphObj::foldConstants, and are taken when the graph runs
+class NaiveShape : public CpuKernelWithoutConfig {
+    void compute(const Operator &op,
+                 const RuntimeObj *context) const override {
+        auto dims = op->getInputs(0)->getDims();
+        auto output = op->getOutput();
+        auto dtype = output->getDType();
+        void *out = output->getRawDataPtr<void *>();
+        if (dtype == DataType::Int64)
+            writeDims<int64_t>(dims, out);
+        else if (dtype == DataType::Int32)
+            writeDims<int32_t>(dims, out);
+        else if (dtype == DataType::UInt32)
+            writeDims<uint32_t>(dims, out);
+        else if (dtype == DataType::Float32)
+            writeDims<float>(dims, out);
+        else
+            IT_TODO_HALT_MSG("Shape of data type " + dtype.toString());
+    }
+};
+
+#define REGISTER_SHAPE(type, name)                                             \
+    REGISTER_KERNEL(Device::CPU, OpType::Shape, DataType::type, NaiveShape,    \
+                    "ShapeNaive_CPU_" name);
+
+REGISTER_SHAPE(Float32, "float32")
+REGISTER_SHAPE(Float16, "float16")
+REGISTER_SHAPE(BFloat16, "bfloat16")
+REGISTER_SHAPE(Double, "float64")
+REGISTER_SHAPE(Int8, "int8")
+REGISTER_SHAPE(Int16, "int16")
+REGISTER_SHAPE(Int32, "int32")
+REGISTER_SHAPE(Int64, "int64")
+REGISTER_SHAPE(UInt8, "uint8")
+REGISTER_SHAPE(UInt16, "uint16")
+REGISTER_SHAPE(UInt32, "uint32")
+REGISTER_SHAPE(UInt64, "uint64")
+REGISTER_SHAPE(Bool, "bool")
+
+} // namespace infini
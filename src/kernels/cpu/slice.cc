@@ -0,0 +1,73 @@
+#include "operators/slice.h"
+#include "core/kernel.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+// The dims after the last sliced one are copied whole with each row, and so
+// is the run of the last sliced dim if its step is 1. Elements are moved as
+// bytes, so one kernel serves every type.
+class NaiveSlice : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<SliceObj>(_op);
+        auto input = op->getInputs(0), output = op->getOutput();
+        const auto &inDims = input->getDims(), &outDims = output->getDims();
+        const auto starts = op->getStarts(), steps = op->getSteps();
+        // SliceObj clamps the starts for forward steps only
+        for (int step : steps)
+            IT_ASSERT(step > 0, "Negative slice steps are not supported");
+        const int rank = inDims.size();
+        // Byte strides of the input
+        vector<int64_t> inStride(rank);
+        int64_t stride = input->getDType().getSize();
+        for (int i = rank - 1; i >= 0; --i) {
+            inStride[i] = stride;
+            stride *= inDims[i];
+        }
+        int last = rank - 1;
+        while (last >= 0 && starts[last] == 0 && steps[last] == 1 &&
+               outDims[last] == inDims[last])
+            --last;
+        auto src = input->getRawDataPtr<uint8_t *>();
+        auto dst = output->getRawDataPtr<uint8_t *>();
+        if (last < 0)
+            return copyBlocks(src, 0, dst, 0, input->getBytes(), 1);
+        // Rows over the dims before `outer`
+        const int outer = steps[last] == 1 ? last : last + 1;
+        const size_t rowBytes =
+            outer == last ? outDims[last] * inStride[last] : inStride[last];
+        int64_t base = 0;
+        for (int i = 0; i <= last; ++i)
+            base += starts[i] * inStride[i];
+        vector<int64_t> dims(outDims.begin(), outDims.begin() + outer),
+            srcStrides(outer), dstStrides(outer);
+        int64_t d = rowBytes;
+        for (int i = outer - 1; i >= 0; --i) {
+            srcStrides[i] = inStride[i] * steps[i];
+            dstStrides[i] = d;
+            d *= dims[i];
+        }
+        copyRows(src + base, srcStrides, dst, dstStrides, dims, rowBytes);
+    }
+};
+
+#define REGISTER_SLICE(type, name)                                             \
+    REGISTER_KERNEL(Device::CPU, OpType::Slice, DataType::type, NaiveSlice,    \
+                    "SliceNaive_CPU_" name);
+
+REGISTER_SLICE(Float32, "float32")
+REGISTER_SLICE(Float16, "float16")
+REGISTER_SLICE(BFloat16, "bfloat16")
+REGISTER_SLICE(Double, "float64")
+REGISTER_SLICE(Int8, "int8")
+REGISTER_SLICE(Int16, "int16")
+REGISTER_SLICE(Int32, "int32")
+REGISTER_SLICE(Int64, "int64")
+REGISTER_SLICE(UInt8, "uint8")
+REGISTER_SLICE(UInt16, "uint16")
+REGISTER_SLICE(UInt32, "uint32")
+REGISTER_SLICE(UInt64, "uint64")
+REGISTER_SLICE(Bool, "bool")
+
+} // namespace infini
@@ -0,0 +1,131 @@
+#include "operators/softmax.h"
+#include "core/kernel.h"
+#include "cpu/cpu_math.h"
+#include <cmath>
+
+namespace infini {
+
+// Softmax or LogSoftmax of `width` columns side by side, each of `len`
+// elements `stride` apart, so that the innermost loops are contiguous
+template <bool isLog>
+static void softmaxColumns(const float *x, float *y, int len, size_t stride,
+                           int width, float *max, float *sum) {
+    for (int i = 0; i < width; ++i) {
+        max[i] = -INFINITY;
+        sum[i] = 0;
+    }
+    for (int j = 0; j < len; ++j) {
+        const float *xj = x + j * stride;
+#pragma omp simd
+        for (int i = 0; i < width; ++i)
+            max[i] = std::max(max[i], xj[i]);
+    }
+    // A row of -inf stays NaN, as the exact softmax is undefined there
+    for (int j = 0; j < len; ++j) {
+        const float *xj = x + j * stride;
+        float *yj = y + j * stride;
+#pragma omp simd
+        for (int i = 0; i < width; ++i) {
+            float e = expApprox(xj[i] - max[i]);
+            sum[i] += e;
+            if constexpr (!isLog)
+                yj[i] = e;
+        }
+    }
+    if constexpr (isLog) {
+        for (int i = 0; i < width; ++i)
+            max[i] += std::log(sum[i]);
+        for (int j = 0; j < len; ++j) {
+            const float *xj = x + j * stride;
+            float *yj = y + j * stride;
+#pragma omp simd
+            for (int i = 0; i < width; ++i)
+                yj[i] = xj[i] - max[i];
+        }
+    } else {
+        for (int i = 0; i < width; ++i)
+            sum[i] = 1 / sum[i];
+        for (int j = 0; j < len; ++j) {
+            float *yj = y + j * stride;
+#pragma omp simd
+            for (int i = 0; i < width; ++i)
+                yj[i] *= sum[i];
+        }
+    }
+}
+
+// A single contiguous row, with the max and sum reduced across lanes
+template <bool isLog>
+static void softmaxRow(const float *x, float *y, int len) {
+    float max = -INFINITY, sum = 0;
+#pragma omp simd reduction(max : max)
+    for (int j = 0; j < len; ++j)
+        max = std::max(max, x[j]);
+    if constexpr (isLog) {
+#pragma omp simd reduction(+ : sum)
+        for (int j = 0; j < len; ++j)
+            sum += expApprox(x[j] - max);
+        const float shift = max + std::log(sum);
+#pragma omp simd
+        for (int j = 0; j < len; ++j)
+            y[j] = x[j] - shift;
+    } else {
+#pragma omp simd reduction(+ : sum)
+        for (int j = 0; j < len; ++j) {
+            y[j] = expApprox(x[j] - max);
+            sum += y[j];
+        }
+        const float scale = 1 / sum;
+#pragma omp simd
+        for (int j = 0; j < len; ++j)
+            y[j] *= scale;
+    }
+}
+
+// The axis splits the tensor into [outer, len, inner]. Each outer slice is
+// independent, and so is each column of it along inner.
+template <bool isLog> class NativeSoftmax : public CpuKernelWithoutConfig {
+    // The columns of an outer slice handled at a time
+    static constexpr int blockInner = 256;
+
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<SoftmaxObj>(_op);
+        auto dims = op->getInputs(0)->getDims();
+        const int axis = op->getAxis();
+        IT_ASSERT(op->getInputs(0)->getChannelBlock() == 1);
+        size_t outer = 1, inner = 1;
+        for (int i = 0; i < axis; ++i)
+            outer *= dims[i];
+        for (size_t i = axis + 1; i < dims.size(); ++i)
+            inner *= dims[i];
+        const int len = dims[axis];
+        const float *x = op->getInputs(0)->getRawDataPtr<float *>();
+        float *y = op->getOutput()->getRawDataPtr<float *>();
+        if (inner == 1) {
+#pragma omp parallel for if (outer * len > 4096)
+            for (size_t o = 0; o < outer; ++o)
+                softmaxRow<isLog>(x + o * len, y + o * len, len);
+            return;
+        }
+        const size_t blocks = (inner + blockInner - 1) / blockInner;
+#pragma omp parallel for collapse(2) if (outer * len * inner > 4096)
+        for (size_t o = 0; o < outer; ++o) {
+            for (size_t b = 0; b < blocks; ++b) {
+                float max[blockInner], sum[blockInner];
+                size_t offset = o * len * inner + b * blockInner;
+                int width =
+                    std::min<size_t>(blockInner, inner - b * blockInner);
+                softmaxColumns<isLog>(x + offset, y + offset, len, inner,
+                                      width, max, sum);
+            }
+        }
+    }
+};
+
+REGISTER_KERNEL(Device::CPU, OpType::Softmax, DataType::Float32,
+                NativeSoftmax<false>, "Softmax_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::LogSoftmax, DataType::Float32,
+                NativeSoftmax<true>, "LogSoftmax_CPU_float32");
+
+} // namespace infini
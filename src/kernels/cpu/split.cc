@@ -1,50 +1,52 @@
 #include "operators/split.h"
 #include "core/kernel.h"
+#include "cpu/cpu_copy.h"
 
 namespace infini {
 
-template <typename T> class NaiveSplit : public CpuKernelWithoutConfig {
+// Each output is a run of contiguous bytes in every outer block of the input,
+// copied as a whole. Elements are moved as bytes, so one kernel serves every
+// type.
+class NaiveSplit : public CpuKernelWithoutConfig {
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<SplitObj>(_op);
-        auto inputs = op->getInputs(), outputs = op->getOutputs();
-        auto dim = op->getDim();
-        auto input = inputs[0];
+        auto input = op->getInputs(0);
         const auto &inDim = input->getDims();
-        std::vector<Shape> outDims;
-        for (auto output : outputs)
-            outDims.emplace_back(output->getDims());
-        size_t blockOffsetInner = 1;
-        for (size_t i = inDim.size() - 1; i > (size_t)dim; --i)
-            blockOffsetInner *= inDim[i];
-        size_t blockOffset = inDim[dim] * blockOffsetInner;
-        for (size_t i = 0; i < outputs.size(); ++i) {
-            auto output = outputs[i];
-            auto dimOffset = 0;
-            auto outDim = outDims[i];
-            for (size_t j = 0; j < i; ++j)
-                dimOffset += outDims[j][dim];
-            size_t localBlockOffset = 1;
-            for (size_t i = outDim.size() - 1;
-                 i >= (size_t)dim && i != (size_t)-1; --i)
-                localBlockOffset *= outDim[i];
-            auto innerOffset = blockOffsetInner * dimOffset;
-            auto outSize = output->size();
-            auto inPtr = input->getRawDataPtr<T *>(),
-                 outPtr = output->getRawDataPtr<T *>();
-#pragma omp parallel for
-            for (size_t oOffset = 0; oOffset < outSize; ++oOffset) {
-                auto iOffset = oOffset % localBlockOffset + innerOffset +
-                               oOffset / localBlockOffset * blockOffset;
-                outPtr[oOffset] = inPtr[iOffset];
-            }
+        const int dim = op->getDim();
+        size_t outer = 1, inner = input->getDType().getSize();
+        for (int i = 0; i < dim; ++i)
+            outer *= inDim[i];
+        for (size_t i = dim + 1; i < inDim.size(); ++i)
+            inner *= inDim[i];
+        const size_t blockBytes = inDim[dim] * inner;
+        auto inPtr = input->getRawDataPtr<uint8_t *>();
+        size_t offset = 0;
+        for (auto &output : op->getOutputs()) {
+            const size_t run = output->getDims()[dim] * inner;
+            copyBlocks(inPtr + offset, blockBytes,
+                       output->getRawDataPtr<uint8_t *>(), run, run, outer);
+            offset += run;
         }
     }
 };
 
-REGISTER_KERNEL(Device::CPU, OpType::Split, DataType::UInt32,
-                NaiveSplit<uint32_t>, "SplitNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Split, DataType::Float32,
-                NaiveSplit<float>, "SplitNaive_CPU_float32");
+#define REGISTER_SPLIT(type, name)                                             \
+    REGISTER_KERNEL(Device::CPU, OpType::Split, DataType::type, NaiveSplit,    \
+                    "SplitNaive_CPU_" name);
+
+REGISTER_SPLIT(Float32, "float32")
+REGISTER_SPLIT(Float16, "float16")
+REGISTER_SPLIT(BFloat16, "bfloat16")
+REGISTER_SPLIT(Double, "float64")
+REGISTER_SPLIT(Int8, "int8")
+REGISTER_SPLIT(Int16, "int16")
+REGISTER_SPLIT(Int32, "int32")
+REGISTER_SPLIT(Int64, "int64")
+REGISTER_SPLIT(UInt8, "uint8")
+REGISTER_SPLIT(UInt16, "uint16")
+REGISTER_SPLIT(UInt32, "uint32")
+REGISTER_SPLIT(UInt64, "uint64")
+REGISTER_SPLIT(Bool, "bool")
 
 } // namespace infini
@@ -1,17 +1,230 @@
 #include "operators/transpose.h"
 #include "core/kernel.h"
+#include <algorithm>
+#include <cstring>
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
 
 namespace infini {
 
-inline Shape idx2Pos(const Shape &shape, size_t idx) {
-    Shape pos = Shape(shape.size(), 0);
-    auto rest = idx, curDimId = shape.size() - 1;
-    while (rest > 0) {
-        pos[curDimId] = rest % shape[curDimId];
-        rest /= shape[curDimId];
-        curDimId--;
+// Copy an NCHW tensor between two channel-blocked layouts, see
+// TensorObj::getChannelBlock. The channels are walked in groups of the larger
+// block, so that the blocked side is accessed contiguously.
+template <typename T>
+static void reorderChannels(const T *src, int srcBlock, T *dst, int dstBlock,
+                            const Shape &dims) {
+    const int n = dims[0], c = dims[1], group = std::max(srcBlock, dstBlock);
+    const int64_t hw = (int64_t)dims[2] * dims[3];
+#pragma omp parallel for collapse(2)
+    for (int nn = 0; nn < n; ++nn)
+        for (int g = 0; g < c / group; ++g) {
+            const int64_t base = ((int64_t)nn * c + g * group) * hw;
+            const T *s = src + base;
+            T *d = dst + base;
+            if (srcBlock == 1) {
+                for (int64_t p = 0; p < hw; ++p)
+                    for (int l = 0; l < group; ++l)
+                        d[p * group + l] = s[l * hw + p];
+            } else if (dstBlock == 1) {
+                for (int l = 0; l < group; ++l)
+                    for (int64_t p = 0; p < hw; ++p)
+                        d[l * hw + p] = s[p * group + l];
+            } else {
+                for (int64_t p = 0; p < hw; ++p)
+                    for (int l = 0; l < group; ++l)
+                        d[(l / dstBlock * hw + p) * dstBlock + l % dstBlock] =
+                            s[(l / srcBlock * hw + p) * srcBlock +
+                              l % srcBlock];
+            }
+        }
+}
+
+// Drop the dims of size 1 and merge the input axes that stay adjacent and in
+// order in the output. A permute that keeps its last axis then moves whole
+// rows, and [0, 2, 1, 3] of [b, m, n, d] is a batch of [m, n] transposes of
+// d-element rows.
+static void canonicalize(Shape &dims, vector<int> &perm) {
+    vector<int> index(dims.size(), -1), kept;
+    for (size_t i = 0; i < dims.size(); ++i)
+        if (dims[i] != 1) {
+            index[i] = kept.size();
+            kept.emplace_back(dims[i]);
+        }
+    vector<int> p;
+    for (int axis : perm)
+        if (index[axis] >= 0)
+            p.emplace_back(index[axis]);
+    // Runs of consecutive input axes in the output order
+    vector<vector<int>> runs;
+    for (size_t j = 0; j < p.size(); ++j)
+        if (j > 0 && p[j] == p[j - 1] + 1)
+            runs.back().emplace_back(p[j]);
+        else
+            runs.push_back({p[j]});
+    vector<int> order(runs.size());
+    for (size_t r = 0; r < runs.size(); ++r)
+        order[r] = r;
+    std::sort(order.begin(), order.end(),
+              [&](int a, int b) { return runs[a][0] < runs[b][0]; });
+    dims.clear();
+    perm.assign(runs.size(), 0);
+    for (size_t i = 0; i < order.size(); ++i) {
+        int size = 1;
+        for (int axis : runs[order[i]])
+            size *= kept[axis];
+        dims.emplace_back(size);
+        perm[order[i]] = i;
+    }
+}
+
+// dst[j * ldd + i] = src[i * lds + j] for a rows x cols tile
+template <typename T>
+static void transposeTile(const T *src, int64_t lds, T *dst, int64_t ldd,
+                          int rows, int cols) {
+    for (int j = 0; j < cols; ++j)
+        for (int i = 0; i < rows; ++i)
+            dst[j * ldd + i] = src[i * lds + j];
+}
+
+#if defined(__x86_64__) && defined(__GNUC__)
+// An 8x8 tile of 4-byte elements transposed in AVX registers
+__attribute__((target("avx"))) static void
+transposeTile8x8(const uint32_t *src, int64_t lds, uint32_t *dst,
+                 int64_t ldd) {
+    const float *s = reinterpret_cast<const float *>(src);
+    float *d = reinterpret_cast<float *>(dst);
+    __m256 r[8], t[8];
+    for (int i = 0; i < 8; ++i)
+        r[i] = _mm256_loadu_ps(s + i * lds);
+    for (int i = 0; i < 8; i += 2) {
+        t[i] = _mm256_unpacklo_ps(r[i], r[i + 1]);
+        t[i + 1] = _mm256_unpackhi_ps(r[i], r[i + 1]);
+    }
+    for (int i = 0; i < 8; i += 4) {
+        r[i] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 1] = _mm256_shuffle_ps(t[i], t[i + 2], _MM_SHUFFLE(3, 2, 3, 2));
+        r[i + 2] =
+            _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(1, 0, 1, 0));
+        r[i + 3] =
+            _mm256_shuffle_ps(t[i + 1], t[i + 3], _MM_SHUFFLE(3, 2, 3, 2));
+    }
+    for (int i = 0; i < 4; ++i) {
+        _mm256_storeu_ps(d + i * ldd,
+                         _mm256_permute2f128_ps(r[i], r[i + 4], 0x20));
+        _mm256_storeu_ps(d + (i + 4) * ldd,
+                         _mm256_permute2f128_ps(r[i], r[i + 4], 0x31));
+    }
+}
+#endif
+
+// Whether full 8x8 tiles of T go through transposeTile8x8
+template <typename T> static bool hasTile8x8() {
+#if defined(__x86_64__) && defined(__GNUC__)
+    static const bool avx = __builtin_cpu_supports("avx");
+    return sizeof(T) == 4 && avx;
+#else
+    return false;
+#endif
+}
+
+// The output of a canonical permute whose last axis is kept, as rows copied
+// from the input
+template <typename T>
+static void transposeRows(const T *src, T *dst, const Shape &dims,
+                          const vector<int> &perm) {
+    const int outer = perm.size() - 1;
+    const int64_t len = dims.back();
+    // Input strides of the output axes
+    vector<int64_t> inStride(dims.size()), stride(outer);
+    inStride.back() = 1;
+    for (int i = dims.size() - 2; i >= 0; --i)
+        inStride[i] = inStride[i + 1] * dims[i + 1];
+    int64_t rows = 1;
+    for (int j = 0; j < outer; ++j) {
+        stride[j] = inStride[perm[j]];
+        rows *= dims[perm[j]];
+    }
+    const int64_t rowsPerChunk = std::max<int64_t>(1, 16384 / len);
+#pragma omp parallel for if (rows * len > 16384)
+    for (int64_t r0 = 0; r0 < rows; r0 += rowsPerChunk) {
+        vector<int64_t> index(outer);
+        int64_t offset = 0, r = r0;
+        for (int j = outer - 1; j >= 0; --j) {
+            index[j] = r % dims[perm[j]];
+            r /= dims[perm[j]];
+            offset += index[j] * stride[j];
+        }
+        const int64_t r1 = std::min(rows, r0 + rowsPerChunk);
+        for (r = r0; r < r1; ++r) {
+            std::memcpy(dst + r * len, src + offset, len * sizeof(T));
+            for (int j = outer - 1; j >= 0; --j) {
+                offset += stride[j];
+                if (++index[j] < dims[perm[j]])
+                    break;
+                offset -= stride[j] * dims[perm[j]];
+                index[j] = 0;
+            }
+        }
+    }
+}
+
+// The output of a canonical permute that moves the last axis, as a batch of
+// 2D transposes between the input's last axis and the output's, in tiles
+template <typename T>
+static void transposeTiled(const T *src, T *dst, const Shape &dims,
+                           const vector<int> &perm) {
+    constexpr int tile = 8;
+    const int rank = dims.size();
+    vector<int64_t> inStride(rank), outStride(rank);
+    inStride.back() = outStride.back() = 1;
+    for (int i = rank - 2; i >= 0; --i) {
+        inStride[i] = inStride[i + 1] * dims[i + 1];
+        outStride[i] = outStride[i + 1] * dims[perm[i + 1]];
+    }
+    // Input axis a is the output's last, and the input's last axis is at
+    // output position k
+    const int a = perm.back(), b = rank - 1;
+    const int k = std::find(perm.begin(), perm.end(), b) - perm.begin();
+    const int64_t rowsA = dims[a], colsB = dims[b], lds = inStride[a],
+                  ldd = outStride[k];
+    // The other axes, with their input and output strides
+    vector<int64_t> batchDims, batchIn, batchOut;
+    for (int j = 0; j < rank; ++j)
+        if (perm[j] != a && perm[j] != b) {
+            batchDims.emplace_back(dims[perm[j]]);
+            batchIn.emplace_back(inStride[perm[j]]);
+            batchOut.emplace_back(outStride[j]);
+        }
+    int64_t batches = 1;
+    for (auto d : batchDims)
+        batches *= d;
+    const int64_t blocks = (rowsA + tile - 1) / tile;
+    [[maybe_unused]] const bool simd = hasTile8x8<T>();
+#pragma omp parallel for if (batches * rowsA * colsB > 16384)
+    for (int64_t w = 0; w < batches * blocks; ++w) {
+        int64_t bi = w / blocks, inOff = 0, outOff = 0;
+        for (int j = batchDims.size() - 1; j >= 0; --j) {
+            inOff += bi % batchDims[j] * batchIn[j];
+            outOff += bi % batchDims[j] * batchOut[j];
+            bi /= batchDims[j];
+        }
+        const int64_t i0 = w % blocks * tile;
+        const int rows = std::min<int64_t>(tile, rowsA - i0);
+        const T *s = src + inOff + i0 * lds;
+        T *d = dst + outOff + i0;
+        for (int64_t j0 = 0; j0 < colsB; j0 += tile) {
+            const int cols = std::min<int64_t>(tile, colsB - j0);
+#if defined(__x86_64__) && defined(__GNUC__)
+            if constexpr (sizeof(T) == 4)
+                if (simd && rows == tile && cols == tile) {
+                    transposeTile8x8(s + j0, lds, d + j0 * ldd, ldd);
+                    continue;
+                }
+#endif
+            transposeTile(s + j0, lds, d + j0 * ldd, ldd, rows, cols);
+        }
     }
-    return pos;
 }
 
 template <typename T> class NaiveTranspose : public CpuKernelWithoutConfig {
@@ -21,25 +234,44 @@ template <typename T> class NaiveTranspose : public CpuKernelWithoutConfig {
         auto inputs = op->getInputs(), outputs = op->getOutputs();
         const auto &inDim = inputs[0]->getDims();
         const auto &perm = op->getPermute();
+        // Nothing to move, and no row length to divide by
+        if (inputs[0]->size() == 0)
+            return;
+        const int inBlock = inputs[0]->getChannelBlock(),
+                  outBlock = outputs[0]->getChannelBlock();
+        if (inBlock != 1 || outBlock != 1) {
+            // A layout conversion, which keeps the logical element order
+            IT_ASSERT(perm == vector<int>({0, 1, 2, 3}),
+                      "Blocked layouts only support the identity permute.");
+            return reorderChannels(inputs[0]->getRawDataPtr<T *>(), inBlock,
+                                   outputs[0]->getRawDataPtr<T *>(), outBlock,
+                                   inDim);
+        }
 
-        size_t inSize = inputs[0]->size();
         auto inPtr = inputs[0]->getRawDataPtr<T *>(),
              outPtr = outputs[0]->getRawDataPtr<T *>();
-        // #pragma omp parallel for
-        for (size_t inIdx = 0; inIdx < inSize; ++inIdx) {
-            auto posInput = idx2Pos(inDim, inIdx);
-            int outIdx = 0;
-            for (size_t j = 0, jEnd = perm.size(); j < jEnd; ++j) {
-                outIdx = outIdx * inDim[perm[j]] + posInput[perm[j]];
-            }
-            outPtr[outIdx] = inPtr[inIdx];
-        }
+        Shape dims = inDim;
+        auto canonical = perm;
+        canonicalize(dims, canonical);
+        if (dims.size() <= 1)
+            std::memcpy(outPtr, inPtr, inputs[0]->size() * sizeof(T));
+        else if (canonical.back() == int(dims.size()) - 1)
+            transposeRows(inPtr, outPtr, dims, canonical);
+        else
+            transposeTiled(inPtr, outPtr, dims, canonical);
     }
 };
 
+// Elements are moved as raw bits, so a kernel serves every type of its size
 REGISTER_KERNEL(Device::CPU, OpType::Transpose, DataType::UInt32,
                 NaiveTranspose<uint32_t>, "TransposeNaive_CPU_uint32");
 REGISTER_KERNEL(Device::CPU, OpType::Transpose, DataType::Float32,
-                NaiveTranspose<float>, "TransposeNaive_CPU_float32");
+                NaiveTranspose<uint32_t>, "TransposeNaive_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, DataType::Int32,
+                NaiveTranspose<uint32_t>, "TransposeNaive_CPU_int32");
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, DataType::Int64,
+                NaiveTranspose<uint64_t>, "TransposeNaive_CPU_int64");
+REGISTER_KERNEL(Device::CPU, OpType::Transpose, DataType::Float16,
+                NaiveTranspose<uint16_t>, "TransposeNaive_CPU_float16");
 
 } // namespace infini
@@ -1,128 +1,171 @@
 #include "operators/unary.h"
 #include "core/constants.h"
 #include "core/kernel.h"
+#include "cpu/cpu_math.h"
 
 namespace infini {
-template <typename T> class NativeUnary : public CpuKernelWithoutConfig {
-    virtual T doCompute(T val) const = 0;
-    void compute(const Operator &_op,
-                 const RuntimeObj *context) const override {
-        auto op = as<UnaryObj>(_op);
-        T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
-        T *outptr = op->getOutput()->getRawDataPtr<T *>();
+template <typename T, typename F>
+static void unaryMap(const T *x, T *y, size_t n, F f) {
+#pragma omp simd
+    for (size_t i = 0; i < n; ++i)
+        y[i] = f(x[i]);
+}
 
-        auto outDim = op->getOutput()->getDims();
-        auto n = op->getOutput()->size();
-        for (size_t offset = 0; offset < n; offset++) {
-            outptr[offset] = doCompute(inptr[offset]);
-        }
-    }
-};
+// Unary kernels compute whole ranges, so that their function inlines into a
+// vectorized loop instead of being a call per element
+template <typename T> class NativeUnary : public CpuKernelWithoutConfig {
+    // Elements per call, and per thread at a time
+    static constexpr size_t chunk = 16384;
 
-template <typename T> class NaiveSoftmax : public CpuKernelWithoutConfig {
+    virtual void doCompute(const T *x, T *y, size_t n) const = 0;
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<UnaryObj>(_op);
         T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
         T *outptr = op->getOutput()->getRawDataPtr<T *>();
 
-        auto outDim = op->getOutput()->getDims();
-        auto n = op->getOutput()->size();
-        auto sum = T(0);
-        for (size_t offset = 0; offset < n; offset++) {
-            sum += pow(E_CONSTANT, inptr[offset]);
-        }
-        for (size_t offset = 0; offset < n; offset++) {
-            outptr[offset] = pow(E_CONSTANT, inptr[offset]) / sum;
-        }
+        const size_t n = op->getOutput()->size();
+#pragma omp parallel for if (n > chunk)
+        for (size_t start = 0; start < n; start += chunk)
+            doCompute(inptr + start, outptr + start,
+                      std::min(chunk, n - start));
     }
 };
 
 template <typename T> class NaiveRelu : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::max(T(0), val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::max(T(0), val); });
+    }
 };
 template <typename T> class NaiveSigmoid : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return 1 / (1 + pow(E_CONSTANT, -val));
+    void doCompute(const T *x, T *y, size_t n) const override {
+        if constexpr (std::is_same_v<T, float>)
+            vecSigmoid(x, y, n);
+        else
+            unaryMap(x, y, n,
+                     [](T val) { return 1 / (1 + pow(E_CONSTANT, -val)); });
     }
 };
 template <typename T> class NaiveHardSigmoid : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return std::max(T(0), std::min(T(1), T(0.2) * val + T(0.5)));
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) {
+            return std::max(T(0), std::min(T(1), T(0.2) * val + T(0.5)));
+        });
     }
 };
 template <typename T> class NaiveHardSwish : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return val *
-               std::max(T(0), std::min(T(1), val * T(1.0 / 6.0) + T(0.5)));
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) {
+            return val * std::max(T(0), std::min(T(1), val * T(1.0 / 6.0) +
+                                                           T(0.5)));
+        });
     }
 };
 template <typename T> class NaiveTanh : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return (pow(E_CONSTANT, val) - pow(E_CONSTANT, -val)) /
-               (pow(E_CONSTANT, val) + pow(E_CONSTANT, -val));
+    void doCompute(const T *x, T *y, size_t n) const override {
+        if constexpr (std::is_same_v<T, float>)
+            vecTanh(x, y, n);
+        else
+            unaryMap(x, y, n, [](T val) {
+                return (pow(E_CONSTANT, val) - pow(E_CONSTANT, -val)) /
+                       (pow(E_CONSTANT, val) + pow(E_CONSTANT, -val));
+            });
     }
 };
 template <typename T> class NaiveAbs : public NativeUnary<T> {
-    T doCompute(T val) const override { return val < 0 ? -val : val; }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return val < 0 ? -val : val; });
+    }
 };
 
 template <typename T> class NaiveSqrt : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::sqrt(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::sqrt(val); });
+    }
 };
 
 template <typename T> class NaiveCos : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::cos(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::cos(val); });
+    }
 };
 
 template <typename T> class NaiveSin : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::sin(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::sin(val); });
+    }
 };
 
 template <typename T> class NaiveTan : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::tan(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::tan(val); });
+    }
 };
 
 template <typename T> class NaiveSinh : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::sinh(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::sinh(val); });
+    }
 };
 
 template <typename T> class NaiveCosh : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::cosh(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::cosh(val); });
+    }
 };
 
 template <typename T> class NaiveGelu : public NativeUnary<T> {
-    T doCompute(T val) const override {
-        return 0.5 * val * (1 + std::erf(val / std::sqrt(2)));
+    void doCompute(const T *x, T *y, size_t n) const override {
+        vecGelu(x, y, n);
     }
 };
 
 template <typename T> class NaiveErf : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::erf(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        vecErf(x, y, n);
+    }
+};
+
+template <typename T> class NaiveExp : public NativeUnary<T> {
+    void doCompute(const T *x, T *y, size_t n) const override {
+        vecExp(x, y, n);
+    }
 };
 
 template <typename T> class NaiveACos : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::acos(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::acos(val); });
+    }
 };
 
 template <typename T> class NaiveACosh : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::acosh(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::acosh(val); });
+    }
 };
 
 template <typename T> class NaiveASin : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::asin(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::asin(val); });
+    }
 };
 
 template <typename T> class NaiveASinh : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::asinh(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::asinh(val); });
+    }
 };
 
 template <typename T> class NaiveATanh : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::atanh(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::atanh(val); });
+    }
 };
 
 template <typename T> class NaiveNeg : public NativeUnary<T> {
-    T doCompute(T val) const override { return -val; }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return -val; });
+    }
 };
 
 template <typename T> class Clip : public CpuKernelWithoutConfig {
@@ -145,40 +188,45 @@ template <typename T> class Clip : public CpuKernelWithoutConfig {
 };
 
 template <typename T> class Log : public CpuKernelWithoutConfig {
+    static constexpr size_t chunk = 16384;
+
     void compute(const Operator &_op,
                  const RuntimeObj *context) const override {
         auto op = as<LogObj>(_op);
         T *inptr = op->getInputs(0)->getRawDataPtr<T *>();
         T *outptr = op->getOutput()->getRawDataPtr<T *>();
-        auto logType = op->getType(); // get log type
-
-        auto len = op->getOutput()->size();
-        for (size_t offset = 0; offset < len; offset++) {
-            T res;
-            auto val = *inptr++;
-            switch (logType) {
-            case LogObj::LogE:
-                res = std::log(val);
-                *outptr++ = res;
-                break;
-            case LogObj::Log2:
-                res = std::log2(val);
-                *outptr++ = res;
-                break;
-            case LogObj::Log10:
-                res = std::log10(val);
-                *outptr++ = res;
-                break;
-            default:
-                printf("LogType not Defined");
-                break;
-            }
+        const size_t n = op->getOutput()->size();
+        auto forChunks = [&](auto f) {
+#pragma omp parallel for if (n > chunk)
+            for (size_t start = 0; start < n; start += chunk)
+                f(inptr + start, outptr + start, std::min(chunk, n - start));
+        };
+        // Other bases call the library, which is exact at the powers of the
+        // base
+        switch (op->getType()) {
+        case LogObj::LogE:
+            forChunks([](const T *x, T *y, size_t len) { vecLog(x, y, len); });
+            break;
+        case LogObj::Log2:
+            forChunks([](const T *x, T *y, size_t len) {
+                unaryMap(x, y, len, [](T val) { return std::log2(val); });
+            });
+            break;
+        case LogObj::Log10:
+            forChunks([](const T *x, T *y, size_t len) {
+                unaryMap(x, y, len, [](T val) { return std::log10(val); });
+            });
+            break;
+        default:
+            IT_TODO_HALT_MSG("LogType not Defined");
         }
     }
 };
 
 template <typename T> class NaiveATan : public NativeUnary<T> {
-    T doCompute(T val) const override { return std::atan(val); }
+    void doCompute(const T *x, T *y, size_t n) const override {
+        unaryMap(x, y, n, [](T val) { return std::atan(val); });
+    }
 };
 
 REGISTER_KERNEL(Device::CPU, OpType::Relu, DataType::UInt32,
@@ -209,12 +257,10 @@ REGISTER_KERNEL(Device::CPU, OpType::Sqrt, DataType::Float32, NaiveSqrt<float>,
                 "sqrtNaive_CPU_float32");
 REGISTER_KERNEL(Device::CPU, OpType::Erf, DataType::Float32, NaiveErf<float>,
                 "erfNaive_CPU_float32");
+REGISTER_KERNEL(Device::CPU, OpType::Exp, DataType::Float32, NaiveExp<float>,
+                "expNaive_CPU_float32");
 REGISTER_KERNEL(Device::CPU, OpType::Neg, DataType::Float32, NaiveNeg<float>,
                 "negNaive_CPU_float32");
-REGISTER_KERNEL(Device::CPU, OpType::Softmax, DataType::UInt32,
-                NaiveSoftmax<uint32_t>, "softmaxNaive_CPU_uint32");
-REGISTER_KERNEL(Device::CPU, OpType::Softmax, DataType::Float32,
-                NaiveSoftmax<float>, "softmaxNaive_CPU_float32");
 REGISTER_KERNEL(Device::CPU, OpType::Clip, DataType::Float32, Clip<float>,
                 "Clip_CPU_float32");
 REGISTER_KERNEL(Device::CPU, OpType::Atan, DataType::Float32, NaiveATan<float>,
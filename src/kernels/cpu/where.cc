@@ -0,0 +1,64 @@
+#include "operators/where.h"
+#include "core/kernel.h"
+#include "cpu/cpu_broadcast.h"
+#include "cpu/cpu_copy.h"
+
+namespace infini {
+
+// z[i] = c[i * sc] ? x[i * sx] : y[i * sy] for i < len. Rows reading every
+// input in full, the common case, get a loop of their own, which vectorizes
+// into blends.
+template <typename T>
+static void selectRow(const uint8_t *c, const T *x, const T *y, T *z,
+                      int64_t len, int64_t sc, int64_t sx, int64_t sy) {
+    if (sc && sx && sy) {
+#pragma omp simd
+        for (int64_t i = 0; i < len; ++i)
+            z[i] = c[i] ? x[i] : y[i];
+    } else {
+#pragma omp simd
+        for (int64_t i = 0; i < len; ++i)
+            z[i] = c[i * sc] ? x[i * sx] : y[i * sy];
+    }
+}
+
+template <typename T> class NaiveWhere : public CpuKernelWithoutConfig {
+    void compute(const Operator &_op,
+                 const RuntimeObj *context) const override {
+        auto op = as<WhereObj>(_op);
+        auto inputX = op->getInputs(0), inputY = op->getInputs(1),
+             condition = op->getInputs(2);
+        IT_ASSERT(condition->getDType().getSize() == 1,
+                  "The condition of Where should be bool.");
+        auto x = inputX->getRawDataPtr<T *>();
+        auto y = inputY->getRawDataPtr<T *>();
+        auto c = condition->getRawDataPtr<uint8_t *>();
+        auto z = op->getOutput()->getRawDataPtr<T *>();
+        BroadcastPlan plan(op->getOutput()->getDims(),
+                           {inputX->getDims(), inputY->getDims(),
+                            condition->getDims()});
+        if (plan.dims.empty())
+            return selectRow(c, x, y, z, 1, 1, 1, 1);
+        const int64_t len = plan.dims.back();
+        const int64_t sx = plan.strides[0].back(), sy = plan.strides[1].back(),
+                      sc = plan.strides[2].back();
+        // A single row is split instead
+        if (plan.rows() == 1) {
+            constexpr int64_t chunk = 16384;
+#pragma omp parallel for if (len > chunk)
+            for (int64_t start = 0; start < len; start += chunk)
+                selectRow(c + start * sc, x + start * sx, y + start * sy,
+                          z + start, std::min(chunk, len - start), sc, sx,
+                          sy);
+            return;
+        }
+        forEachRow(plan, [&](int64_t r, const int64_t *offsets) {
+            selectRow(c + offsets[2], x + offsets[0], y + offsets[1],
+                      z + r * len, len, sc, sx, sy);
+        });
+    }
+};
+
+REGISTER_KERNEL_BY_SIZE(Where, NaiveWhere, "WhereNaive")
+
+} // namespace infini
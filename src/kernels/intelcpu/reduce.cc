@@ -1,6 +1,6 @@
 #include "intelcpu/mkl_kernel_without_config.h"
 #include "intelcpu/mkl_runtime.h"
-#include "operators/reduce_mean.h"
+#include "operators/reduce.h"
 
 namespace infini {
 class MklReduce : public MklKernelWithoutConfig {
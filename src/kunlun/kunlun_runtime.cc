@@ -12,6 +12,9 @@ void KUNLUNRuntimeObj::runWithoutSync(const Graph &graph, bool tune = false,
     std::map<OpType, double> opTime;
     std::map<OpType, int> opCnt;
     for (auto &op : graph->getOperators()) {
+        // Views planned onto the memory of their input have nothing to do
+        if (op->isAliasedView())
+            continue;
         // HACK: set correct data type
         auto kernelAttrs =
             KernelAttrs{device, op->getOpType().underlying(), op->getDType()};
@@ -0,0 +1,75 @@
+#include "operators/attention.h"
+#include "utils/operator_utils.h"
+#include <cstring>
+
+namespace infini {
+
+AttentionObj::AttentionObj(GraphObj *graph, Tensor query, Tensor key,
+                           Tensor value, Tensor output, float scale,
+                           bool transK, Tensor mask)
+    : OperatorObj(OpType::Attention,
+                  mask ? TensorVec{query, key, value, mask}
+                       : TensorVec{query, key, value},
+                  {output}),
+      scale(scale), transK(transK) {
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+AttentionObj::inferShape(const TensorVec &inputs) const {
+    auto q = inputs[0]->getDims(), k = inputs[1]->getDims(),
+         v = inputs[2]->getDims();
+    int rank = q.size();
+    if (rank < 2 || (int)k.size() != rank || (int)v.size() != rank ||
+        !std::equal(q.begin(), q.end() - 2, k.begin()) ||
+        !std::equal(q.begin(), q.end() - 2, v.begin()))
+        return {};
+    int dim = transK ? k[rank - 2] : k[rank - 1];
+    int seqK = transK ? k[rank - 1] : k[rank - 2];
+    if (dim != q[rank - 1] || seqK != v[rank - 2])
+        return {};
+    Shape scores = q;
+    scores[rank - 1] = seqK;
+    if (inputs.size() > 3) {
+        auto mask = inputs[3]->getDims();
+        if ((int)mask.size() > rank || infer_broadcast(scores, mask) != scores)
+            return {};
+    }
+    Shape ret = q;
+    ret[rank - 1] = v[rank - 1];
+    return {{ret}};
+}
+
+std::string AttentionObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << vecToString(inputs[1]->getDims()) << ",";
+    os << "scale=" << scale << ",";
+    os << "transK=" << transK << ",";
+    os << "query=" << inputs[0]->getGuid() << ",";
+    os << "key=" << inputs[1]->getGuid() << ",";
+    os << "value=" << inputs[2]->getGuid() << ",";
+    if (auto mask = getMask())
+        os << "mask=" << mask->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> AttentionObj::getWorkloadVector() const {
+    vector<int> ret = getOpAttrVector();
+    for (auto &input : inputs) {
+        auto dims = input->getDims();
+        ret.insert(ret.end(), dims.begin(), dims.end());
+    }
+    return ret;
+}
+
+vector<int> AttentionObj::getOpAttrVector() const {
+    int scaleBits;
+    std::memcpy(&scaleBits, &scale, sizeof(scale));
+    return {type.underlying(), scaleBits, transK, getMask() != nullptr};
+}
+
+} // namespace infini
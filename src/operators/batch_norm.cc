@@ -57,6 +57,13 @@ std::string BatchNormObj::toString() const {
 }
 
 // need eps and momentum?
+// The statistics are updated from the input when training
+vector<int> BatchNormObj::getInplaceInputs() const {
+    if (trainingMode)
+        return {};
+    return {0};
+}
+
 vector<int> BatchNormObj::getWorkloadVector() const {
     vector<int> ret = inputs[0]->getDims();
     ret.emplace(ret.begin(), type.underlying());
@@ -36,7 +36,10 @@ string ConvBaseObj::toString() const {
 }
 
 vector<int> ConvBaseObj::getWorkloadVector() const {
-    return {type.underlying(), n, c, h, w, f, r, s, ph, pw, sh, sw, dh, dw};
+    // The weight channels tell grouped and depthwise convs from dense ones,
+    // and the channel block the layouts, which take different algorithms
+    return {type.underlying(), n, c, h, w, f, r, s, ph, pw, sh, sw, dh, dw,
+            int(inputs[1]->getDims()[1]), inputs[0]->getChannelBlock()};
 }
 
 vector<int> ConvBaseObj::getOpAttrVector() const {
@@ -63,10 +66,10 @@ void ConvObj::setAuxilaryAttributes(PaddingMode mode) {
 ConvObj::ConvObj(GraphObj *graph, Tensor input, Tensor weight, Tensor output,
                  int ph, int pw, int sh, int sw, int dh, int dw, Tensor bias,
                  ActType act)
-    : ConvBaseObj(OpType::Conv, {input, weight}, output, ph, pw, sh, sw, dh, dw,
-                  input, weight, act) {
-    if (bias)
-        IT_TODO_HALT();
+    : ConvBaseObj(OpType::Conv,
+                  bias ? TensorVec{input, weight, bias}
+                       : TensorVec{input, weight},
+                  output, ph, pw, sh, sw, dh, dw, input, weight, act) {
     setAuxilaryAttributes(PaddingMode::Other);
     IT_ASSERT(checkValid(graph));
 }
@@ -74,10 +77,10 @@ ConvObj::ConvObj(GraphObj *graph, Tensor input, Tensor weight, Tensor output,
 ConvObj::ConvObj(GraphObj *graph, Tensor input, Tensor weight, Tensor output,
                  PaddingMode mode, int sh, int sw, int dh, int dw, Tensor bias,
                  ActType act)
-    : ConvBaseObj(OpType::Conv, {input, weight}, output, mode, sh, sw, dh, dw,
-                  input, weight, act) {
-    if (bias)
-        IT_TODO_HALT();
+    : ConvBaseObj(OpType::Conv,
+                  bias ? TensorVec{input, weight, bias}
+                       : TensorVec{input, weight},
+                  output, mode, sh, sw, dh, dw, input, weight, act) {
     setAuxilaryAttributes(mode);
     IT_ASSERT(checkValid(graph));
 }
@@ -94,6 +97,9 @@ optional<vector<Shape>> ConvObj::inferShape(const TensorVec &inputs) const {
     int oh = 0, ow = 0;
     // For NCHW+FCRS layout, C of input is divisable by C of weight
     IT_ASSERT(input->getDims()[1] % weight->getDims()[1] == 0);
+    // Bias holds one value per output channel
+    if (inputs.size() > 2 && (int)inputs[2]->size() != f)
+        return {};
     // Set padding size
     if (padding == PaddingMode::Other) {
         oh = (h - (r - sh) * dh + ph * 2) / sh;
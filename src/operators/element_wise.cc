@@ -27,6 +27,15 @@ std::string ElementWiseObj::toString() const {
     return os.str();
 }
 
+// Broadcast inputs are read more than once
+vector<int> ElementWiseObj::getInplaceInputs() const {
+    vector<int> ret;
+    for (int i = 0; i < 2; ++i)
+        if (inputs[i]->getDims() == outputs[0]->getDims())
+            ret.emplace_back(i);
+    return ret;
+}
+
 // use output dim or inputs dim?
 vector<int> ElementWiseObj::getWorkloadVector() const {
     vector<int> ret = outputs[0]->getDims();
@@ -14,6 +14,16 @@ optional<vector<Shape>> ExpandObj::inferShape(const TensorVec &inputs) const {
     return {{ret}};
 }
 
+// The dims the input was not broadcast along follow its new size
+void ExpandObj::updateShapeAttributes(const vector<Shape> &oldInputShapes) {
+    const auto &oldDims = oldInputShapes.at(0);
+    const auto newDims = inputs[0]->getDims();
+    int offset = (int)dims.size() - (int)oldDims.size();
+    for (int i = std::max(0, -offset); i < (int)oldDims.size(); ++i)
+        if (oldDims[i] != newDims[i] && dims[i + offset] == oldDims[i])
+            dims[i + offset] = newDims[i];
+}
+
 std::string ExpandObj::toString() const {
     std::ostringstream os;
     os << "Expand[" << getGuid() << "]";
@@ -0,0 +1,91 @@
+#include "operators/fused_element_wise.h"
+
+namespace infini {
+FusedElementWiseObj::FusedElementWiseObj(GraphObj *graph, TensorVec inputs,
+                                         Tensor output, vector<Step> steps)
+    : OperatorObj(OpType::FusedElementWise, inputs, {output}),
+      steps(std::move(steps)) {
+    IT_ASSERT(!this->steps.empty());
+    for (auto &step : this->steps) {
+        IT_ASSERT(isFusable(step.type));
+        IT_ASSERT(step.type.isBinary() == (step.input >= 0));
+        IT_ASSERT(step.input < (int)inputs.size());
+    }
+    IT_ASSERT(checkValid(graph));
+}
+
+bool FusedElementWiseObj::isFusable(OpType type) {
+    switch (type.underlying()) {
+    case OpType::Add:
+    case OpType::Sub:
+    case OpType::Mul:
+    case OpType::Div:
+    case OpType::Relu:
+    case OpType::Sigmoid:
+    case OpType::Tanh:
+    case OpType::HardSigmoid:
+    case OpType::HardSwish:
+    case OpType::Gelu:
+    case OpType::Erf:
+    case OpType::Abs:
+    case OpType::Sqrt:
+    case OpType::Neg:
+        return true;
+    default:
+        return false;
+    }
+}
+
+optional<vector<Shape>>
+FusedElementWiseObj::inferShape(const TensorVec &inputs) const {
+    auto dims = inputs[0]->getDims();
+    for (auto &input : inputs)
+        if (input->getDims() != dims && input->size() != 1)
+            return {};
+    return {{dims}};
+}
+
+std::string FusedElementWiseObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(outputs[0]->getDims()) << ",";
+    for (auto &step : steps) {
+        os << step.type.toString();
+        if (step.input >= 0)
+            os << (step.reversed ? "<" : ">") << step.input;
+        os << ",";
+    }
+    for (size_t i = 0; i < inputs.size(); ++i)
+        os << "input" << i << "=" << inputs[i]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+// Single element operands are read for every tile
+vector<int> FusedElementWiseObj::getInplaceInputs() const {
+    vector<int> ret;
+    for (int i = 0; i < (int)inputs.size(); ++i)
+        if (inputs[i]->getDims() == outputs[0]->getDims())
+            ret.emplace_back(i);
+    return ret;
+}
+
+vector<int> FusedElementWiseObj::getWorkloadVector() const {
+    vector<int> ret = getOpAttrVector();
+    auto dims = outputs[0]->getDims();
+    ret.insert(ret.end(), dims.begin(), dims.end());
+    return ret;
+}
+
+vector<int> FusedElementWiseObj::getOpAttrVector() const {
+    vector<int> ret = {type.underlying()};
+    for (auto &step : steps) {
+        ret.emplace_back(step.type.underlying());
+        ret.emplace_back(step.input);
+        ret.emplace_back(step.reversed);
+    }
+    return ret;
+}
+
+} // namespace infini
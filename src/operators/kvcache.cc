@@ -0,0 +1,105 @@
+#include "operators/kvcache.h"
+
+namespace infini {
+
+static bool isPosition(const Tensor &position) {
+    return position->size() == 1 &&
+           (position->getDType() == DataType::Int32 ||
+            position->getDType() == DataType::Int64);
+}
+
+KVCacheAppendObj::KVCacheAppendObj(GraphObj *graph, Tensor cache,
+                                   Tensor input, Tensor position,
+                                   Tensor output)
+    : OperatorObj(OpType::KVCacheAppend, {cache, input, position}, {output}) {
+    IT_ASSERT(cache->isKVCache(), "Appending to a tensor that is no KV cache");
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+KVCacheAppendObj::inferShape(const TensorVec &inputs) const {
+    auto cache = inputs[0]->getDims(), rows = inputs[1]->getDims();
+    int rank = cache.size();
+    if (rank < 2 || (int)rows.size() != rank || !isPosition(inputs[2]) ||
+        !(inputs[0]->getDType() == inputs[1]->getDType()))
+        return {};
+    for (int i = 0; i < rank; ++i)
+        if (i == rank - 2 ? rows[i] > cache[i] : rows[i] != cache[i])
+            return {};
+    return {{cache}};
+}
+
+std::string KVCacheAppendObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << vecToString(inputs[1]->getDims()) << ",";
+    os << "cache=" << inputs[0]->getGuid() << ",";
+    os << "input=" << inputs[1]->getGuid() << ",";
+    os << "position=" << inputs[2]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> KVCacheAppendObj::getWorkloadVector() const {
+    vector<int> ret = getOpAttrVector();
+    for (int i = 0; i < 2; ++i) {
+        auto dims = inputs[i]->getDims();
+        ret.insert(ret.end(), dims.begin(), dims.end());
+    }
+    return ret;
+}
+
+vector<int> KVCacheAppendObj::getOpAttrVector() const {
+    return {type.underlying()};
+}
+
+AttentionKVCacheObj::AttentionKVCacheObj(GraphObj *graph, Tensor query,
+                                         Tensor keyCache, Tensor valueCache,
+                                         Tensor position, Tensor output)
+    : OperatorObj(OpType::AttentionKVCache,
+                  {query, keyCache, valueCache, position}, {output}) {
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+AttentionKVCacheObj::inferShape(const TensorVec &inputs) const {
+    auto q = inputs[0]->getDims(), k = inputs[1]->getDims(),
+         v = inputs[2]->getDims();
+    if (q.size() != 4 || k.size() != 4 || k != v || !isPosition(inputs[3]))
+        return {};
+    if (q[0] != k[0] || k[1] == 0 || q[1] % k[1] != 0 || q[2] > k[2] ||
+        q[3] != k[3])
+        return {};
+    return {{q}};
+}
+
+std::string AttentionKVCacheObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << vecToString(inputs[1]->getDims()) << ",";
+    os << "query=" << inputs[0]->getGuid() << ",";
+    os << "keyCache=" << inputs[1]->getGuid() << ",";
+    os << "valueCache=" << inputs[2]->getGuid() << ",";
+    os << "position=" << inputs[3]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> AttentionKVCacheObj::getWorkloadVector() const {
+    vector<int> ret = getOpAttrVector();
+    for (int i = 0; i < 2; ++i) {
+        auto dims = inputs[i]->getDims();
+        ret.insert(ret.end(), dims.begin(), dims.end());
+    }
+    return ret;
+}
+
+vector<int> AttentionKVCacheObj::getOpAttrVector() const {
+    return {type.underlying()};
+}
+
+} // namespace infini
@@ -0,0 +1,108 @@
+#include "operators/layer_norm.h"
+#include "utils/operator_utils.h"
+#include <cstring>
+
+namespace infini {
+
+bool isNormalizedShape(const Shape &dims, int axis, const Tensor &param) {
+    auto p = param->getDims();
+    size_t size = 1;
+    for (size_t i = axis; i < dims.size(); ++i)
+        size *= dims[i];
+    return p.size() <= dims.size() - axis && param->size() == size &&
+           std::equal(p.rbegin(), p.rend(), dims.rbegin());
+}
+
+static int floatBits(float value) {
+    int bits;
+    std::memcpy(&bits, &value, sizeof(value));
+    return bits;
+}
+
+LayerNormObj::LayerNormObj(GraphObj *graph, Tensor input, Tensor scale,
+                           Tensor output, Tensor bias, float eps, int axis)
+    : OperatorObj(OpType::LayerNormalization,
+                  bias ? TensorVec{input, scale, bias}
+                       : TensorVec{input, scale},
+                  {output}),
+      eps(eps), axis(get_real_axis(axis, input->getRank())) {
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+LayerNormObj::inferShape(const TensorVec &inputs) const {
+    auto dims = inputs[0]->getDims();
+    for (size_t i = 1; i < inputs.size(); ++i)
+        if (!isNormalizedShape(dims, axis, inputs[i]) ||
+            !(inputs[i]->getDType() == inputs[0]->getDType()))
+            return {};
+    return {{dims}};
+}
+
+std::string LayerNormObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << "axis=" << axis << ",";
+    os << "eps=" << eps << ",";
+    os << "input=" << inputs[0]->getGuid() << ",";
+    os << "scale=" << inputs[1]->getGuid() << ",";
+    if (auto bias = getBias())
+        os << "bias=" << bias->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> LayerNormObj::getWorkloadVector() const {
+    vector<int> ret = getOpAttrVector();
+    auto dims = inputs[0]->getDims();
+    ret.insert(ret.end(), dims.begin(), dims.end());
+    return ret;
+}
+
+vector<int> LayerNormObj::getOpAttrVector() const {
+    return {type.underlying(), axis, floatBits(eps), getBias() != nullptr};
+}
+
+RMSNormObj::RMSNormObj(GraphObj *graph, Tensor input, Tensor weight,
+                       Tensor output, float eps, int axis)
+    : OperatorObj(OpType::RMSNorm, {input, weight}, {output}), eps(eps),
+      axis(get_real_axis(axis, input->getRank())) {
+    IT_ASSERT(checkValid(graph));
+}
+
+optional<vector<Shape>>
+RMSNormObj::inferShape(const TensorVec &inputs) const {
+    auto dims = inputs[0]->getDims();
+    if (!isNormalizedShape(dims, axis, inputs[1]) ||
+        !(inputs[1]->getDType() == inputs[0]->getDType()))
+        return {};
+    return {{dims}};
+}
+
+std::string RMSNormObj::toString() const {
+    std::ostringstream os;
+    os << type.toString() << "[" << getGuid() << "]";
+    os << "(";
+    os << vecToString(inputs[0]->getDims()) << ",";
+    os << "axis=" << axis << ",";
+    os << "eps=" << eps << ",";
+    os << "input=" << inputs[0]->getGuid() << ",";
+    os << "weight=" << inputs[1]->getGuid() << ",";
+    os << "output=" << outputs[0]->getGuid() << ")";
+    return os.str();
+}
+
+vector<int> RMSNormObj::getWorkloadVector() const {
+    vector<int> ret = getOpAttrVector();
+    auto dims = inputs[0]->getDims();
+    ret.insert(ret.end(), dims.begin(), dims.end());
+    return ret;
+}
+
+vector<int> RMSNormObj::getOpAttrVector() const {
+    return {type.underlying(), axis, floatBits(eps)};
+}
+
+} // namespace infini
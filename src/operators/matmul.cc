@@ -9,10 +9,15 @@ MatmulObj::MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C, bool transA,
     : OperatorObj(OpType::MatMul,
                   bias ? TensorVec{A, B, bias} : TensorVec{A, B}, {C}),
       transA(transA), transB(transB), act(act), b(1) {
-    auto shape_a = A->getDims();
-    auto shape_b = B->getDims();
-    int rankA = A->getRank();
-    int rankB = B->getRank();
+    updateShapeAttributes({});
+    IT_ASSERT(checkValid(graph));
+}
+
+void MatmulObj::updateShapeAttributes(const vector<Shape> &) {
+    auto shape_a = inputs[0]->getDims();
+    auto shape_b = inputs[1]->getDims();
+    int rankA = inputs[0]->getRank();
+    int rankB = inputs[1]->getRank();
     IT_ASSERT(rankA >= 2 && rankB >= 2);
     Shape shape_a1(shape_a.begin(), shape_a.begin() + (rankA - 2));
     Shape shape_b1(shape_b.begin(), shape_b.begin() + (rankB - 2));
@@ -28,7 +33,6 @@ MatmulObj::MatmulObj(GraphObj *graph, Tensor A, Tensor B, Tensor C, bool transA,
     m = *(transA ? shape_a.rbegin() : shape_a.rbegin() + 1);
     n = *(transB ? shape_b.rbegin() + 1 : shape_b.rbegin());
     k = kA;
-    IT_ASSERT(checkValid(graph));
 }
 
 string MatmulObj::toString() const {
@@ -12,6 +12,11 @@ PoolingObj::PoolingObj(GraphObj *graph, OpType optype, Tensor input,
     IT_ASSERT(checkValid(graph));
 }
 
+void PoolingObj::updateShapeAttributes(const vector<Shape> &) {
+    auto dims = inputs[0]->getDims();
+    n = dims[0], c = dims[1], h = dims[2], w = dims[3];
+}
+
 optional<vector<Shape>> PoolingObj::inferShape(const TensorVec &inputs) const {
     const auto &input = inputs[0];
     auto h = input->getDims()[input->getRank() - 2],
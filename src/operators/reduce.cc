@@ -1,28 +1,31 @@
-#include "operators/reduce_mean.h"
+#include "operators/reduce.h"
 #include "utils/operator_utils.h"
 
 namespace infini {
-ReduceMeanObj::ReduceMeanObj(GraphObj *graph, Tensor input, Tensor output,
-                             const optional<vector<int>> &_axes, bool keepDims)
-    : OperatorObj(OpType::ReduceMean, {input}, {output}), keepDims(keepDims) {
+ReduceBaseObj::ReduceBaseObj(OpType type, GraphObj *graph, Tensor input,
+                             Tensor output, const optional<vector<int>> &_axes,
+                             bool keepDims, bool noopWithEmptyAxes)
+    : OperatorObj(type, {input}, {output}), keepDims(keepDims) {
+    IT_ASSERT(type.underlying() >= OpType::ReduceL1 &&
+              type.underlying() <= OpType::ReduceSumSquare);
     const auto size = input->getRank();
-    if (_axes) {
+    if (_axes && !_axes->empty()) {
         for (auto idx : *_axes) {
             idx = get_real_axis(idx, size);
             axes.emplace(idx);
         }
-    } else
+    } else if (!noopWithEmptyAxes)
         for (size_t i = 0; i < size; ++i)
             axes.emplace(i);
     IT_ASSERT(checkValid(graph));
 }
 
-bool ReduceMeanObj::isReduced(int idx) const {
+bool ReduceBaseObj::isReduced(int idx) const {
     return axes.find(idx) != axes.end();
 }
 
 optional<vector<Shape>>
-ReduceMeanObj::inferShape(const TensorVec &inputs) const {
+ReduceBaseObj::inferShape(const TensorVec &inputs) const {
     auto dims = inputs[0]->getDims();
     auto rank = inputs[0]->getRank();
 
@@ -44,10 +47,9 @@ ReduceMeanObj::inferShape(const TensorVec &inputs) const {
     }
 }
 
-std::string ReduceMeanObj::toString() const {
+std::string ReduceBaseObj::toString() const {
     std::ostringstream os;
-    os << "ReduceMean"
-       << "[" << getGuid() << "]";
+    os << type.toString() << "[" << getGuid() << "]";
     os << "(";
     os << vecToString(inputs[0]->getDims()) << ",";
 
@@ -67,7 +69,7 @@ std::string ReduceMeanObj::toString() const {
     return os.str();
 }
 
-vector<int> ReduceMeanObj::getWorkloadVector() const {
+vector<int> ReduceBaseObj::getWorkloadVector() const {
     vector<int> ret = inputs[0]->getDims();
     ret.emplace(ret.begin(), type.underlying());
     ret.emplace_back((int)keepDims);
@@ -75,7 +77,7 @@ vector<int> ReduceMeanObj::getWorkloadVector() const {
     return ret;
 }
 
-vector<int> ReduceMeanObj::getOpAttrVector() const {
+vector<int> ReduceBaseObj::getOpAttrVector() const {
     vector<int> ret = {type.underlying(), (int)keepDims};
     ret.insert(ret.end(), axes.begin(), axes.end());
     return ret;
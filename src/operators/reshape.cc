@@ -17,6 +17,46 @@ optional<vector<Shape>> ReshapeObj::inferShape(const TensorVec &inputs) const {
     return {{dims}};
 }
 
+// The input dims are grouped with the output dims they were reshaped into. A
+// group whose input size changed passes the change on to its only output
+// dim, or to the one equal to a changed input dim, or else to the last one it
+// divides evenly.
+void ReshapeObj::updateShapeAttributes(const vector<Shape> &oldInputShapes) {
+    const auto &oldDims = oldInputShapes.at(0);
+    const auto newDims = inputs[0]->getDims();
+    size_t i = 0, j = 0;
+    while (i < oldDims.size() && j < dims.size()) {
+        size_t i0 = i, j0 = j;
+        int64_t a = oldDims[i++], b = dims[j++];
+        while (a != b) {
+            if (a < b && i < oldDims.size())
+                a *= oldDims[i++];
+            else if (b < a && j < dims.size())
+                b *= dims[j++];
+            else
+                break;
+        }
+        IT_ASSERT(a == b);
+        int64_t newA = 1;
+        for (size_t c = i0; c < i; ++c)
+            newA *= newDims[c];
+        if (newA == a)
+            continue;
+        size_t k = j;
+        for (size_t c = i0; c < i && k == j; ++c)
+            if (newDims[c] != oldDims[c])
+                for (size_t d = j0; d < j && k == j; ++d)
+                    if (dims[d] == oldDims[c])
+                        k = d;
+        for (size_t d = j; d > j0 && k == j; --d)
+            if (dims[d - 1] * newA % a == 0)
+                k = d - 1;
+        IT_ASSERT(k < j, "Can not reshape " + vecToString(newDims) +
+                             " like " + vecToString(oldDims));
+        dims[k] = dims[k] * newA / a;
+    }
+}
+
 std::string ReshapeObj::toString() const {
     std::ostringstream os;
     os << "Reshape[" << getGuid() << "]";
@@ -5,61 +5,63 @@ SliceObj::SliceObj(GraphObj *graph, Tensor input, Tensor output,
                    const vector<int> &starts, const vector<int> &ends,
                    const optional<vector<int>> &_axes,
                    const optional<vector<int>> &_steps)
-    : OperatorObj(OpType::Slice, {input}, {output}) {
+    : OperatorObj(OpType::Slice, {input}, {output}), starts(starts),
+      ends(ends) {
     auto shape = input->getDims(); // shape of input
-    map<size_t, size_t> axes;
-    vector<int> steps;
-    {
-        auto size = starts.size();      // size of starts
-        IT_ASSERT(size == ends.size()); // size of ends
-
-        if (_axes) {
-            IT_ASSERT(size == _axes->size());
-            // onnx doc: "Behavior is undefined if an axis is repeated."
-            IT_ASSERT(size == std::set(_axes->begin(), _axes->end()).size());
+    auto size = starts.size();      // size of starts
+    IT_ASSERT(size == ends.size()); // size of ends
 
-            for (size_t i = 0; i < size; ++i) {
-                auto index = _axes->at(i);
-                if (index < 0)
-                    index += shape.size();
-                axes[index] = i;
-            }
-        } else
-            for (size_t i = 0; i < size; ++i)
-                axes[i] = i;
+    sliceOf.assign(shape.size(), -1);
+    if (_axes) {
+        IT_ASSERT(size == _axes->size());
+        // onnx doc: "Behavior is undefined if an axis is repeated."
+        IT_ASSERT(size == std::set(_axes->begin(), _axes->end()).size());
 
-        if (_steps) {
-            IT_ASSERT(size == _steps->size());
-            // onnx doc: "‘steps’ cannot be 0."
-            IT_ASSERT(std::find(_steps->begin(), _steps->end(), 0) ==
-                      _steps->end());
-            steps = *_steps;
-        } else {
-            steps.reserve(size);
-            for (size_t i = 0; i < size; ++i)
-                steps.push_back(1);
+        for (size_t i = 0; i < size; ++i) {
+            auto index = _axes->at(i);
+            if (index < 0)
+                index += shape.size();
+            sliceOf.at(index) = i;
         }
+    } else
+        for (size_t i = 0; i < size; ++i)
+            sliceOf.at(i) = i;
+
+    if (_steps) {
+        IT_ASSERT(size == _steps->size());
+        // onnx doc: "‘steps’ cannot be 0."
+        IT_ASSERT(std::find(_steps->begin(), _steps->end(), 0) ==
+                  _steps->end());
+        steps = *_steps;
+    } else {
+        steps.reserve(size);
+        for (size_t i = 0; i < size; ++i)
+            steps.push_back(1);
     }
 
-    auto size = shape.size();
-    this->axes.reserve(size);
-    for (size_t i = 0; i < size; ++i) {
+    updateShapeAttributes({});
+    IT_ASSERT(checkValid(graph));
+}
+
+void SliceObj::updateShapeAttributes(const vector<Shape> &) {
+    auto shape = inputs[0]->getDims();
+    axes.clear();
+    axes.reserve(shape.size());
+    for (size_t i = 0; i < shape.size(); ++i) {
         auto len = shape[i];
-        if (auto _i = axes.find(i); _i != axes.end()) {
-            auto __i = _i->second;
-            auto start = starts[__i];
-            auto end = ends[__i];
+        if (int j = sliceOf[i]; j >= 0) {
+            auto start = starts[j];
+            auto end = ends[j];
             if (start > len)
                 start = len;
             if (end > len)
                 end = len;
-            this->axes.push_back({start >= 0 ? start : start + len,
-                                  end >= 0 ? end : end + len, steps[__i]});
+            axes.push_back({start >= 0 ? start : start + len,
+                            end >= 0 ? end : end + len, steps[j]});
         } else {
-            this->axes.push_back({0, len, 1});
+            axes.push_back({0, len, 1});
         }
     }
-    IT_ASSERT(checkValid(graph));
 }
 
 optional<vector<Shape>> SliceObj::inferShape(const TensorVec &inputs) const {
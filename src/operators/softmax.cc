@@ -3,13 +3,21 @@
 
 namespace infini {
 
-SoftmaxObj::SoftmaxObj(GraphObj *graph, Tensor input, Tensor output, int _axis)
-    : OperatorObj(OpType::Softmax, {input}, {output}) {
+SoftmaxObj::SoftmaxObj(OpType type, GraphObj *graph, Tensor input,
+                       Tensor output, int _axis)
+    : OperatorObj(type, {input}, {output}) {
     int rank = input->getRank();
     axis = get_real_axis(_axis, rank);
     IT_ASSERT(checkValid(graph));
 }
 
+SoftmaxObj::SoftmaxObj(GraphObj *graph, Tensor input, Tensor output, int axis)
+    : SoftmaxObj(OpType::Softmax, graph, input, output, axis) {}
+
+LogSoftmaxObj::LogSoftmaxObj(GraphObj *graph, Tensor input, Tensor output,
+                             int axis)
+    : SoftmaxObj(OpType::LogSoftmax, graph, input, output, axis) {}
+
 std::string SoftmaxObj::toString() const {
     std::ostringstream os;
     os << type.toString() << "[" << getGuid() << "]";
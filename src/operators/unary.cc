@@ -252,6 +252,16 @@ std::string ShapeObj::toString() const {
     return os.str();
 }
 
+// The output holds the dims of the input, which is what the kernel reads
+vector<int> ShapeObj::getWorkloadVector() const {
+    vector<int> ret{type.underlying()};
+    const Shape shape = inputs[0]->getDims();
+    ret.insert(ret.end(), shape.begin(), shape.end());
+    return ret;
+}
+
+vector<int> ShapeObj::getOpAttrVector() const { return {type.underlying()}; }
+
 PReluObj::PReluObj(GraphObj *graph, Tensor input, Tensor alpha, Tensor output)
     : OperatorObj(OpType::PRelu, {input, alpha}, {output}) {
     IT_ASSERT(checkValid(graph));
@@ -24,7 +24,8 @@ Shape infer_broadcast(const Shape &A, const Shape &B) {
     Shape ret;
     for (int i = 0; i < rank; ++i) {
         IT_ASSERT(A_[i] == B_[i] || A_[i] == 1 || B_[i] == 1);
-        auto shapeEle = std::max(A_[i], B_[i]);
+        // A dim of 1 takes the other, 0 included
+        auto shapeEle = A_[i] == 1 ? B_[i] : A_[i];
         ret.emplace_back(shapeEle);
     }
     return ret;
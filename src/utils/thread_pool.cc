@@ -0,0 +1,94 @@
+#include "utils/thread_pool.h"
+#include "core/common.h"
+
+namespace infini {
+
+// The index of the pool worker running on this thread, if any
+static thread_local const ThreadPool *currentPool = nullptr;
+static thread_local int currentWorker = -1;
+
+ThreadPool::ThreadPool(int threads, std::function<void(int)> init) {
+    IT_ASSERT(threads > 0);
+    for (int i = 0; i < threads; ++i)
+        queues.emplace_back(std::make_unique<Queue>());
+    for (int i = 0; i < threads; ++i)
+        workers.emplace_back([this, i, init] {
+            currentPool = this;
+            currentWorker = i;
+            if (init)
+                init(i);
+            work(i);
+        });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto &worker : workers)
+        worker.join();
+}
+
+void ThreadPool::submit(Task task) {
+    const bool inside = currentPool == this;
+    size_t index = inside ? currentWorker : next++ % queues.size();
+    {
+        // Counted before it is queued, so that `queued` never underflows.
+        // Pairs with the check of `queued` before a worker sleeps.
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        ++queued;
+    }
+    {
+        // Tasks from outside queue up at the front, which the worker serves
+        // last and so in the order of submission
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        if (inside)
+            queues[index]->tasks.emplace_back(std::move(task));
+        else
+            queues[index]->tasks.emplace_front(std::move(task));
+    }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::pop(int index, Task &task) {
+    // The newest task of the own queue, whose inputs are likely in cache
+    {
+        auto &queue = *queues[index];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+    // Otherwise the oldest task of another queue
+    for (size_t i = 1; i < queues.size(); ++i) {
+        auto &queue = *queues[(index + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(int index) {
+    while (true) {
+        Task task;
+        if (pop(index, task)) {
+            --queued;
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0)
+            return;
+    }
+}
+
+} // namespace infini
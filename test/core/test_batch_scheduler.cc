@@ -0,0 +1,132 @@
+#include "core/batch_scheduler.h"
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+#include <random>
+
+#include "test.h"
+
+namespace infini {
+
+// y = relu(x) + x, with a batch of `batch` rows of 8 floats
+static BatchScheduler::Bucket makeBucket(Runtime runtime, int batch) {
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({batch, 8}, DataType::Float32);
+    auto relu = g->addOp<ReluObj>(x, nullptr);
+    auto add = g->addOp<AddObj>(relu->getOutput(), x, nullptr);
+    g->dataMalloc();
+    return {g, {x}, {add->getOutput()}};
+}
+
+static BatchScheduler::Sample makeSample(float seed) {
+    vector<float> x(8);
+    for (int i = 0; i < 8; ++i)
+        x[i] = seed + i - 4;
+    auto bytes = reinterpret_cast<const uint8_t *>(x.data());
+    return {vector<uint8_t>(bytes, bytes + sizeof(float) * 8)};
+}
+
+static bool checkSample(float seed, const BatchScheduler::Sample &outputs) {
+    if (outputs.size() != 1 || outputs[0].size() != sizeof(float) * 8)
+        return false;
+    auto y = reinterpret_cast<const float *>(outputs[0].data());
+    for (int i = 0; i < 8; ++i) {
+        float x = seed + i - 4;
+        if (y[i] != std::max(x, 0.f) + x)
+            return false;
+    }
+    return true;
+}
+
+TEST(BatchScheduler, coalesce) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    BatchScheduler scheduler(
+        {makeBucket(runtime, 4), makeBucket(runtime, 1),
+         makeBucket(runtime, 2)},
+        std::chrono::milliseconds(200));
+    EXPECT_EQ(scheduler.getMaxBatchSize(), 4);
+    EXPECT_EQ(scheduler.getInputBytes(), vector<size_t>{32});
+    // A full batch starts at once, the rest waits for the delay and runs on
+    // the bucket of 4
+    vector<std::shared_future<BatchScheduler::Sample>> futures;
+    for (int i = 0; i < 7; ++i)
+        futures.emplace_back(scheduler.submit(makeSample(i)));
+    for (int i = 0; i < 7; ++i)
+        EXPECT_TRUE(checkSample(i, futures[i].get()));
+    EXPECT_EQ(scheduler.getQueueDepth(), 0u);
+    EXPECT_EQ(scheduler.getBatchCounts(), (vector<uint64_t>{0, 0, 0, 1, 1}));
+    auto latency = scheduler.getLatency();
+    EXPECT_EQ(latency.total, 7u);
+    // The last three waited for the delay
+    EXPECT_GE(latency.percentile(1), 200000);
+    EXPECT_THROW(scheduler.submit({vector<uint8_t>(4)}), Exception);
+}
+
+TEST(BatchScheduler, share_weights) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    // y = x * w, where the last bucket is built with other weights
+    vector<BatchScheduler::Bucket> buckets;
+    vector<Tensor> weights;
+    for (int batch : {1, 2, 4}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor x = g->addTensor({batch, 8}, DataType::Float32);
+        Tensor w = g->addTensor({1, 8}, DataType::Float32);
+        w->setWeight();
+        auto mul = g->addOp<MulObj>(x, w, nullptr);
+        g->dataMalloc();
+        w->copyin(vector<float>(8, batch == 4 ? 3 : 2));
+        buckets.push_back({g, {x}, {mul->getOutput()}});
+        weights.emplace_back(w);
+    }
+    BatchScheduler scheduler(std::move(buckets),
+                             std::chrono::microseconds(100));
+    EXPECT_EQ(weights[1]->getRawDataPtr<void *>(),
+              weights[0]->getRawDataPtr<void *>());
+    EXPECT_NE(weights[2]->getRawDataPtr<void *>(),
+              weights[0]->getRawDataPtr<void *>());
+    auto outputs = scheduler.submit(makeSample(4)).get();
+    auto y = reinterpret_cast<const float *>(outputs[0].data());
+    for (int i = 0; i < 8; ++i)
+        EXPECT_EQ(y[i], 2.f * i);
+}
+
+TEST(BatchScheduler, load_generator) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    vector<BatchScheduler::Bucket> buckets;
+    for (int batch : {1, 2, 4, 8})
+        buckets.emplace_back(makeBucket(runtime, batch));
+    BatchScheduler scheduler(std::move(buckets),
+                             std::chrono::microseconds(500));
+    // Clients sending requests one after another at random intervals
+    const int clients = 8, requests = 50;
+    vector<int> correct(clients, 0);
+    vector<std::thread> threads;
+    for (int c = 0; c < clients; ++c)
+        threads.emplace_back([&, c] {
+            std::mt19937 rng(c);
+            std::uniform_int_distribution<int> pause(0, 200);
+            for (int r = 0; r < requests; ++r) {
+                float seed = c * requests + r;
+                auto future = scheduler.submit(makeSample(seed));
+                correct[c] += checkSample(seed, future.get());
+                std::this_thread::sleep_for(
+                    std::chrono::microseconds(pause(rng)));
+            }
+        });
+    for (auto &thread : threads)
+        thread.join();
+    for (int c = 0; c < clients; ++c)
+        EXPECT_EQ(correct[c], requests);
+    auto counts = scheduler.getBatchCounts();
+    uint64_t served = 0;
+    for (size_t n = 0; n < counts.size(); ++n)
+        served += n * counts[n];
+    EXPECT_EQ(served, uint64_t(clients * requests));
+    auto latency = scheduler.getLatency();
+    EXPECT_EQ(latency.total, uint64_t(clients * requests));
+    EXPECT_LE(latency.percentile(0.5), latency.percentile(0.99));
+    EXPECT_EQ(scheduler.getQueueDepth(), 0u);
+}
+
+} // namespace infini
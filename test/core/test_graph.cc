@@ -3,8 +3,10 @@
 #include "core/runtime.h"
 #include "operators/element_wise.h"
 #include "operators/matmul.h"
+#include "operators/reshape.h"
 #include "operators/unary.h"
 #include "test.h"
+#include <thread>
 
 namespace infini {
 
@@ -149,4 +151,252 @@ TEST(Graph, test_OpVec_ctor) {
     }
 }
 
+TEST(Graph, fold_constants) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({1, 2, 3}, DataType::UInt32);
+    Tensor w0 = g->addTensor({3, 4}, DataType::UInt32);
+    Tensor w1 = g->addTensor({3, 4}, DataType::UInt32);
+    w0->setWeight();
+    w1->setWeight();
+    auto add = g->addOp<AddObj>(w0, w1, nullptr);
+    auto reshape =
+        g->addOp<ReshapeObj>(add->getOutput(), nullptr, Shape{1, 3, 4});
+    auto matmul = g->addOp<MatmulObj>(i0, reshape->getOutput(), nullptr);
+    // Scales a second input by the shape of the first
+    Tensor i1 = g->addTensor({3}, DataType::UInt32);
+    auto shape = g->addOp<ShapeObj>(i0, nullptr);
+    auto mul = g->addOp<MulObj>(i1, shape->getOutput(), nullptr);
+    g->dataMalloc();
+    i0->copyin(vector<uint32_t>{1, 2, 3, 4, 5, 6});
+    w0->copyin(vector<uint32_t>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11});
+    w1->setData(OneGenerator());
+    auto output = matmul->getOutput();
+    EXPECT_TRUE(g->foldConstants());
+    EXPECT_TRUE(g->checkValid());
+    // Only the ops reading graph inputs remain
+    EXPECT_EQ(g->getOperators().size(), 2u);
+    auto folded = matmul->getInputs(1);
+    EXPECT_TRUE(folded->isWeight());
+    EXPECT_EQ(folded->getSource(), nullptr);
+    EXPECT_EQ(folded->getDims(), (Shape{1, 3, 4}));
+    EXPECT_TRUE(folded->equalData(
+        vector<uint32_t>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}));
+    EXPECT_TRUE(mul->getInputs(1)->isWeight());
+    EXPECT_TRUE(mul->getInputs(1)->equalData(vector<uint32_t>{1, 2, 3}));
+    EXPECT_FALSE(g->foldConstants());
+    i1->copyin(vector<uint32_t>{3, 2, 1});
+    runtime->run(g);
+    EXPECT_TRUE(mul->getOutput()->equalData(vector<uint32_t>{3, 4, 3}));
+    EXPECT_TRUE(
+        output->equalData(vector<uint32_t>{38, 44, 50, 56, 83, 98, 113, 128}));
+}
+
+TEST(Graph, eliminate_dead_code) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({2, 3}, DataType::Float32);
+    auto relu = g->addOp<ReluObj>(i0, nullptr);
+    auto sigmoid = g->addOp<SigmoidObj>(i0, nullptr);
+    g->addOp<TanhObj>(sigmoid->getOutput(), nullptr);
+    // Without marked outputs every result is kept
+    EXPECT_FALSE(g->eliminateDeadCode());
+    EXPECT_EQ(g->getOperators().size(), 3u);
+    relu->getOutput()->setOutput();
+    EXPECT_TRUE(g->eliminateDeadCode());
+    EXPECT_TRUE(g->checkValid());
+    EXPECT_EQ(g->getOperators(), (OpVec{relu}));
+    EXPECT_EQ(g->getTensors().size(), 2u);
+    EXPECT_FALSE(g->eliminateDeadCode());
+}
+
+TEST(Graph, alias_views) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    for (bool naive : {false, true}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i0 = g->addTensor({2, 3, 4}, DataType::Float32);
+        auto relu = g->addOp<ReluObj>(i0, nullptr);
+        auto reshape =
+            g->addOp<ReshapeObj>(relu->getOutput(), nullptr, Shape{6, 4});
+        auto flatten = g->addOp<FlattenObj>(reshape->getOutput(), nullptr, 0);
+        // Runs while the views are alive, so it must not reuse their memory
+        auto neg = g->addOp<NegObj>(i0, nullptr);
+        auto negView =
+            g->addOp<ReshapeObj>(neg->getOutput(), nullptr, Shape{1, 24});
+        auto add = g->addOp<AddObj>(flatten->getOutput(),
+                                    negView->getOutput(), nullptr);
+        g->dataMalloc(naive);
+        EXPECT_EQ(reshape->isAliasedView(), !naive);
+        EXPECT_EQ(flatten->isAliasedView(), !naive);
+        EXPECT_NE(flatten->getOutput()->getRawDataPtr<void *>(),
+                  negView->getOutput()->getRawDataPtr<void *>());
+        i0->setData(IncrementalGenerator());
+        runtime->run(g);
+        // relu(x) - x for x >= 0
+        EXPECT_TRUE(add->getOutput()->equalData(vector<float>(24, 0)));
+    }
+}
+
+TEST(Graph, inplace_planning) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    for (bool naive : {false, true}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i0 = g->addTensor({2, 3}, DataType::Float32);
+        auto neg = g->addOp<NegObj>(i0, nullptr);
+        auto relu = g->addOp<ReluObj>(neg->getOutput(), nullptr);
+        // The relu output is read again by the add, so the abs can not
+        // overwrite it
+        auto abs = g->addOp<AbsObj>(relu->getOutput(), nullptr);
+        auto add = g->addOp<AddObj>(abs->getOutput(), relu->getOutput(),
+                                    nullptr);
+        g->dataMalloc(naive);
+        auto ptr = [](const Operator &op) {
+            return op->getOutput()->getRawDataPtr<void *>();
+        };
+        // Graph inputs are not written in place
+        EXPECT_NE(ptr(neg), i0->getRawDataPtr<void *>());
+        EXPECT_EQ(ptr(relu) == ptr(neg), !naive);
+        EXPECT_NE(ptr(abs), ptr(relu));
+        EXPECT_EQ(ptr(add) == ptr(abs) || ptr(add) == ptr(relu), !naive);
+        i0->copyin(vector<float>{-1, 2, -3, 4, -5, 6});
+        runtime->run(g);
+        EXPECT_TRUE(
+            add->getOutput()->equalData(vector<float>{2, 0, 6, 0, 10, 0}));
+    }
+}
+
+TEST(Graph, execution_plan) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({2, 3}, DataType::Float32);
+    auto neg = g->addOp<NegObj>(i0, nullptr);
+    auto reshape =
+        g->addOp<ReshapeObj>(neg->getOutput(), nullptr, Shape{3, 2});
+    g->dataMalloc();
+    i0->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    runtime->run(g);
+    auto &plan = g->getExecutionPlan();
+    EXPECT_EQ(plan.version, g->getVersion());
+    // The reshape is planned onto the memory of the neg output
+    ASSERT_EQ(plan.steps.size(), 1u);
+    EXPECT_EQ(plan.steps[0].op, neg);
+    auto steps = plan.steps.data();
+    runtime->run(g);
+    EXPECT_EQ(plan.steps.data(), steps);
+    // Changing the graph rebuilds the plan
+    auto abs = g->addOp<AbsObj>(reshape->getOutput(), nullptr);
+    g->dataMalloc();
+    i0->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    runtime->run(g);
+    EXPECT_EQ(plan.version, g->getVersion());
+    EXPECT_EQ(plan.steps.size(), 2u);
+    EXPECT_TRUE(abs->getOutput()->equalData(vector<float>{1, 2, 3, 4, 5, 6}));
+}
+
+TEST(Graph, instantiate) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({2, 3}, DataType::Float32);
+    Tensor w0 = g->addTensor({3, 4}, DataType::Float32);
+    w0->setWeight();
+    auto matmul = g->addOp<MatmulObj>(i0, w0, nullptr);
+    auto relu = g->addOp<ReluObj>(matmul->getOutput(), nullptr);
+    g->dataMalloc();
+    w0->copyin(vector<float>{1, 0, 0, 1, 0, 1, 0, 1, 0, 0, 1, 1});
+    vector<Graph> graphs = {g};
+    for (int i = 0; i < 3; ++i)
+        graphs.emplace_back(GraphObj::instantiate(g));
+    for (auto &instance : graphs) {
+        auto weight = instance->getOperators()[0]->getInputs(1);
+        EXPECT_EQ(weight->getRawDataPtr<void *>(), w0->getRawDataPtr<void *>());
+    }
+    EXPECT_NE(graphs[1]->getOutputs()[0]->getRawDataPtr<void *>(),
+              relu->getOutput()->getRawDataPtr<void *>());
+    // Each instance runs on its own thread with its own input
+    vector<std::thread> threads;
+    vector<int> correct(graphs.size());
+    for (size_t i = 0; i < graphs.size(); ++i)
+        threads.emplace_back([&, i] {
+            auto input = graphs[i]->getInputs()[0];
+            auto output = graphs[i]->getOutputs()[0];
+            const float x = i;
+            bool ok = true;
+            for (int iter = 0; iter < 50; ++iter) {
+                input->copyin(vector<float>{x, -x, x, x, x, -x});
+                runtime->run(graphs[i]);
+                ok = ok && output->equalData(
+                               vector<float>{x, 0, x, x, x, x, 0, x});
+            }
+            correct[i] = ok;
+        });
+    for (auto &thread : threads)
+        thread.join();
+    for (size_t i = 0; i < graphs.size(); ++i)
+        EXPECT_TRUE(correct[i]) << "instance " << i;
+}
+
+TEST(Graph, set_symbols) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({2, 3, 4}, DataType::Float32);
+    i0->setDimSymbol(0, "batch");
+    i0->setDimSymbol(1, "seq");
+    Tensor w0 = g->addTensor({4, 2}, DataType::Float32);
+    w0->setWeight();
+    auto matmul = g->addOp<MatmulObj>(i0, w0, nullptr);
+    auto reshape =
+        g->addOp<ReshapeObj>(matmul->getOutput(), nullptr, Shape{2, 6});
+    auto relu = g->addOp<ReluObj>(reshape->getOutput(), nullptr);
+    g->dataMalloc();
+    w0->copyin(vector<float>{1, 0, 0, 1, -1, 0, 0, -1});
+    EXPECT_EQ(g->getSymbols(), (std::map<string, int>{{"batch", 2},
+                                                      {"seq", 3}}));
+    // y[b][2s + j] = relu(x[b][s][j] - x[b][s][j + 2])
+    auto check = [&](int batch, int seq) {
+        g->setSymbols({{"batch", batch}, {"seq", seq}});
+        EXPECT_EQ(relu->getOutput()->getDims(), (Shape{batch, seq * 2}));
+        vector<float> x(batch * seq * 4), y(batch * seq * 2);
+        for (size_t i = 0; i < x.size(); ++i)
+            x[i] = float(i % 7) - 3;
+        for (int r = 0; r < batch * seq; ++r)
+            for (int j = 0; j < 2; ++j)
+                y[r * 2 + j] = std::max(x[r * 4 + j] - x[r * 4 + j + 2], 0.f);
+        i0->copyin(x);
+        runtime->run(g);
+        EXPECT_TRUE(relu->getOutput()->equalData(y));
+    };
+    check(4, 5);
+    // Another length of the same bucket reuses the plans
+    size_t peak = g->getMemoryPlans()[0].peak;
+    g->setSymbols({{"seq", 7}});
+    EXPECT_EQ(g->getExecutionPlan().version, g->getVersion());
+    EXPECT_EQ(g->getMemoryPlans()[0].peak, peak);
+    check(4, 7);
+    check(3, 20);
+    EXPECT_GT(g->getMemoryPlans()[0].peak, peak);
+    check(4, 6);
+    EXPECT_EQ(g->getMemoryPlans()[0].peak, peak);
+    check(1, 1);
+}
+
+TEST(Graph, symbolic_shape) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({2, 3}, DataType::UInt32);
+    i0->setDimSymbol(0, "batch");
+    Tensor i1 = g->addTensor({2}, DataType::UInt32);
+    auto shape = g->addOp<ShapeObj>(i0, nullptr);
+    auto mul = g->addOp<MulObj>(i1, shape->getOutput(), nullptr);
+    g->dataMalloc();
+    // The shape follows the batch instead of being folded
+    g->optimize();
+    for (int batch : {2, 5}) {
+        g->setSymbols({{"batch", batch}});
+        i1->copyin(vector<uint32_t>{1, 2});
+        runtime->run(g);
+        EXPECT_EQ(mul->getOutput()->copyout<uint32_t>(),
+                  (vector<uint32_t>{uint32_t(batch), 6}));
+    }
+}
+
 } // namespace infini
@@ -0,0 +1,239 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/attention.h"
+#include "operators/batch_norm.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/fused_element_wise.h"
+#include "operators/layer_norm.h"
+#include "operators/matmul.h"
+#include "operators/reduce.h"
+#include "operators/softmax.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Fill the tensors of `g` without source with random data, the weights first
+static void setInputs(const Graph &g, bool weights) {
+    int seed = 0;
+    for (auto &t : g->getTensors())
+        if (!t->getSource() && t->isWeight() == weights)
+            t->setData(RandomGenerator(0.5, 1.5, seed++));
+}
+
+// Run `g`, optimize it and run it again. Its outputs must not change.
+static void checkOptimize(const Graph &g) {
+    auto runtime = g->getRuntime();
+    g->dataMalloc();
+    setInputs(g, true);
+    setInputs(g, false);
+    runtime->run(g);
+    auto outputs = g->getOutputs();
+    TensorVec answers;
+    for (auto &output : outputs) {
+        output->setOutput();
+        auto ans = make_ref<TensorObj>(output->getDims(), output->getDType(),
+                                       runtime);
+        ans->dataMalloc();
+        ans->copyData(output);
+        answers.emplace_back(ans);
+    }
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    setInputs(g, false);
+    runtime->run(g);
+    for (size_t i = 0; i < outputs.size(); ++i)
+        EXPECT_TRUE(outputs[i]->equalData(answers[i], 1e-5));
+}
+
+TEST(GraphFusion, ConvBatchNormRelu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({1, 3, 7, 7}, DataType::Float32);
+    auto weight = g->addTensor({6, 3, 3, 3}, DataType::Float32);
+    auto conv = g->addOp<ConvObj>(input, weight, nullptr, 1, 1);
+    TensorVec params;
+    for (int i = 0; i < 4; ++i)
+        params.emplace_back(g->addTensor({6}, DataType::Float32));
+    for (auto &t : params)
+        t->setWeight();
+    weight->setWeight();
+    auto bn = g->addOp<BatchNormObj>(conv->getOutput(), nullptr, params[0],
+                                     params[1], params[2], params[3]);
+    g->addOp<ReluObj>(bn->getOutput(), nullptr);
+    checkOptimize(g);
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto fused = as<ConvObj>(g->getOperators()[0]);
+    EXPECT_EQ(fused->getAct(), ActType::Relu);
+    EXPECT_NE(fused->getBias(), nullptr);
+    // Input, folded weight and bias, output
+    EXPECT_EQ(g->getTensors().size(), 4u);
+}
+
+TEST(GraphFusion, MatmulBiasTanh) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 5, 7}, DataType::Float32);
+    auto b = g->addTensor({7, 9}, DataType::Float32);
+    auto bias = g->addTensor({9}, DataType::Float32);
+    auto matmul = g->addOp<MatmulObj>(a, b, nullptr);
+    auto add = g->addOp<AddObj>(bias, matmul->getOutput(), nullptr);
+    g->addOp<TanhObj>(add->getOutput(), nullptr);
+    checkOptimize(g);
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto fused = as<MatmulObj>(g->getOperators()[0]);
+    EXPECT_EQ(fused->getBias(), bias);
+    EXPECT_EQ(fused->getAct(), ActType::Tanh);
+}
+
+TEST(GraphFusion, ElementWiseChain) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({3, 700}, DataType::Float32);
+    auto y = g->addTensor({3, 700}, DataType::Float32);
+    auto s = g->addTensor({1}, DataType::Float32);
+    // sigmoid(s - relu(x + y) * y) / s
+    auto add = g->addOp<AddObj>(x, y, nullptr);
+    auto relu = g->addOp<ReluObj>(add->getOutput(), nullptr);
+    auto mul = g->addOp<MulObj>(relu->getOutput(), y, nullptr);
+    auto sub = g->addOp<SubObj>(s, mul->getOutput(), nullptr);
+    auto sigmoid = g->addOp<SigmoidObj>(sub->getOutput(), nullptr);
+    g->addOp<DivObj>(sigmoid->getOutput(), s, nullptr);
+    // The relu output is read twice, so the chain breaks there
+    g->addOp<AbsObj>(relu->getOutput(), nullptr);
+    checkOptimize(g);
+    ASSERT_EQ(g->getOperators().size(), 3u);
+    int steps = 0;
+    for (auto &op : g->getOperators())
+        if (op->getOpType() == OpType::FusedElementWise)
+            steps += as<FusedElementWiseObj>(op)->getSteps().size();
+    // add + relu, and mul -> sub -> sigmoid -> div. The abs stays alone.
+    EXPECT_EQ(steps, 6);
+}
+
+TEST(GraphFusion, Attention) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto q = g->addTensor({2, 3, 5, 8}, DataType::Float32);
+    // The keys are exported transposed, as [..., dim, seqK]
+    auto k = g->addTensor({2, 3, 8, 7}, DataType::Float32);
+    auto v = g->addTensor({2, 3, 7, 4}, DataType::Float32);
+    auto mask = g->addTensor({5, 7}, DataType::Float32);
+    auto c = g->addTensor({1}, DataType::Float32);
+    c->setWeight();
+    auto qk = g->addOp<MatmulObj>(q, k, nullptr);
+    auto div = g->addOp<DivObj>(qk->getOutput(), c, nullptr);
+    auto add = g->addOp<AddObj>(div->getOutput(), mask, nullptr);
+    auto softmax = g->addOp<SoftmaxObj>(add->getOutput(), nullptr, -1);
+    auto y = g->addOp<MatmulObj>(softmax->getOutput(), v, nullptr)
+                 ->getOutput();
+    g->dataMalloc();
+    c->copyin(vector<float>{std::sqrt(8.f)});
+    g->optimize();
+    EXPECT_TRUE(g->checkValid());
+    ASSERT_EQ(g->getOperators().size(), 1u);
+    auto op = as<AttentionObj>(g->getOperators()[0]);
+    ASSERT_NE(op, nullptr);
+    EXPECT_FLOAT_EQ(op->getScale(), 1 / std::sqrt(8.f));
+    EXPECT_TRUE(op->getTransK());
+    EXPECT_EQ(op->getMask(), mask);
+    EXPECT_EQ(op->getOutput(), y);
+
+    // The fused graph computes the attention of its inputs
+    Graph ref = make_ref<GraphObj>(runtime);
+    TensorVec inputs;
+    for (auto &t : {q, k, v, mask})
+        inputs.emplace_back(ref->addTensor(t->getDims(), DataType::Float32));
+    auto ans = ref->addOp<AttentionObj>(inputs[0], inputs[1], inputs[2],
+                                        nullptr, 1 / std::sqrt(8.f), true,
+                                        inputs[3]);
+    ref->dataMalloc();
+    int seed = 0;
+    for (auto &t : {q, k, v, mask}) {
+        t->setData(RandomGenerator(-1, 1, seed));
+        inputs[seed++]->copyData(t);
+    }
+    runtime->run(g);
+    runtime->run(ref);
+    EXPECT_TRUE(y->equalData(ans->getOutput()));
+}
+
+// The decomposed normalization of the last two dims of x, with the mean
+// subtracted if `center`
+static Tensor normalize(const Graph &g, Tensor x, Tensor eps, bool center) {
+    if (center) {
+        auto mean = g->addOp<ReduceMeanObj>(x, nullptr, vector<int>{-2, -1});
+        x = g->addOp<SubObj>(x, mean->getOutput(), nullptr)->getOutput();
+    }
+    auto square = g->addOp<MulObj>(x, x, nullptr);
+    auto meanSquare = g->addOp<ReduceMeanObj>(square->getOutput(), nullptr,
+                                              vector<int>{2, 3});
+    auto add = g->addOp<AddObj>(meanSquare->getOutput(), eps, nullptr);
+    auto sqrt = g->addOp<SqrtObj>(add->getOutput(), nullptr);
+    return g->addOp<DivObj>(x, sqrt->getOutput(), nullptr)->getOutput();
+}
+
+TEST(GraphFusion, Normalization) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    for (bool center : {true, false}) {
+        Graph g = make_ref<GraphObj>(runtime);
+        auto x = g->addTensor({2, 3, 4, 16}, DataType::Float32);
+        auto eps = g->addTensor({1}, DataType::Float32);
+        auto scale = g->addTensor({4, 16}, DataType::Float32);
+        for (auto &t : {eps, scale})
+            t->setWeight();
+        auto norm = normalize(g, x, eps, center);
+        auto y = g->addOp<MulObj>(norm, scale, nullptr)->getOutput();
+        Tensor bias;
+        if (center) {
+            bias = g->addTensor({4, 16}, DataType::Float32);
+            bias->setWeight();
+            y = g->addOp<AddObj>(bias, y, nullptr)->getOutput();
+        }
+        g->dataMalloc();
+        eps->copyin(vector<float>{1e-5});
+        scale->setData(RandomGenerator(-1, 1, 0));
+        if (bias)
+            bias->setData(RandomGenerator(-1, 1, 1));
+        g->optimize();
+        EXPECT_TRUE(g->checkValid());
+        ASSERT_EQ(g->getOperators().size(), 1u);
+        auto op = g->getOperators()[0];
+        EXPECT_EQ(op->getOutput(), y);
+
+        // The fused graph computes the normalization of its inputs
+        Graph ref = make_ref<GraphObj>(runtime);
+        auto rx = ref->addTensor(x->getDims(), DataType::Float32);
+        auto rs = ref->addTensor(scale->getDims(), DataType::Float32);
+        Tensor ans;
+        if (center) {
+            auto ln = as<LayerNormObj>(op);
+            ASSERT_NE(ln, nullptr);
+            EXPECT_EQ(ln->getAxis(), 2);
+            EXPECT_FLOAT_EQ(ln->getEps(), 1e-5);
+            EXPECT_EQ(ln->getBias(), bias);
+            auto rb = ref->addTensor(bias->getDims(), DataType::Float32);
+            ans = ref->addOp<LayerNormObj>(rx, rs, nullptr, rb, 1e-5, 2)
+                      ->getOutput();
+            ref->dataMalloc();
+            rb->copyData(bias);
+        } else {
+            auto rms = as<RMSNormObj>(op);
+            ASSERT_NE(rms, nullptr);
+            EXPECT_EQ(rms->getAxis(), 2);
+            ans = ref->addOp<RMSNormObj>(rx, rs, nullptr, 1e-5, 2)
+                      ->getOutput();
+            ref->dataMalloc();
+        }
+        x->setData(RandomGenerator(-1, 1, 2));
+        rx->copyData(x);
+        rs->copyData(scale);
+        runtime->run(g);
+        runtime->run(ref);
+        EXPECT_TRUE(y->equalData(ans));
+    }
+}
+
+} // namespace infini
@@ -1,6 +1,7 @@
 ﻿#include "core/graph_handler.h"
 #include "core/runtime.h"
 #include <test.h>
+#include <thread>
 
 namespace infini {
 
@@ -13,4 +14,44 @@ TEST(Handler, matmul) {
     handler->matmul(i, w, o, false, false, nullptr, ActType::None);
 }
 
+TEST(Handler, run_async) {
+    auto runtime = NativeCpuRuntimeObj::getInstance();
+    auto handler = make_ref<GraphHandlerObj>(runtime);
+    auto x = handler->tensor({2, 3}, DataType::Float32.getIndex());
+    auto y = handler->neg(handler->relu(x, nullptr), nullptr);
+    handler->data_malloc();
+    handler->init_io_buffers(2);
+    // The second request is copied in while the first one may be running
+    handler->io_buffer(x, 0)->copyin(vector<float>{1, -2, 3, -4, 5, -6});
+    auto first = handler->run_async(0);
+    handler->io_buffer(x, 1)->copyin(vector<float>{-1, 2, -3, 4, -5, 6});
+    auto second = handler->run_async(1);
+    first.get();
+    second.get();
+    EXPECT_TRUE(handler->io_buffer(y, 0)->equalData(
+        vector<float>{-1, 0, -3, 0, -5, 0}));
+    EXPECT_TRUE(handler->io_buffer(y, 1)->equalData(
+        vector<float>{0, -2, 0, -4, 0, -6}));
+    EXPECT_THROW(handler->io_buffer(x, 2), Exception);
+}
+
+TEST(Handler, run_async_from_threads) {
+    auto runtime = NativeCpuRuntimeObj::getInstance();
+    auto handler = make_ref<GraphHandlerObj>(runtime);
+    auto x = handler->tensor({4}, DataType::Float32.getIndex());
+    auto y = handler->relu(x, nullptr);
+    handler->data_malloc();
+    x->copyin(vector<float>{-1, 0, 1, 2});
+    // The first requests of a handler come from several threads at once
+    vector<std::shared_future<void>> runs(8);
+    vector<std::thread> threads;
+    for (auto &run : runs)
+        threads.emplace_back([&] { run = handler->run_async(); });
+    for (auto &thread : threads)
+        thread.join();
+    for (auto &run : runs)
+        run.get();
+    EXPECT_TRUE(y->equalData(vector<float>{0, 0, 1, 2}));
+}
+
 } // namespace infini
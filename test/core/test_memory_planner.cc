@@ -0,0 +1,136 @@
+#include "core/graph.h"
+#include "core/memory_planner.h"
+#include "core/runtime.h"
+#include "operators/concat.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+// No two buffers live at the same step may overlap
+static void checkPlan(const vector<MemoryBuffer> &buffers,
+                      const MemoryPlan &plan) {
+    ASSERT_EQ(plan.offsets.size(), buffers.size());
+    EXPECT_GE(plan.peak, plan.lowerBound);
+    for (size_t i = 0; i < buffers.size(); ++i) {
+        EXPECT_LE(plan.offsets[i] + buffers[i].size, plan.peak);
+        for (size_t j = 0; j < i; ++j) {
+            if (buffers[i].start > buffers[j].end ||
+                buffers[j].start > buffers[i].end)
+                continue;
+            EXPECT_TRUE(plan.offsets[i] + buffers[i].size <= plan.offsets[j] ||
+                        plan.offsets[j] + buffers[j].size <= plan.offsets[i]);
+        }
+    }
+}
+
+TEST(MemoryPlanner, planners) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    LazyAllocator allocator(runtime);
+    // A long-lived small buffer splits the memory of the first steps, which
+    // the greedy heap can not use for the large buffer of the last steps
+    vector<MemoryBuffer> buffers = {
+        {64, 0, 1}, {8, 1, 5}, {64, 2, 3}, {128, 4, 5}, {32, 0, 0},
+    };
+    EXPECT_EQ(liveBytesLowerBound(buffers), 136u);
+    auto greedy = planGreedy(buffers, allocator);
+    auto bySize = planGreedyBySize(buffers);
+    auto colouring = planIntervalColouring(buffers);
+    for (auto &plan : {greedy, bySize, colouring}) {
+        checkPlan(buffers, plan);
+        EXPECT_EQ(plan.lowerBound, 136u);
+    }
+    EXPECT_EQ(greedy.planner, MemoryPlanner::Greedy);
+    EXPECT_EQ(greedy.peak, allocator.getPeak());
+    EXPECT_EQ(bySize.peak, 136u);
+    EXPECT_EQ(colouring.peak, 136u);
+    EXPECT_GT(greedy.peak, 136u);
+}
+
+TEST(MemoryPlanner, dataMalloc) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({4, 8}, DataType::Float32);
+    auto neg = g->addOp<NegObj>(i0, nullptr);
+    auto relu = g->addOp<ReluObj>(i0, nullptr);
+    auto abs = g->addOp<AbsObj>(relu->getOutput(), nullptr);
+    auto sub = g->addOp<SubObj>(abs->getOutput(), neg->getOutput(), nullptr);
+    auto mul = g->addOp<MulObj>(sub->getOutput(), relu->getOutput(), nullptr);
+    for (auto planner :
+         {MemoryPlanner::Auto, MemoryPlanner::Greedy,
+          MemoryPlanner::GreedyBySize, MemoryPlanner::IntervalColouring,
+          MemoryPlanner::Reorder}) {
+        g->dataMalloc(false, planner);
+        auto &plans = g->getMemoryPlans();
+        ASSERT_EQ(plans.size(), planner == MemoryPlanner::Auto ? 4u : 1u);
+        if (planner != MemoryPlanner::Auto) {
+            EXPECT_EQ(plans[0].planner, planner);
+        }
+        for (auto &plan : plans) {
+            EXPECT_GE(plan.peak, plan.lowerBound);
+            EXPECT_LE(plans[0].peak, plan.peak);
+        }
+        i0->setData(IncrementalGenerator());
+        runtime->run(g);
+        // (abs(relu(x)) + x) * relu(x) is 2 * x * x for x >= 0
+        vector<float> ans(32);
+        for (int i = 0; i < 32; ++i)
+            ans[i] = 2 * i * i;
+        EXPECT_TRUE(mul->getOutput()->equalData(ans));
+    }
+}
+
+TEST(MemoryPlanner, concatInPlace) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({1, 4, 8}, DataType::Float32);
+    auto relu = g->addOp<ReluObj>(i0, nullptr);
+    auto neg = g->addOp<NegObj>(i0, nullptr);
+    auto abs = g->addOp<AbsObj>(i0, nullptr);
+    auto concat = g->addOp<ConcatObj>(
+        TensorVec{relu->getOutput(), neg->getOutput(), abs->getOutput()},
+        nullptr, 1);
+    // abs is read again, so it keeps its own memory
+    g->addOp<ReluObj>(abs->getOutput(), nullptr);
+    vector<vector<float>> results;
+    for (bool inPlace : {false, true}) {
+        g->dataMalloc(false, MemoryPlanner::Auto, inPlace);
+        auto base = concat->getOutput()->getRawDataPtr<float *>();
+        EXPECT_EQ(relu->getOutput()->getRawDataPtr<float *>() == base,
+                  inPlace);
+        EXPECT_EQ(neg->getOutput()->getRawDataPtr<float *>() == base + 32,
+                  inPlace);
+        EXPECT_NE(abs->getOutput()->getRawDataPtr<float *>(), base + 64);
+        i0->setData(IncrementalGenerator());
+        runtime->run(g);
+        results.emplace_back(concat->getOutput()->copyout<float>());
+    }
+    EXPECT_EQ(results[0], results[1]);
+    for (int i = 0; i < 32; ++i) {
+        EXPECT_EQ(results[1][i], i);
+        EXPECT_EQ(results[1][32 + i], -i);
+        EXPECT_EQ(results[1][64 + i], i);
+    }
+}
+
+TEST(MemoryPlanner, optimizeKeepsOptions) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({1, 4, 8}, DataType::Float32);
+    auto relu = g->addOp<ReluObj>(i0, nullptr);
+    auto neg = g->addOp<NegObj>(i0, nullptr);
+    auto concat = g->addOp<ConcatObj>(
+        TensorVec{relu->getOutput(), neg->getOutput()}, nullptr, 1);
+    g->dataMalloc(false, MemoryPlanner::Greedy, true);
+    // Planned again with the same planner, and the Concat still in place
+    g->optimize();
+    auto &plans = g->getMemoryPlans();
+    ASSERT_EQ(plans.size(), 1u);
+    EXPECT_EQ(plans[0].planner, MemoryPlanner::Greedy);
+    EXPECT_EQ(relu->getOutput()->getRawDataPtr<float *>(),
+              concat->getOutput()->getRawDataPtr<float *>());
+}
+
+} // namespace infini
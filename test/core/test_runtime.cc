@@ -0,0 +1,104 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+#include "operators/unary.h"
+#include "utils/thread_pool.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(ThreadPool, nested_submit) {
+    std::atomic<int> count{0};
+    {
+        ThreadPool pool(4);
+        for (int i = 0; i < 100; ++i)
+            pool.submit([&] {
+                for (int j = 0; j < 10; ++j)
+                    pool.submit([&] { ++count; });
+            });
+        // The destructor waits for the queued tasks
+    }
+    EXPECT_EQ(count, 1000);
+}
+
+TEST(ThreadPool, outside_order) {
+    vector<int> order;
+    std::mutex gate;
+    {
+        ThreadPool pool(1);
+        // The worker is held up until all the tasks are queued
+        gate.lock();
+        pool.submit([&] { std::lock_guard<std::mutex> lock(gate); });
+        for (int i = 0; i < 4; ++i)
+            pool.submit([&, i] { order.emplace_back(i); });
+        gate.unlock();
+    }
+    EXPECT_EQ(order, (vector<int>{0, 1, 2, 3}));
+}
+
+TEST(CpuRuntime, inter_op_parallel) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    runtime->setInterOpThreads(4);
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor x = g->addTensor({16, 64}, DataType::Float32);
+    // Eight independent branches, summed up in a chain
+    const int branches = 8;
+    Tensor sum;
+    for (int i = 0; i < branches; ++i) {
+        auto relu = g->addOp<ReluObj>(x, nullptr);
+        auto sigmoid = g->addOp<SigmoidObj>(relu->getOutput(), nullptr);
+        sum = sum ? g->addOp<AddObj>(sum, sigmoid->getOutput(), nullptr)
+                        ->getOutput()
+                  : sigmoid->getOutput();
+    }
+    g->dataMalloc();
+    vector<float> input(x->size()), expected(x->size());
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = float(i % 13) - 6;
+        expected[i] = branches / (1 + std::exp(-std::max(input[i], 0.f)));
+    }
+    auto ans = make_ref<TensorObj>(x->getDims(), DataType::Float32, runtime);
+    ans->dataMalloc();
+    ans->copyin(expected);
+    for (int iter = 0; iter < 3; ++iter) {
+        x->copyin(input);
+        runtime->run(g);
+        EXPECT_TRUE(sum->equalData(ans, 1e-5));
+    }
+    auto &plan = g->getExecutionPlan();
+    ASSERT_TRUE(plan.concurrent);
+    // The buffers of the branches are kept apart, so all the relus start
+    // at once
+    int roots = std::count(plan.numPredecessors.begin(),
+                           plan.numPredecessors.end(), 0);
+    EXPECT_EQ(roots, branches);
+
+    // Back to one op at a time
+    runtime->setInterOpThreads(1);
+    x->copyin(input);
+    runtime->run(g);
+    EXPECT_FALSE(plan.concurrent);
+    EXPECT_TRUE(sum->equalData(ans, 1e-5));
+}
+
+TEST(CpuRuntime, inter_op_stress) {
+    auto runtime = make_ref<NativeCpuRuntimeObj>();
+    runtime->setInterOpThreads(8);
+    Graph g = make_ref<GraphObj>(runtime);
+    // Many tiny independent ops, so that the run often returns just as the
+    // last worker finishes
+    const int branches = 32;
+    Tensor x = g->addTensor({4}, DataType::Float32);
+    vector<Tensor> outputs;
+    for (int i = 0; i < branches; ++i)
+        outputs.emplace_back(g->addOp<ReluObj>(x, nullptr)->getOutput());
+    g->dataMalloc();
+    x->copyin(vector<float>{-1, 0, 1, 2});
+    for (int iter = 0; iter < 2000; ++iter)
+        runtime->run(g);
+    for (auto &output : outputs)
+        EXPECT_TRUE(output->equalData(vector<float>{0, 0, 1, 2}));
+}
+
+} // namespace infini
@@ -0,0 +1,113 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/attention.h"
+#include <cmath>
+
+#include "test.h"
+
+namespace infini {
+
+// softmax(q k^T * scale + mask) v over [batch, seq, dim] tensors, where the
+// mask is [seqQ, seqK] or empty
+static vector<float> attention(const vector<float> &q, const vector<float> &k,
+                               const vector<float> &v,
+                               const vector<float> &mask, int batch, int seqQ,
+                               int seqK, int dim, int dimV, float scale,
+                               bool transK) {
+    vector<float> y(batch * seqQ * dimV, 0);
+    for (int b = 0; b < batch; ++b)
+        for (int i = 0; i < seqQ; ++i) {
+            vector<float> s(seqK);
+            float max = -INFINITY, sum = 0;
+            for (int j = 0; j < seqK; ++j) {
+                float dot = 0;
+                for (int d = 0; d < dim; ++d)
+                    dot += q[(b * seqQ + i) * dim + d] *
+                           (transK ? k[(b * dim + d) * seqK + j]
+                                   : k[(b * seqK + j) * dim + d]);
+                s[j] = dot * scale + (mask.empty() ? 0 : mask[i * seqK + j]);
+                max = std::max(max, s[j]);
+            }
+            for (auto &x : s)
+                sum += x = std::exp(x - max);
+            for (int j = 0; j < seqK; ++j)
+                for (int d = 0; d < dimV; ++d)
+                    y[(b * seqQ + i) * dimV + d] +=
+                        s[j] / sum * v[(b * seqK + j) * dimV + d];
+        }
+    return y;
+}
+
+static void testAttention(int seqQ, int seqK, int dim, int dimV, bool transK,
+                          bool causal) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    const int batch = 2, heads = 3;
+    const float scale = 1 / std::sqrt(float(dim));
+    auto q = g->addTensor({batch, heads, seqQ, dim}, DataType::Float32);
+    auto k = g->addTensor(transK ? Shape{batch, heads, dim, seqK}
+                                 : Shape{batch, heads, seqK, dim},
+                          DataType::Float32);
+    auto v = g->addTensor({batch, heads, seqK, dimV}, DataType::Float32);
+    Tensor mask;
+    vector<float> maskData;
+    if (causal) {
+        // Query i sits at position seqK - seqQ + i
+        mask = g->addTensor({seqQ, seqK}, DataType::Float32);
+        for (int i = 0; i < seqQ; ++i)
+            for (int j = 0; j < seqK; ++j)
+                maskData.emplace_back(j <= seqK - seqQ + i ? 0 : -INFINITY);
+    }
+    auto op = g->addOp<AttentionObj>(q, k, v, nullptr, scale, transK, mask);
+    EXPECT_EQ(op->getOutput()->getDims(),
+              (Shape{batch, heads, seqQ, dimV}));
+    g->dataMalloc();
+    q->setData(RandomGenerator(-1, 1, 0));
+    k->setData(RandomGenerator(-1, 1, 1));
+    v->setData(RandomGenerator(-1, 1, 2));
+    if (mask)
+        mask->copyin(maskData);
+    runtime->run(g);
+
+    auto y = op->getOutput()->copyout<float>();
+    auto ans = attention(q->copyout<float>(), k->copyout<float>(),
+                         v->copyout<float>(), maskData, batch * heads, seqQ,
+                         seqK, dim, dimV, scale, transK);
+    float maxErr = 0;
+    for (size_t i = 0; i < y.size(); ++i)
+        maxErr = std::max(maxErr, std::abs(y[i] - ans[i]));
+    EXPECT_LT(maxErr, 1e-5);
+}
+
+TEST(Attention, NativeCpu) {
+    testAttention(1, 1, 4, 4, false, false);
+    testAttention(5, 7, 8, 6, false, false);
+    // Several tiles of queries and blocks of keys, with ragged ends
+    testAttention(37, 150, 16, 16, false, true);
+    testAttention(37, 150, 16, 8, true, true);
+    testAttention(20, 20, 8, 8, true, false);
+}
+
+TEST(Attention, MaskBroadcast) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto q = g->addTensor({2, 1, 2}, DataType::Float32);
+    auto k = g->addTensor({2, 3, 2}, DataType::Float32);
+    auto v = g->addTensor({2, 3, 1}, DataType::Float32);
+    // A padding mask per batch, hiding the last key of batch 0
+    auto mask = g->addTensor({2, 1, 3}, DataType::Float32);
+    auto op = g->addOp<AttentionObj>(q, k, v, nullptr, 1.f, false, mask);
+    g->dataMalloc();
+    q->copyin(vector<float>{0, 0, 0, 0});
+    k->copyin(vector<float>(12, 1));
+    v->copyin(vector<float>{1, 2, 30, 4, 5, 6});
+    mask->copyin(vector<float>{0, 0, -INFINITY, 0, 0, 0});
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(vector<float>{1.5, 5}));
+
+    auto wide = g->addTensor({3, 1, 3}, DataType::Float32);
+    EXPECT_THROW(g->addOp<AttentionObj>(q, k, v, nullptr, 1.f, false, wide),
+                 Exception);
+}
+
+} // namespace infini
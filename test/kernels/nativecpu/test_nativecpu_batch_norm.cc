@@ -0,0 +1,30 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/batch_norm.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(BatchNorm, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto i = g->addTensor({1, 3, 2, 2}, DataType::Float32);
+    auto mean = g->addTensor({3}, DataType::Float32);
+    auto var = g->addTensor({3}, DataType::Float32);
+    auto scale = g->addTensor({3}, DataType::Float32);
+    auto bias = g->addTensor({3}, DataType::Float32);
+    auto op = g->addOp<BatchNormObj>(i, nullptr, mean, var, scale, bias, 0.9,
+                                     0);
+    g->dataMalloc();
+    i->setData(IncrementalGenerator());
+    mean->copyin(vector<float>{1, 6, 9});
+    var->copyin(vector<float>{4, 1, 0.25});
+    scale->copyin(vector<float>{1, 1, 2});
+    bias->copyin(vector<float>{0, 1, -1});
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(
+        vector<float>{-0.5, 0, 0.5, 1, -1, 0, 1, 2, -5, -1, 3, 7}));
+}
+
+} // namespace infini
@@ -0,0 +1,46 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Cast, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({4}, DataType::Float32);
+    auto half = g->addTensor({4}, DataType::Float16);
+    auto bHalf = g->addTensor({4}, DataType::BFloat16);
+    auto integer = g->addTensor({4}, DataType::Int32);
+    auto toInt = g->addOp<CastObj>(input, nullptr, CastType::Float2Int32);
+    auto toHalf = g->addOp<CastObj>(input, nullptr, CastType::Float2Float16);
+    auto toBHalf =
+        g->addOp<CastObj>(input, nullptr, CastType::Float2BFloat16);
+    auto fromHalf = g->addOp<CastObj>(half, nullptr, CastType::Float162Float);
+    auto fromBHalf =
+        g->addOp<CastObj>(bHalf, nullptr, CastType::BFloat162Float);
+    auto wide = g->addOp<CastObj>(integer, nullptr, CastType::Int322Int64);
+    g->dataMalloc();
+    input->copyin(vector<float>{-2.75, 0, 1.5, 1000});
+    // The same values in half and bfloat16
+    half->copyin(vector<uint16_t>{0xc180, 0, 0x3e00, 0x63d0});
+    bHalf->copyin(vector<uint16_t>{0xc030, 0, 0x3fc0, 0x447a});
+    integer->copyin(vector<int32_t>{-2, 0, 1, 1000});
+    runtime->run(g);
+    // Floats are truncated towards 0
+    EXPECT_EQ(toInt->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{-2, 0, 1, 1000}));
+    EXPECT_EQ(toHalf->getOutput()->copyout<uint16_t>(),
+              (vector<uint16_t>{0xc180, 0, 0x3e00, 0x63d0}));
+    EXPECT_EQ(toBHalf->getOutput()->copyout<uint16_t>(),
+              (vector<uint16_t>{0xc030, 0, 0x3fc0, 0x447a}));
+    EXPECT_TRUE(
+        fromHalf->getOutput()->equalData(vector<float>{-2.75, 0, 1.5, 1000}));
+    EXPECT_TRUE(
+        fromBHalf->getOutput()->equalData(vector<float>{-2.75, 0, 1.5, 1000}));
+    EXPECT_EQ(wide->getOutput()->copyout<int64_t>(),
+              (vector<int64_t>{-2, 0, 1, 1000}));
+}
+
+} // namespace infini
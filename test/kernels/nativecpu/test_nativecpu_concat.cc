@@ -25,4 +25,21 @@ TEST(Concat, NativeCpu) {
                       6, 7, 8, 1, 1, 1, 9, 10, 11, 1, 1, 1}));
 }
 
+TEST(Concat, NativeCpuInt64) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+
+    auto t1 = g->addTensor({2, 1, 3}, DataType::Int64);
+    auto t2 = g->addTensor({2, 2, 3}, DataType::Int64);
+    auto op = g->addOp<ConcatObj>(TensorVec{t1, t2}, nullptr, 1);
+    g->dataMalloc();
+    t1->copyin(vector<int64_t>{0, 1, 2, 3, 4, 5});
+    t2->copyin(vector<int64_t>{10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21});
+
+    runtime->run(g);
+    EXPECT_EQ(op->getOutput()->copyout<int64_t>(),
+              (vector<int64_t>{0, 1, 2, 10, 11, 12, 13, 14, 15, 3, 4, 5, 16,
+                               17, 18, 19, 20, 21}));
+}
+
 } // namespace infini
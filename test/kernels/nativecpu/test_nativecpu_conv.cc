@@ -0,0 +1,147 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/conv.h"
+
+#include "test.h"
+#include <cmath>
+
+namespace infini {
+
+// Algorithm ids of the native CPU conv kernel, as persisted by PerfEngine
+enum { Im2colGemm, ImplicitGemm, WinogradF2x2, WinogradF4x4, Depthwise };
+constexpr int ConvCpuRecordType = 3;
+
+// Straightforward convolution used as the reference.
+template <typename T> static vector<T> referenceConv(const Ref<ConvObj> &op) {
+    auto [n, c, h, w, f, r, s] = op->getNCHWFRS();
+    auto [ph, pw, sh, sw, dh, dw] = op->getPadStrideDilation();
+    int cpg = op->getChannelPerGroup(), fpg = f / op->getNumGroups();
+    auto outDim = op->getOutput()->getDims();
+    int oh = outDim[2], ow = outDim[3];
+    auto in = op->getInputs(0)->getRawDataPtr<T *>();
+    auto wt = op->getInputs(1)->getRawDataPtr<T *>();
+    auto bias = op->getBias() ? op->getBias()->getRawDataPtr<T *>() : nullptr;
+    vector<T> ret(op->getOutput()->size());
+    for (int nn = 0; nn < n; ++nn)
+        for (int ff = 0; ff < f; ++ff)
+            for (int y = 0; y < oh; ++y)
+                for (int x = 0; x < ow; ++x) {
+                    double sum = bias ? bias[ff] : 0;
+                    for (int cc = 0; cc < cpg; ++cc)
+                        for (int rr = 0; rr < r; ++rr)
+                            for (int ss = 0; ss < s; ++ss) {
+                                int iy = y * sh + rr * dh - ph,
+                                    ix = x * sw + ss * dw - pw;
+                                if (iy < 0 || iy >= h || ix < 0 || ix >= w)
+                                    continue;
+                                int ci = ff / fpg * cpg + cc;
+                                sum += (double)in[((nn * c + ci) * h + iy) * w +
+                                                  ix] *
+                                       wt[((ff * cpg + cc) * r + rr) * s + ss];
+                            }
+                    if (op->getAct() == ActType::Sigmoid)
+                        sum = 1 / (1 + std::exp(-sum));
+                    else if (op->getAct() == ActType::Tanh)
+                        sum = std::tanh(sum);
+                    ret[((nn * f + ff) * oh + y) * ow + x] = sum;
+                }
+    return ret;
+}
+
+template <typename T>
+static void testConv(const Shape &shapeIn, const Shape &shapeWeight, int ph,
+                     int pw, int sh, int sw, int dh, int dw, ActType act,
+                     DataType dtype, const vector<int> &algos,
+                     double relErr = 1e-5) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(shapeIn, dtype);
+    auto weight = g->addTensor(shapeWeight, dtype);
+    auto bias = g->addTensor({shapeWeight[0]}, dtype);
+    auto op = g->addOp<ConvObj>(input, weight, nullptr, ph, pw, sh, sw, dh, dw,
+                                bias, act);
+    g->dataMalloc();
+    input->setData(RandomGenerator(0, 1, 0));
+    weight->setData(RandomGenerator(0, 1, 1));
+    bias->setData(RandomGenerator(0, 1, 2));
+    auto ans = make_ref<TensorObj>(op->getOutput()->getDims(), dtype, runtime);
+    ans->dataMalloc();
+    ans->copyin(referenceConv<T>(op));
+
+    auto kernel = KernelRegistry::getInstance().getKernel(
+        {Device::CPU, OpType::Conv, dtype});
+    for (int algo : algos) {
+        json j{{"type", ConvCpuRecordType},
+               {"data", std::make_tuple(algo, 0.0)}};
+        auto record = PerfRecordRegistry::getInstance().getConstructor(
+            ConvCpuRecordType)(j);
+        op->getOutput()->setData(ValGenerator<0>());
+        kernel->compute(op, record, runtime.get());
+        EXPECT_TRUE(op->getOutput()->equalData(ans, relErr))
+            << "algorithm " << algo;
+    }
+    // The default choice
+    op->getOutput()->setData(ValGenerator<0>());
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(ans, relErr));
+}
+
+TEST(Conv, NativeCpuWinograd) {
+    testConv<float>({2, 16, 9, 11}, {16, 16, 3, 3}, 1, 1, 1, 1, 1, 1,
+                    ActType::None, DataType::Float32,
+                    {Im2colGemm, ImplicitGemm, WinogradF2x2, WinogradF4x4},
+                    1e-4);
+    testConv<float>({1, 3, 13, 6}, {5, 3, 3, 3}, 0, 2, 1, 1, 1, 1,
+                    ActType::Tanh, DataType::Float32,
+                    {WinogradF2x2, WinogradF4x4}, 1e-4);
+}
+
+TEST(Conv, NativeCpuGemm) {
+    // Grouped and strided
+    testConv<float>({1, 8, 7, 7}, {6, 4, 3, 3}, 1, 1, 2, 2, 1, 1,
+                    ActType::Sigmoid, DataType::Float32,
+                    {Im2colGemm, ImplicitGemm});
+    // Dilated, with more pixels than one implicit GEMM tile
+    testConv<float>({2, 4, 30, 33}, {8, 4, 5, 5}, 2, 3, 1, 1, 2, 2,
+                    ActType::None, DataType::Float32,
+                    {Im2colGemm, ImplicitGemm});
+    // Pointwise
+    testConv<uint32_t>({1, 5, 6, 6}, {7, 5, 1, 1}, 0, 0, 1, 1, 1, 1,
+                       ActType::None, DataType::UInt32,
+                       {Im2colGemm, ImplicitGemm});
+}
+
+TEST(Conv, NativeCpuDepthwise) {
+    testConv<float>({2, 6, 10, 9}, {6, 1, 3, 3}, 1, 1, 2, 2, 1, 1,
+                    ActType::Sigmoid, DataType::Float32,
+                    {Depthwise, Im2colGemm, ImplicitGemm});
+    testConv<uint32_t>({1, 4, 8, 8}, {4, 1, 3, 3}, 2, 0, 1, 1, 2, 1,
+                       ActType::None, DataType::UInt32,
+                       {Depthwise, ImplicitGemm});
+}
+
+TEST(Conv, NativeCpuTune) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({1, 16, 12, 12}, DataType::Float32);
+    auto weight = g->addTensor({16, 16, 3, 3}, DataType::Float32);
+    auto op = g->addOp<ConvObj>(input, weight, nullptr, 1, 1);
+    g->dataMalloc();
+    input->setData(RandomGenerator(0, 1, 0));
+    weight->setData(RandomGenerator(0, 1, 1));
+    auto kernel = KernelRegistry::getInstance().getKernel(
+        {Device::CPU, OpType::Conv, DataType::Float32});
+    auto record = kernel->tune(op, runtime.get());
+    EXPECT_GT(record->time, 0);
+    // The choice survives a round trip through the persisted form
+    json j;
+    record->to_json(j);
+    EXPECT_EQ(j["type"], ConvCpuRecordType);
+    json k;
+    PerfRecordRegistry::getInstance().getConstructor(ConvCpuRecordType)(j)
+        ->to_json(k);
+    EXPECT_EQ(j, k);
+}
+
+} // namespace infini
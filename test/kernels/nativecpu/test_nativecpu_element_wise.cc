@@ -0,0 +1,131 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/element_wise.h"
+
+#include "test.h"
+
+namespace infini {
+
+// Element `i` of the output of shape `out` read from an input of shape `in`
+// broadcast to it
+static size_t broadcastIndex(size_t i, const Shape &out, const Shape &in) {
+    size_t ret = 0, stride = 1;
+    for (int d = out.size() - 1, e = in.size() - 1; d >= 0; --d, --e) {
+        const size_t index = i % out[d];
+        i /= out[d];
+        if (e >= 0 && in[e] != 1) {
+            ret += index * stride;
+            stride *= in[e];
+        }
+    }
+    return ret;
+}
+
+template <typename Op, typename T, typename F>
+static void testBroadcast(const Shape &a, const Shape &b, DataType dtype,
+                          F f) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input0 = g->addTensor(a, dtype);
+    auto input1 = g->addTensor(b, dtype);
+    auto op = g->addOp<Op>(input0, input1, nullptr);
+    g->dataMalloc();
+    // Small, and nonzero on the right, so that every op is defined
+    vector<T> x0(input0->size()), x1(input1->size());
+    for (size_t i = 0; i < x0.size(); ++i)
+        x0[i] = T(i % 97);
+    for (size_t i = 0; i < x1.size(); ++i)
+        x1[i] = T(i % 5 + 1);
+    input0->copyin(x0);
+    input1->copyin(x1);
+    runtime->run(g);
+    auto out = op->getOutput()->getDims();
+    auto y = op->getOutput()->template copyout<T>();
+    for (size_t i = 0; i < y.size(); ++i)
+        ASSERT_EQ(y[i], f(x0[broadcastIndex(i, out, a)],
+                          x1[broadcastIndex(i, out, b)]))
+            << "at " << i << " of " << vecToString(out);
+}
+
+TEST(ElementWise, NativeCpuBroadcast) {
+    auto add = [](float a, float b) { return a + b; };
+    // Same shape, scalar, row and column broadcast, both broadcast and rank 6
+    for (auto &[a, b] : vector<std::pair<Shape, Shape>>{
+             {{2, 3, 4}, {2, 3, 4}},
+             {{40000}, {40000}},
+             {{2, 3, 4}, {1}},
+             {{1}, {5, 7}},
+             {{64, 300}, {300}},
+             {{64, 300}, {64, 1}},
+             {{1, 300}, {64, 1}},
+             {{2, 1, 3, 1, 5, 2}, {1, 3, 4, 5, 1}},
+             {{3, 1, 1}, {1, 1, 1}},
+         }) {
+        testBroadcast<AddObj, float>(a, b, DataType::Float32, add);
+        testBroadcast<AddObj, float>(b, a, DataType::Float32, add);
+    }
+    testBroadcast<SubObj, int64_t>({7, 1, 9}, {5, 1}, DataType::Int64,
+                                   [](int64_t a, int64_t b) { return a - b; });
+    testBroadcast<MulObj, int32_t>({3, 4}, {4}, DataType::Int32,
+                                   [](int32_t a, int32_t b) { return a * b; });
+    testBroadcast<MaximumObj, uint32_t>(
+        {3, 4}, {3, 1}, DataType::UInt32,
+        [](uint32_t a, uint32_t b) { return std::max(a, b); });
+    testBroadcast<BitLeftShiftObj, uint32_t>(
+        {4, 6}, {6}, DataType::UInt32,
+        [](uint32_t a, uint32_t b) { return a << b; });
+}
+
+TEST(ElementWise, NativeCpuEmpty) {
+    // Empty along the broadcast dim, the last dim and a middle dim
+    for (auto &[a, b] : vector<std::pair<Shape, Shape>>{
+             {{0, 3}, {3}},
+             {{4, 0}, {4, 1}},
+             {{2, 0, 3}, {2, 1, 3}},
+             {{0}, {1}},
+         }) {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        auto input0 = g->addTensor(a, DataType::Float32);
+        auto input1 = g->addTensor(b, DataType::Float32);
+        auto op = g->addOp<AddObj>(input0, input1, nullptr);
+        g->dataMalloc();
+        runtime->run(g);
+        EXPECT_EQ(op->getOutput()->size(), 0u);
+    }
+}
+
+TEST(ElementWise, NativeCpuSemantics) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({4}, DataType::Int32);
+    auto b = g->addTensor({4}, DataType::Int32);
+    auto fa = g->addTensor({4}, DataType::Float32);
+    auto fb = g->addTensor({4}, DataType::Float32);
+    auto mod = g->addOp<ModObj>(a, b, nullptr);
+    auto floorDiv = g->addOp<FloorDivObj>(a, b, nullptr);
+    auto fmod = g->addOp<ModObj>(fa, fb, nullptr);
+    auto pow = g->addOp<PowObj>(fa, fb, nullptr);
+    auto xorOp = g->addOp<XorObj>(a, b, nullptr);
+    auto bitAnd = g->addOp<BitAndObj>(a, b, nullptr);
+    g->dataMalloc();
+    a->copyin(vector<int32_t>{7, -7, 7, -6});
+    b->copyin(vector<int32_t>{3, 3, -3, 3});
+    fa->copyin(vector<float>{7, -7, 2, 0});
+    fb->copyin(vector<float>{3, 3, 0.5, 2});
+    runtime->run(g);
+    // Integer Mod follows the divisor, float Mod the dividend
+    EXPECT_EQ(mod->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{1, 2, -2, 0}));
+    EXPECT_EQ(floorDiv->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{2, -3, -3, -2}));
+    EXPECT_TRUE(fmod->getOutput()->equalData(vector<float>{1, -1, 0, 0}));
+    EXPECT_TRUE(
+        pow->getOutput()->equalData(vector<float>{343, -343, 1.4142135, 0}));
+    EXPECT_EQ(xorOp->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{0, 0, 0, 0}));
+    EXPECT_EQ(bitAnd->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{3, 1, 5, 2}));
+}
+
+} // namespace infini
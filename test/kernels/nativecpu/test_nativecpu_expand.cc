@@ -0,0 +1,25 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/expand.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Expand, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto row = g->addTensor({3}, DataType::Float32);
+    auto column = g->addTensor({2, 1}, DataType::Int64);
+    auto rows = g->addOp<ExpandObj>(row, nullptr, Shape{2, 3});
+    auto columns = g->addOp<ExpandObj>(column, nullptr, Shape{2, 1, 2, 3});
+    g->dataMalloc();
+    row->copyin(vector<float>{1, 2, 3});
+    column->copyin(vector<int64_t>{7, 8});
+    runtime->run(g);
+    EXPECT_TRUE(rows->getOutput()->equalData(vector<float>{1, 2, 3, 1, 2, 3}));
+    EXPECT_EQ(columns->getOutput()->copyout<int64_t>(),
+              (vector<int64_t>{7, 7, 7, 8, 8, 8, 7, 7, 7, 8, 8, 8}));
+}
+
+} // namespace infini
@@ -0,0 +1,49 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/gather.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Gather, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({3, 2, 2}, DataType::Float32);
+    auto index = g->addTensor({2, 2}, DataType::Int64);
+    auto rows = g->addOp<GatherObj>(input, index, nullptr, 0);
+    auto index32 = g->addTensor({3}, DataType::Int32);
+    auto middle = g->addOp<GatherObj>(input, index32, nullptr, 1);
+    g->dataMalloc();
+    input->setData(IncrementalGenerator());
+    // Negative indices count from the end
+    index->copyin(vector<int64_t>{0, 2, -1, 1});
+    index32->copyin(vector<int32_t>{1, 0, 1});
+    runtime->run(g);
+    EXPECT_EQ(rows->getOutput()->getDims(), (Shape{2, 2, 2, 2}));
+    EXPECT_TRUE(rows->getOutput()->equalData(
+        vector<float>{0, 1, 2, 3, 8, 9, 10, 11, 8, 9, 10, 11, 4, 5, 6, 7}));
+    EXPECT_TRUE(middle->getOutput()->equalData(vector<float>{
+        2, 3, 0, 1, 2, 3, 6, 7, 4, 5, 6, 7, 10, 11, 8, 9, 10, 11}));
+}
+
+TEST(GatherElements, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({2, 3}, DataType::Int64);
+    auto index = g->addTensor({2, 2}, DataType::Int32);
+    auto index0 = g->addTensor({1, 3}, DataType::Int64);
+    auto op = g->addOp<GatherElementsObj>(input, index, nullptr, 1);
+    auto op0 = g->addOp<GatherElementsObj>(input, index0, nullptr, 0);
+    g->dataMalloc();
+    input->copyin(vector<int64_t>{1, 2, 3, 4, 5, 6});
+    index->copyin(vector<int32_t>{2, 0, -1, 1});
+    index0->copyin(vector<int64_t>{1, 0, 1});
+    runtime->run(g);
+    EXPECT_EQ(op->getOutput()->copyout<int64_t>(),
+              (vector<int64_t>{3, 1, 6, 5}));
+    EXPECT_EQ(op0->getOutput()->copyout<int64_t>(),
+              (vector<int64_t>{4, 2, 6}));
+}
+
+} // namespace infini
@@ -0,0 +1,195 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/kvcache.h"
+#include <cmath>
+#include <random>
+
+#include "test.h"
+
+namespace infini {
+
+// Causal attention of n queries at `pos` over the first pos + n rows of the
+// keys and values, laid out as [heads, rows, dim] with kvHeads for k and v
+static vector<float> attention(const vector<float> &q, const vector<float> &k,
+                               const vector<float> &v, int heads, int kvHeads,
+                               int n, int rows, int dim, int pos) {
+    vector<float> y(q.size());
+    for (int h = 0; h < heads; ++h)
+        for (int i = 0; i < n; ++i) {
+            int g = h / (heads / kvHeads);
+            const float *qi = &q[(h * n + i) * dim];
+            vector<float> s(pos + i + 1);
+            float max = -INFINITY, sum = 0;
+            for (int j = 0; j <= pos + i; ++j) {
+                s[j] = 0;
+                for (int d = 0; d < dim; ++d)
+                    s[j] += qi[d] * k[(g * rows + j) * dim + d];
+                s[j] /= std::sqrt(float(dim));
+                max = std::max(max, s[j]);
+            }
+            for (auto &x : s)
+                sum += x = std::exp(x - max);
+            for (int d = 0; d < dim; ++d) {
+                float acc = 0;
+                for (int j = 0; j <= pos + i; ++j)
+                    acc += s[j] * v[(g * rows + j) * dim + d];
+                y[(h * n + i) * dim + d] = acc / sum;
+            }
+        }
+    return y;
+}
+
+static bool near(const vector<float> &a, const vector<float> &b) {
+    for (size_t i = 0; i < a.size(); ++i)
+        if (std::abs(a[i] - b[i]) > 1e-5 * (1 + std::abs(b[i])))
+            return false;
+    return a.size() == b.size();
+}
+
+TEST(KVCache, decode) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    const int heads = 4, kvHeads = 2, maxLength = 16, dim = 8;
+    auto kCache = g->addTensor({1, kvHeads, maxLength, dim}, DataType::Float32);
+    auto vCache = g->addTensor({1, kvHeads, maxLength, dim}, DataType::Float32);
+    kCache->setKVCache();
+    vCache->setKVCache();
+    auto q = g->addTensor({1, heads, 1, dim}, DataType::Float32);
+    auto k = g->addTensor({1, kvHeads, 1, dim}, DataType::Float32);
+    auto v = g->addTensor({1, kvHeads, 1, dim}, DataType::Float32);
+    auto pos = g->addTensor({1}, DataType::Int32);
+    auto kOut = g->addOp<KVCacheAppendObj>(kCache, k, pos, nullptr);
+    auto vOut = g->addOp<KVCacheAppendObj>(vCache, v, pos, nullptr);
+    auto attn =
+        g->addOp<AttentionKVCacheObj>(q, kOut->getOutput(), vOut->getOutput(),
+                                      pos, nullptr);
+    EXPECT_EQ(attn->getOutput()->getDims(), (Shape{1, heads, 1, dim}));
+    g->dataMalloc();
+    // The appends update the caches in place
+    EXPECT_EQ(kOut->getOutput()->getRawDataPtr<void *>(),
+              kCache->getRawDataPtr<void *>());
+    auto cachePtr = kCache->getRawDataPtr<void *>();
+
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    auto random = [&](size_t n) {
+        vector<float> x(n);
+        for (auto &e : x)
+            e = dist(rng);
+        return x;
+    };
+    // The keys and values so far, as [kvHeads, maxLength, dim]
+    vector<float> keys(kvHeads * maxLength * dim),
+        values(kvHeads * maxLength * dim);
+    for (int step = 0; step < 6; ++step) {
+        // Planning again keeps the caches
+        if (step == 3) {
+            g->dataMalloc();
+            EXPECT_EQ(kCache->getRawDataPtr<void *>(), cachePtr);
+        }
+        auto qs = random(heads * dim), ks = random(kvHeads * dim),
+             vs = random(kvHeads * dim);
+        for (int h = 0; h < kvHeads; ++h)
+            for (int d = 0; d < dim; ++d) {
+                keys[(h * maxLength + step) * dim + d] = ks[h * dim + d];
+                values[(h * maxLength + step) * dim + d] = vs[h * dim + d];
+            }
+        q->copyin(qs);
+        k->copyin(ks);
+        v->copyin(vs);
+        pos->copyin(vector<int32_t>{step});
+        runtime->run(g);
+        auto y = attn->getOutput()->copyout<float>();
+        EXPECT_TRUE(near(y, attention(qs, keys, values, heads, kvHeads, 1,
+                                      maxLength, dim, step)));
+    }
+    // Appending past the end of the cache fails
+    pos->copyin(vector<int32_t>{maxLength});
+    EXPECT_THROW(runtime->run(g), Exception);
+}
+
+TEST(KVCache, prefill) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    const int heads = 2, n = 5, maxLength = 8, dim = 4;
+    auto kCache = g->addTensor({1, heads, maxLength, dim}, DataType::Float32);
+    auto vCache = g->addTensor({1, heads, maxLength, dim}, DataType::Float32);
+    kCache->setKVCache();
+    vCache->setKVCache();
+    auto q = g->addTensor({1, heads, n, dim}, DataType::Float32);
+    auto k = g->addTensor({1, heads, n, dim}, DataType::Float32);
+    auto v = g->addTensor({1, heads, n, dim}, DataType::Float32);
+    auto pos = g->addTensor({1}, DataType::Int64);
+    auto kOut = g->addOp<KVCacheAppendObj>(kCache, k, pos, nullptr);
+    auto vOut = g->addOp<KVCacheAppendObj>(vCache, v, pos, nullptr);
+    auto attn =
+        g->addOp<AttentionKVCacheObj>(q, kOut->getOutput(), vOut->getOutput(),
+                                      pos, nullptr);
+    // The appends update the caches in place with the naive allocator too
+    g->dataMalloc(true);
+    EXPECT_EQ(kOut->getOutput()->getRawDataPtr<void *>(),
+              kCache->getRawDataPtr<void *>());
+
+    vector<float> qs(heads * n * dim), ks(qs.size()), vs(qs.size());
+    for (size_t i = 0; i < qs.size(); ++i) {
+        qs[i] = std::sin(i * 0.3f);
+        ks[i] = std::cos(i * 0.7f);
+        vs[i] = i * 0.1f;
+    }
+    q->copyin(qs);
+    k->copyin(ks);
+    v->copyin(vs);
+    pos->copyin(vector<int64_t>{0});
+    runtime->run(g);
+    // Query i only sees the first i + 1 rows
+    EXPECT_TRUE(near(attn->getOutput()->copyout<float>(),
+                     attention(qs, ks, vs, heads, heads, n, n, dim, 0)));
+    auto cache = kOut->getOutput()->copyout<float>();
+    EXPECT_EQ(cache[(maxLength + n - 1) * dim], ks[(2 * n - 1) * dim]);
+}
+
+TEST(KVCache, graphOutput) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto cache = g->addTensor({1, 2, 8, 4}, DataType::Float32);
+    cache->setKVCache();
+    auto rows = g->addTensor({1, 2, 1, 4}, DataType::Float32);
+    auto pos = g->addTensor({1}, DataType::Int32);
+    auto append = g->addOp<KVCacheAppendObj>(cache, rows, pos, nullptr);
+    append->getOutput()->setOutput();
+    g->dataMalloc();
+    // A graph output too shares the cache, so that a step copies only the
+    // new rows
+    EXPECT_EQ(append->getOutput()->getRawDataPtr<void *>(),
+              cache->getRawDataPtr<void *>());
+    for (int step = 0; step < 3; ++step) {
+        rows->copyin(vector<float>(8, float(step + 1)));
+        pos->copyin(vector<int32_t>{step});
+        runtime->run(g);
+    }
+    auto out = append->getOutput()->copyout<float>();
+    for (int h = 0; h < 2; ++h)
+        for (int step = 0; step < 3; ++step)
+            EXPECT_EQ(out[(h * 8 + step) * 4], float(step + 1));
+}
+
+TEST(KVCache, shape) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto cache = g->addTensor({1, 2, 8, 4}, DataType::Float32);
+    auto rows = g->addTensor({1, 2, 1, 4}, DataType::Float32);
+    auto pos = g->addTensor({1}, DataType::Int32);
+    // Only kvcache tensors are appended to
+    EXPECT_THROW(g->addOp<KVCacheAppendObj>(cache, rows, pos, nullptr),
+                 Exception);
+    cache->setKVCache();
+    auto wide = g->addTensor({1, 2, 1, 5}, DataType::Float32);
+    EXPECT_THROW(g->addOp<KVCacheAppendObj>(cache, wide, pos, nullptr),
+                 Exception);
+    // Three query heads do not share two kv heads
+    auto q = g->addTensor({1, 3, 1, 4}, DataType::Float32);
+    EXPECT_THROW(g->addOp<AttentionKVCacheObj>(q, cache, cache, pos, nullptr),
+                 Exception);
+}
+
+} // namespace infini
@@ -0,0 +1,84 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/layer_norm.h"
+#include <cmath>
+
+#include "test.h"
+
+namespace infini {
+
+// LayerNorm, or RMSNorm without `center`, of the rows of `len` elements of
+// `x`, in double
+static vector<float> normalize(const vector<float> &x,
+                               const vector<float> &scale,
+                               const vector<float> &bias, float eps,
+                               bool center) {
+    const size_t len = scale.size();
+    vector<float> ret(x.size());
+    for (size_t o = 0; o < x.size(); o += len) {
+        double mean = 0, var = 0;
+        if (center) {
+            for (size_t i = 0; i < len; ++i)
+                mean += x[o + i];
+            mean /= len;
+        }
+        for (size_t i = 0; i < len; ++i)
+            var += (x[o + i] - mean) * (x[o + i] - mean);
+        const double inv = 1 / std::sqrt(var / len + eps);
+        for (size_t i = 0; i < len; ++i)
+            ret[o + i] = (x[o + i] - mean) * inv * scale[i] +
+                         (bias.empty() ? 0 : bias[i]);
+    }
+    return ret;
+}
+
+static void testNorm(const Shape &dims, int axis, bool center, bool hasBias,
+                     float offset) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(dims, DataType::Float32);
+    if (axis < 0)
+        axis += dims.size();
+    Shape paramDims(dims.begin() + axis, dims.end());
+    auto scale = g->addTensor(paramDims, DataType::Float32);
+    auto bias = hasBias ? g->addTensor(paramDims, DataType::Float32) : nullptr;
+    Tensor output;
+    if (center)
+        output = g->addOp<LayerNormObj>(input, scale, nullptr, bias, 1e-5,
+                                        axis)
+                     ->getOutput();
+    else
+        output = g->addOp<RMSNormObj>(input, scale, nullptr, 1e-5, axis)
+                     ->getOutput();
+    g->dataMalloc();
+    input->setData(RandomGenerator(offset - 1, offset + 1, 0));
+    scale->setData(RandomGenerator(-2, 2, 1));
+    if (bias)
+        bias->setData(RandomGenerator(-2, 2, 2));
+    runtime->run(g);
+    auto ans = normalize(input->copyout<float>(), scale->copyout<float>(),
+                         bias ? bias->copyout<float>() : vector<float>{}, 1e-5,
+                         center);
+    auto y = output->copyout<float>();
+    float maxErr = 0;
+    for (size_t i = 0; i < y.size(); ++i)
+        maxErr = std::max(maxErr, std::abs(y[i] - ans[i]) /
+                                      (1 + std::abs(ans[i])));
+    EXPECT_LT(maxErr, 1e-5);
+}
+
+TEST(LayerNorm, NativeCpu) {
+    testNorm({2, 3, 7}, 2, true, true, 0);
+    testNorm({2, 3, 1000}, -1, true, false, 0);
+    testNorm({2, 5, 300}, 1, true, true, 0);
+    // A mean far from zero does not cancel the variance
+    testNorm({4, 1000}, 1, true, true, 1000);
+}
+
+TEST(RMSNorm, NativeCpu) {
+    testNorm({2, 3, 7}, 2, false, false, 0);
+    testNorm({2, 5, 300}, 1, false, false, 0);
+    testNorm({4, 1000}, -1, false, false, 1000);
+}
+
+} // namespace infini
@@ -0,0 +1,86 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/batch_norm.h"
+#include "operators/conv.h"
+#include "operators/element_wise.h"
+#include "operators/pooling.h"
+#include "operators/transpose.h"
+#include "operators/unary.h"
+
+#include "test.h"
+
+namespace infini {
+
+// conv -> bn -> relu -> maxpool -> depthwise conv -> add -> 1x1 conv ->
+// sigmoid, where the relu output is also read by a transpose. The layout is
+// assigned with a channel block of `block`, if any. Returns the graph and its
+// two outputs.
+static tuple<Graph, Tensor, Tensor> buildGraph(Runtime runtime, int block) {
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({2, 16, 10, 9}, DataType::Float32);
+    auto w0 = g->addTensor({16, 16, 3, 3}, DataType::Float32);
+    auto b0 = g->addTensor({16}, DataType::Float32);
+    auto conv0 = g->addOp<ConvObj>(input, w0, nullptr, 1, 1, 1, 1, 1, 1, b0);
+    auto mean = g->addTensor({16}, DataType::Float32);
+    auto var = g->addTensor({16}, DataType::Float32);
+    auto scale = g->addTensor({16}, DataType::Float32);
+    auto bias = g->addTensor({16}, DataType::Float32);
+    auto bn = g->addOp<BatchNormObj>(conv0->getOutput(), nullptr, mean, var,
+                                     scale, bias);
+    auto relu = g->addOp<ReluObj>(bn->getOutput(), nullptr);
+    auto side = g->addOp<TransposeObj>(relu->getOutput(), nullptr,
+                                       vector<int>{0, 2, 3, 1});
+    auto pool = g->addOp<MaxPoolObj>(relu->getOutput(), nullptr, 2, 2, 1, 1,
+                                     0, 0, 2, 2, 0);
+    auto w1 = g->addTensor({16, 1, 3, 3}, DataType::Float32);
+    auto conv1 = g->addOp<ConvObj>(pool->getOutput(), w1, nullptr, 1, 1, 1, 1,
+                                   1, 1, nullptr, ActType::Tanh);
+    auto add = g->addOp<AddObj>(conv1->getOutput(), pool->getOutput(),
+                                nullptr);
+    auto w2 = g->addTensor({8, 16, 1, 1}, DataType::Float32);
+    auto conv2 = g->addOp<ConvObj>(add->getOutput(), w2, nullptr);
+    auto sigmoid = g->addOp<SigmoidObj>(conv2->getOutput(), nullptr);
+    // The graph outputs stay, though they may get produced by conversions
+    auto outputs = g->getOutputs();
+    if (block)
+        g->assignBlockedLayout(block);
+    g->dataMalloc();
+    int seed = 0;
+    for (auto t : {input, w0, b0, mean, scale, bias, w1, w2})
+        t->setData(RandomGenerator(-1, 1, seed++));
+    var->setData(RandomGenerator(0.5, 1, seed++));
+    return {g, outputs[0], outputs[1]};
+}
+
+static int countOps(const Graph &g, OpType type) {
+    int ret = 0;
+    for (auto &op : g->getOperators())
+        ret += op->getOpType() == type;
+    return ret;
+}
+
+TEST(Layout, NativeCpuBlocked) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    auto [ref, refSide, refOut] = buildGraph(runtime, 0);
+    runtime->run(ref);
+    for (int block : {8, 16}) {
+        auto [g, side, out] = buildGraph(runtime, block);
+        EXPECT_TRUE(g->checkValid());
+        // One conversion into the region and two out of it, beside the
+        // transpose of the graph
+        EXPECT_EQ(countOps(g, OpType::Transpose), 4);
+        int blocked = 0;
+        for (auto &t : g->getTensors())
+            blocked += t->getChannelBlock() == block;
+        // With 16 channels per block, the 8-channel tail stays plain
+        EXPECT_EQ(blocked, block == 8 ? 9 : 7);
+        EXPECT_EQ(out->getChannelBlock(), 1);
+        runtime->run(g);
+        // The blocked kernels sum in another order, which shows on the
+        // outputs close to zero
+        EXPECT_TRUE(side->equalData(refSide, 1e-3));
+        EXPECT_TRUE(out->equalData(refOut, 1e-3));
+    }
+}
+
+} // namespace infini
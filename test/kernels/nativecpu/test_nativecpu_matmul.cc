@@ -0,0 +1,162 @@
+#include "core/graph.h"
+#include "core/kernel.h"
+#include "core/runtime.h"
+#include "operators/matmul.h"
+
+#include "test.h"
+#include <cmath>
+
+namespace infini {
+
+// Index of the matrix of `dims` used by output batch `bi` of `batchC`, with
+// numpy-style broadcasting of the leading dimensions.
+static size_t broadcastBatch(const Shape &dims, const Shape &batchC,
+                             size_t bi) {
+    int shift = batchC.size() - (dims.size() - 2);
+    size_t idx = 0, stride = 1;
+    for (int d = batchC.size() - 1; d >= shift; --d) {
+        int dim = dims[d - shift];
+        idx += (dim == 1 ? 0 : bi % batchC[d]) * stride;
+        bi /= batchC[d];
+        stride *= dim;
+    }
+    return idx;
+}
+
+// Straightforward matmul used as the reference.
+template <typename T>
+static vector<T> referenceMatmul(const Tensor &a, const Tensor &b,
+                                 const Tensor &c, bool transA, bool transB) {
+    auto dimA = a->getDims(), dimB = b->getDims(), dimC = c->getDims();
+    int rank = dimC.size();
+    int m = dimC[rank - 2], n = dimC[rank - 1];
+    int k = transA ? dimA[dimA.size() - 2] : dimA.back();
+    Shape batchC(dimC.begin(), dimC.end() - 2);
+    size_t batch = c->size() / (m * n);
+    auto pa = a->getRawDataPtr<T *>(), pb = b->getRawDataPtr<T *>();
+    vector<T> ret(c->size());
+    for (size_t bi = 0; bi < batch; ++bi) {
+        const T *ma = pa + broadcastBatch(dimA, batchC, bi) * m * k;
+        const T *mb = pb + broadcastBatch(dimB, batchC, bi) * k * n;
+        for (int i = 0; i < m; ++i)
+            for (int j = 0; j < n; ++j) {
+                T sum = 0;
+                for (int p = 0; p < k; ++p)
+                    sum += (transA ? ma[p * m + i] : ma[i * k + p]) *
+                           (transB ? mb[j * k + p] : mb[p * n + j]);
+                ret[bi * m * n + i * n + j] = sum;
+            }
+    }
+    return ret;
+}
+
+template <typename T>
+static void testMatmul(const Shape &shapeA, const Shape &shapeB, bool transA,
+                       bool transB, DataType dtype) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor(shapeA, dtype);
+    auto b = g->addTensor(shapeB, dtype);
+    auto op = g->addOp<MatmulObj>(a, b, nullptr, transA, transB);
+    g->dataMalloc();
+    a->setData(RandomGenerator(0, 4, 0));
+    b->setData(RandomGenerator(0, 4, 1));
+    runtime->run(g);
+    auto c = op->getOutput();
+    auto ans = make_ref<TensorObj>(c->getDims(), dtype, runtime);
+    ans->dataMalloc();
+    ans->copyin(referenceMatmul<T>(a, b, c, transA, transB));
+    // Blocked accumulation rounds differently from the naive loop
+    EXPECT_TRUE(c->equalData(ans, 1e-5));
+}
+
+// Integer-valued data of both signs. All sums stay exact, so the fused
+// epilogue can be checked against an unfused reference.
+static vector<float> smallIntegers(size_t size, int seed) {
+    vector<float> ret(size);
+    for (size_t i = 0; i < size; ++i)
+        ret[i] = float((i * 7 + seed) % 5) - 2;
+    return ret;
+}
+
+static void testMatmulEpilogue(const Shape &shapeA, const Shape &shapeB,
+                               const Shape &shapeBias, ActType act) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor(shapeA, DataType::Float32);
+    auto b = g->addTensor(shapeB, DataType::Float32);
+    auto bias = g->addTensor(shapeBias, DataType::Float32);
+    auto op = g->addOp<MatmulObj>(a, b, nullptr, false, false, bias, act);
+    g->dataMalloc();
+    a->copyin(smallIntegers(a->size(), 1));
+    b->copyin(smallIntegers(b->size(), 2));
+    bias->copyin(smallIntegers(bias->size(), 3));
+    runtime->run(g);
+    auto c = op->getOutput();
+    auto ans = referenceMatmul<float>(a, b, c, false, false);
+    int m = op->getM(), n = op->getN(), rank = shapeBias.size();
+    int biasM = rank >= 2 ? shapeBias[rank - 2] : 1;
+    int biasN = rank >= 1 ? shapeBias[rank - 1] : 1;
+    auto pBias = bias->getRawDataPtr<float *>();
+    for (size_t i = 0; i < ans.size(); ++i) {
+        int row = biasM == 1 ? 0 : i / n % m, col = biasN == 1 ? 0 : i % n;
+        float x = ans[i] + pBias[row * biasN + col];
+        if (act == ActType::Relu)
+            x = std::max(x, 0.f);
+        else if (act == ActType::Sigmoid)
+            x = 1.f / (1.f + std::exp(-x));
+        else if (act == ActType::Tanh)
+            x = std::tanh(x);
+        ans[i] = x;
+    }
+    EXPECT_TRUE(c->equalData(ans));
+}
+
+TEST(Matmul, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({1, 2, 3}, DataType::Float32);
+    auto b = g->addTensor({1, 3, 4}, DataType::Float32);
+    auto op = g->addOp<MatmulObj>(a, b, nullptr);
+    g->dataMalloc();
+    a->setData(IncrementalGenerator());
+    b->setData(IncrementalGenerator());
+    runtime->run(g);
+    EXPECT_TRUE(op->getOutput()->equalData(
+        vector<float>{20, 23, 26, 29, 56, 68, 80, 92}));
+}
+
+TEST(Matmul, NativeCpuTranspose) {
+    for (bool transA : {false, true})
+        for (bool transB : {false, true}) {
+            Shape shapeA = transA ? Shape{2, 37, 29} : Shape{2, 29, 37};
+            Shape shapeB = transB ? Shape{2, 45, 37} : Shape{2, 37, 45};
+            testMatmul<float>(shapeA, shapeB, transA, transB,
+                              DataType::Float32);
+        }
+}
+
+TEST(Matmul, NativeCpuBroadcast) {
+    testMatmul<float>({3, 1, 7, 9}, {4, 9, 5}, false, false,
+                      DataType::Float32);
+    testMatmul<float>({9, 7}, {2, 3, 9, 5}, true, false, DataType::Float32);
+    testMatmul<uint32_t>({2, 1, 6, 3}, {1, 4, 5, 3}, false, true,
+                         DataType::UInt32);
+}
+
+TEST(Matmul, NativeCpuLarge) {
+    // Larger than one cache block in every dimension
+    testMatmul<float>({300, 600}, {600, 530}, false, false, DataType::Float32);
+    testMatmul<uint32_t>({150, 270}, {270, 70}, false, false,
+                         DataType::UInt32);
+}
+
+TEST(Matmul, NativeCpuBiasActivation) {
+    testMatmulEpilogue({9, 7}, {2, 7, 11}, {9, 11}, ActType::None);
+    testMatmulEpilogue({2, 13, 20}, {20, 33}, {13, 1}, ActType::Sigmoid);
+    testMatmulEpilogue({5, 3}, {3, 4}, {1}, ActType::Tanh);
+    // Edge tiles and several k blocks
+    testMatmulEpilogue({3, 70, 300}, {300, 45}, {45}, ActType::Relu);
+}
+
+} // namespace infini
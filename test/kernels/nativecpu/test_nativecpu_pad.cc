@@ -0,0 +1,24 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/pad.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Pad, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({1, 2, 3}, DataType::Int32);
+    auto op = g->addOp<PadObj>(input, nullptr, vector<int>{1, 2, 1, 0},
+                               vector<int>{1, 2});
+    g->dataMalloc();
+    input->copyin(vector<int32_t>{1, 2, 3, 4, 5, 6});
+    runtime->run(g);
+    EXPECT_EQ(op->getOutput()->getDims(), (Shape{1, 4, 5}));
+    EXPECT_EQ(op->getOutput()->copyout<int32_t>(),
+              (vector<int32_t>{0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 0, 0, 4, 5, 6,
+                               0, 0, 0, 0, 0}));
+}
+
+} // namespace infini
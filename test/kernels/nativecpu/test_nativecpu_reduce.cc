@@ -0,0 +1,122 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/reduce.h"
+#include <cmath>
+
+#include "test.h"
+
+namespace infini {
+
+// The reduction of `x` of shape `shape` over `axes` by folding `f` from
+// `init`, and then `finalize` of the result and the count, in double
+template <typename F, typename G>
+static vector<double> reference(const vector<float> &x, const Shape &shape,
+                                const set<int> &axes, double init, F f,
+                                G finalize) {
+    size_t outputs = 1, count = 1;
+    for (size_t d = 0; d < shape.size(); ++d)
+        (axes.count(d) ? count : outputs) *= shape[d];
+    vector<double> acc(outputs, init);
+    for (size_t i = 0; i < x.size(); ++i) {
+        size_t o = 0, rest = i, stride = 1;
+        for (int d = shape.size() - 1; d >= 0; --d) {
+            if (!axes.count(d)) {
+                o += rest % shape[d] * stride;
+                stride *= shape[d];
+            }
+            rest /= shape[d];
+        }
+        acc[o] = f(acc[o], double(x[i]));
+    }
+    for (auto &a : acc)
+        a = finalize(a, double(count));
+    return acc;
+}
+
+template <typename Op, typename F, typename G>
+static void testReduce(const Shape &shape, const vector<int> &axes,
+                       double init, F f, G finalize, double tolerance) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(shape, DataType::Float32);
+    auto op = g->addOp<Op>(input, nullptr, axes, false);
+    g->dataMalloc();
+    // In (0.5, 1.5], so that every reduction is defined
+    vector<float> x(input->size());
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = 0.5f + float(i * 7919 % 1000 + 1) / 1000;
+    input->copyin(x);
+    runtime->run(g);
+    auto y = op->getOutput()->template copyout<float>();
+    auto ans = reference(x, shape, op->getAxes(), init, f, finalize);
+    ASSERT_EQ(y.size(), ans.size());
+    for (size_t i = 0; i < y.size(); ++i)
+        ASSERT_NEAR(y[i], ans[i], tolerance * std::max(1., std::abs(ans[i])))
+            << "at " << i << " of " << vecToString(shape) << " over "
+            << vecToString(axes);
+}
+
+TEST(Reduce, NativeCpuAxes) {
+    auto sum = [](double a, double x) { return a + x; };
+    auto mean = [](double a, double n) { return a / n; };
+    auto none = [](double a, double) { return a; };
+    // Innermost, strided, all, non-contiguous, size 1 and negative axes
+    for (auto &[shape, axes] : vector<std::pair<Shape, vector<int>>>{
+             {{4, 5, 6}, {2}},
+             {{4, 5, 6}, {1}},
+             {{4, 5, 6}, {0}},
+             {{4, 5, 6}, {0, 1, 2}},
+             {{4, 5, 6}, {0, 2}},
+             {{3, 4, 5, 6}, {1, 3}},
+             {{3, 1, 5, 1}, {1, 2}},
+             {{3, 1, 5}, {1}},
+             {{2, 300, 7}, {-2}},
+             {{7, 1000}, {-1}},
+         }) {
+        testReduce<ReduceSumObj>(shape, axes, 0, sum, none, 1e-6);
+        testReduce<ReduceMeanObj>(shape, axes, 0, sum, mean, 1e-6);
+        testReduce<ReduceMaxObj>(
+            shape, axes, -INFINITY,
+            [](double a, double x) { return std::max(a, x); }, none, 0);
+        testReduce<ReduceLogSumExpObj>(
+            shape, axes, 0, [](double a, double x) { return a + std::exp(x); },
+            [](double a, double) { return std::log(a); }, 1e-6);
+    }
+    testReduce<ReduceSumSquareObj>(
+        {6, 7, 8}, {0, 2}, 0, [](double a, double x) { return a + x * x; },
+        none, 1e-6);
+    testReduce<ReduceL2Obj>(
+        {6, 7, 8}, {1}, 0, [](double a, double x) { return a + x * x; },
+        [](double a, double) { return std::sqrt(a); }, 1e-6);
+    testReduce<ReduceProdObj>(
+        {6, 7, 8}, {1}, 1, [](double a, double x) { return a * x; }, none,
+        1e-6);
+}
+
+TEST(Reduce, NativeCpuLongAxis) {
+    auto sum = [](double a, double x) { return a + x; };
+    auto none = [](double a, double) { return a; };
+    // A single long row, split across threads, and a long strided axis
+    testReduce<ReduceSumObj>({1 << 20}, {0}, 0, sum, none, 1e-6);
+    testReduce<ReduceSumObj>({50000, 3}, {0}, 0, sum, none, 1e-6);
+    testReduce<ReduceLogSumExpObj>(
+        {1 << 18}, {0}, 0, [](double a, double x) { return a + std::exp(x); },
+        [](double a, double) { return std::log(a); }, 1e-6);
+}
+
+TEST(Reduce, NativeCpuIntegerAndNoop) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto a = g->addTensor({2, 3}, DataType::Int64);
+    auto b = g->addTensor({2, 3}, DataType::Float32);
+    auto sum = g->addOp<ReduceSumObj>(a, nullptr, vector<int>{1}, false);
+    auto noop = g->addOp<ReduceSumObj>(b, nullptr, vector<int>{}, true, true);
+    g->dataMalloc();
+    a->copyin(vector<int64_t>{1, 2, 3, 4, 5, -6});
+    b->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    runtime->run(g);
+    EXPECT_EQ(sum->getOutput()->copyout<int64_t>(), (vector<int64_t>{6, 3}));
+    EXPECT_TRUE(noop->getOutput()->equalData(vector<float>{1, 2, 3, 4, 5, 6}));
+}
+
+} // namespace infini
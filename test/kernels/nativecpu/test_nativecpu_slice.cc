@@ -0,0 +1,41 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/slice.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Slice, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({3, 4, 5}, DataType::Float32);
+    // A run of the middle dim, a strided last dim and a sliced first dim
+    auto rows =
+        g->addOp<SliceObj>(input, nullptr, vector<int>{1}, vector<int>{3},
+                           vector<int>{1}, std::nullopt);
+    auto strided = g->addOp<SliceObj>(input, nullptr, vector<int>{1, 0},
+                                      vector<int>{3, 5}, vector<int>{0, 2},
+                                      vector<int>{2, 2});
+    auto outer = g->addOp<SliceObj>(input, nullptr, vector<int>{-1},
+                                    vector<int>{3}, std::nullopt, std::nullopt);
+    g->dataMalloc();
+    input->setData(IncrementalGenerator());
+    runtime->run(g);
+    vector<float> ansRows, ansStrided, ansOuter;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 1; j < 3; ++j)
+            for (int k = 0; k < 5; ++k)
+                ansRows.emplace_back(i * 20 + j * 5 + k);
+    for (int i = 1; i < 3; i += 2)
+        for (int j = 0; j < 4; ++j)
+            for (int k = 0; k < 5; k += 2)
+                ansStrided.emplace_back(i * 20 + j * 5 + k);
+    for (int i = 40; i < 60; ++i)
+        ansOuter.emplace_back(i);
+    EXPECT_TRUE(rows->getOutput()->equalData(ansRows));
+    EXPECT_TRUE(strided->getOutput()->equalData(ansStrided));
+    EXPECT_TRUE(outer->getOutput()->equalData(ansOuter));
+}
+
+} // namespace infini
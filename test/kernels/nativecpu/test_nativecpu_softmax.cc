@@ -0,0 +1,80 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/softmax.h"
+#include <cmath>
+
+#include "test.h"
+
+namespace infini {
+
+// Softmax or LogSoftmax of `data` with shape `dims` along `axis`, in double
+static vector<float> softmax(const vector<float> &data, const Shape &dims,
+                             int axis, bool isLog) {
+    size_t outer = 1, inner = 1, len = dims[axis];
+    for (int i = 0; i < axis; ++i)
+        outer *= dims[i];
+    for (size_t i = axis + 1; i < dims.size(); ++i)
+        inner *= dims[i];
+    vector<float> ret(data.size());
+    for (size_t o = 0; o < outer; ++o)
+        for (size_t i = 0; i < inner; ++i) {
+            auto at = [&](size_t j) { return (o * len + j) * inner + i; };
+            double max = -INFINITY, sum = 0;
+            for (size_t j = 0; j < len; ++j)
+                max = std::max<double>(max, data[at(j)]);
+            for (size_t j = 0; j < len; ++j)
+                sum += std::exp(data[at(j)] - max);
+            for (size_t j = 0; j < len; ++j)
+                ret[at(j)] = isLog ? data[at(j)] - max - std::log(sum)
+                                   : std::exp(data[at(j)] - max) / sum;
+        }
+    return ret;
+}
+
+template <typename T>
+static void testSoftmax(const Shape &dims, int axis, bool isLog) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(dims, DataType::Float32);
+    auto op = g->addOp<T>(input, nullptr, axis);
+    g->dataMalloc();
+    input->setData(RandomGenerator(-20, 20, axis));
+    runtime->run(g);
+    auto ans = softmax(input->copyout<float>(), dims, op->getAxis(), isLog);
+    auto y = op->getOutput()->template copyout<float>();
+    // Within a few float ulps
+    float maxErr = 0;
+    for (size_t i = 0; i < y.size(); ++i)
+        maxErr = std::max(maxErr, std::abs(y[i] - ans[i]) /
+                                      (1 + std::abs(ans[i])));
+    EXPECT_LT(maxErr, 4e-6);
+}
+
+TEST(Softmax, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({2, 4}, DataType::Float32);
+    auto axis1 = g->addOp<SoftmaxObj>(input, nullptr, 1);
+    auto axis0 = g->addOp<SoftmaxObj>(input, nullptr, 0);
+    g->dataMalloc();
+    // Large inputs do not overflow
+    input->copyin(vector<float>{0, 1, 2, 3, 10000, 10001, 10002, 10003});
+    runtime->run(g);
+    EXPECT_TRUE(axis1->getOutput()->equalData(
+        vector<float>{0.032058604, 0.08714432, 0.23688284, 0.6439143,
+                      0.032058604, 0.08714432, 0.23688284, 0.6439143}));
+    EXPECT_TRUE(axis0->getOutput()->equalData(
+        vector<float>{0., 0., 0., 0., 1, 1, 1, 1}));
+
+    for (int axis = 0; axis < 4; ++axis)
+        testSoftmax<SoftmaxObj>({3, 5, 7, 300}, axis, false);
+    testSoftmax<SoftmaxObj>({2, 1000}, -1, false);
+}
+
+TEST(LogSoftmax, NativeCpu) {
+    for (int axis = 0; axis < 4; ++axis)
+        testSoftmax<LogSoftmaxObj>({3, 5, 7, 300}, axis, true);
+    testSoftmax<LogSoftmaxObj>({2, 1000}, -1, true);
+}
+
+} // namespace infini
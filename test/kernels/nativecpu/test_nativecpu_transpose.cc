@@ -25,4 +25,60 @@ TEST(Transpose, NativeCpu) {
                                            8, 9, 10, 11, 20, 21, 22, 23}));
 }
 
+// Checks a permute of `dims` against the definition, element by element
+template <typename T>
+static void testPermute(const Shape &dims, const vector<int> &permute,
+                        DataType dtype) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor(dims, dtype);
+    auto op = g->addOp<TransposeObj>(input, nullptr, permute);
+    g->dataMalloc();
+    vector<T> x(input->size());
+    for (size_t i = 0; i < x.size(); ++i)
+        x[i] = T(i);
+    input->copyin(x);
+    runtime->run(g);
+    auto y = op->getOutput()->template copyout<T>();
+    const int rank = dims.size();
+    vector<size_t> stride(rank, 1);
+    for (int i = rank - 2; i >= 0; --i)
+        stride[i] = stride[i + 1] * dims[i + 1];
+    auto out = op->getOutput()->getDims();
+    for (size_t i = 0; i < y.size(); ++i) {
+        size_t rest = i, src = 0;
+        for (int j = rank - 1; j >= 0; --j) {
+            src += rest % out[j] * stride[permute[j]];
+            rest /= out[j];
+        }
+        ASSERT_EQ(y[i], x[src]) << "at " << i << " of " << vecToString(dims)
+                                << " permuted by " << vecToString(permute);
+    }
+}
+
+TEST(Transpose, NativeCpuPermutes) {
+    // Rows kept, head reshuffles, plain and batched 2D transposes with
+    // partial tiles, size-1 dims and a rank-5 permute
+    for (auto &[dims, permute] : vector<std::pair<Shape, vector<int>>>{
+             {{2, 8, 16, 64}, {0, 2, 1, 3}},
+             {{3, 5, 7}, {1, 0, 2}},
+             {{2, 16, 8, 64}, {0, 2, 3, 1}},
+             {{2, 8, 64, 16}, {0, 3, 1, 2}},
+             {{1024, 515}, {1, 0}},
+             {{13, 11}, {1, 0}},
+             {{4, 33, 70}, {0, 2, 1}},
+             {{30, 20, 10}, {2, 1, 0}},
+             {{1, 6, 1, 9}, {3, 2, 0, 1}},
+             {{7, 1}, {1, 0}},
+             {{2, 3, 4, 5, 6}, {4, 2, 0, 3, 1}},
+         }) {
+        testPermute<float>(dims, permute, DataType::Float32);
+    }
+    testPermute<int64_t>({9, 17, 5}, {2, 0, 1}, DataType::Int64);
+    testPermute<int32_t>({16, 24}, {1, 0}, DataType::Int32);
+    // Empty, along the last dim and another
+    testPermute<float>({4, 2, 0}, {1, 0, 2}, DataType::Float32);
+    testPermute<float>({0, 3}, {1, 0}, DataType::Float32);
+}
+
 } // namespace infini
@@ -0,0 +1,145 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/unary.h"
+#include <cmath>
+
+#include "test.h"
+
+namespace infini {
+
+// The largest error of `op` on `n` points over [lo, hi], relative to the
+// double result `ref`. Results under `floor` count as `floor`, where only
+// the absolute error matters.
+template <typename T, typename F>
+static double maxRelErr(float lo, float hi, F ref, double floor = 1e-30) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    const int n = 100003;
+    auto input = g->addTensor({n}, DataType::Float32);
+    auto op = g->addOp<T>(input, nullptr);
+    g->dataMalloc();
+    vector<float> x(n);
+    for (int i = 0; i < n; ++i)
+        x[i] = lo + (hi - lo) * i / (n - 1);
+    input->copyin(x);
+    runtime->run(g);
+    auto y = op->getOutput()->template copyout<float>();
+    double maxErr = 0;
+    for (int i = 0; i < n; ++i) {
+        double ans = ref(double(x[i]));
+        maxErr = std::max(maxErr, std::abs(y[i] - ans) /
+                                      std::max(std::abs(ans), floor));
+    }
+    return maxErr;
+}
+
+// The float epsilon, an ulp at 1
+static constexpr double ulp = 1.1920929e-7;
+
+TEST(Unary, NativeCpuTranscendental) {
+    // Up to the largest finite results
+    EXPECT_LT(maxRelErr<ExpObj>(-87, 88.72f,
+                                [](double x) { return std::exp(x); }),
+              2 * ulp);
+    EXPECT_LT(maxRelErr<SigmoidObj>(-80, 30,
+                                    [](double x) {
+                                        return 1 / (1 + std::exp(-x));
+                                    }),
+              3 * ulp);
+    EXPECT_LT(maxRelErr<TanhObj>(-10, 10,
+                                 [](double x) { return std::tanh(x); }),
+              3 * ulp);
+    EXPECT_LT(maxRelErr<ErfObj>(-5, 5, [](double x) { return std::erf(x); }),
+              3 * ulp);
+    EXPECT_LT(maxRelErr<GeluObj>(-5, 8,
+                                 [](double x) {
+                                     return x / 2 *
+                                            std::erfc(-x / std::sqrt(2));
+                                 }),
+              // The tail at -5 loses digits to its exponent, -12.5
+              20 * ulp);
+}
+
+TEST(Unary, NativeCpuSpecialValues) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({8}, DataType::Float32);
+    auto exp = g->addOp<ExpObj>(input, nullptr);
+    auto sigmoid = g->addOp<SigmoidObj>(input, nullptr);
+    auto tanh = g->addOp<TanhObj>(input, nullptr);
+    auto log = g->addOp<LogObj>(input, nullptr, LogObj::LogE);
+    auto log2 = g->addOp<LogObj>(input, nullptr, LogObj::Log2);
+    g->dataMalloc();
+    input->copyin(
+        vector<float>{-INFINITY, -100, 0, 1e-40, 100, INFINITY, 88.5, 88.7});
+    runtime->run(g);
+    auto e = exp->getOutput()->copyout<float>();
+    EXPECT_EQ(e[0], 0);
+    EXPECT_EQ(e[2], 1);
+    EXPECT_EQ(e[4], INFINITY);
+    // Finite, just under the overflow
+    EXPECT_NEAR(e[6] / std::exp(88.5), 1, 2 * ulp);
+    EXPECT_NEAR(e[7] / std::exp(double(88.7f)), 1, 2 * ulp);
+    auto s = sigmoid->getOutput()->copyout<float>();
+    EXPECT_EQ(s[0], 0);
+    EXPECT_LT(s[1], 1e-38);
+    EXPECT_EQ(s[5], 1);
+    auto t = tanh->getOutput()->copyout<float>();
+    EXPECT_EQ(t[1], -1);
+    EXPECT_EQ(t[2], 0);
+    EXPECT_EQ(t[4], 1);
+    auto l = log->getOutput()->copyout<float>();
+    EXPECT_TRUE(std::isnan(l[0]));
+    EXPECT_EQ(l[2], -INFINITY);
+    // Subnormal
+    EXPECT_NEAR(l[3], std::log(1e-40), 1e-4);
+    EXPECT_EQ(l[5], INFINITY);
+    auto l2 = log2->getOutput()->copyout<float>();
+    EXPECT_NEAR(l2[4], std::log2(100), 1e-5);
+}
+
+TEST(Unary, NativeCpuLog) {
+    for (auto [type, ref] : {
+             std::pair{LogObj::LogE, (double (*)(double))std::log},
+             std::pair{LogObj::Log2, (double (*)(double))std::log2},
+             std::pair{LogObj::Log10, (double (*)(double))std::log10},
+         }) {
+        Runtime runtime = NativeCpuRuntimeObj::getInstance();
+        Graph g = make_ref<GraphObj>(runtime);
+        const int n = 100000;
+        auto input = g->addTensor({n}, DataType::Float32);
+        auto op = g->addOp<LogObj>(input, nullptr, type);
+        g->dataMalloc();
+        // Spans many binades, and 1 where the log vanishes
+        vector<float> x(n);
+        for (int i = 0; i < n; ++i)
+            x[i] = std::exp2(-30 + 60. * i / n) * (i % 2 ? 1 : 1.001f);
+        input->copyin(x);
+        runtime->run(g);
+        auto y = op->getOutput()->copyout<float>();
+        double maxErr = 0;
+        for (int i = 0; i < n; ++i) {
+            double ans = ref(x[i]);
+            maxErr = std::max(maxErr, std::abs(y[i] - ans) /
+                                          std::max(1e-3, std::abs(ans)));
+        }
+        EXPECT_LT(maxErr, 3 * ulp);
+    }
+}
+
+TEST(Unary, NativeCpuLogExactPowers) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto input = g->addTensor({4}, DataType::Float32);
+    auto log2 = g->addOp<LogObj>(input, nullptr, LogObj::Log2);
+    auto log10 = g->addOp<LogObj>(input, nullptr, LogObj::Log10);
+    g->dataMalloc();
+    input->copyin(vector<float>{1, 8, 1000, 1024});
+    runtime->run(g);
+    EXPECT_EQ(log2->getOutput()->copyout<float>()[1], 3);
+    EXPECT_EQ(log2->getOutput()->copyout<float>()[3], 10);
+    EXPECT_EQ(log10->getOutput()->copyout<float>()[2], 3);
+    EXPECT_EQ(log10->getOutput()->copyout<float>()[0], 0);
+}
+
+} // namespace infini
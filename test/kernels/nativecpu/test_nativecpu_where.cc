@@ -0,0 +1,30 @@
+#include "core/graph.h"
+#include "core/runtime.h"
+#include "operators/where.h"
+
+#include "test.h"
+
+namespace infini {
+
+TEST(Where, NativeCpu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    auto x = g->addTensor({2, 3}, DataType::Float32);
+    auto y = g->addTensor({3}, DataType::Float32);
+    auto condition = g->addTensor({2, 1}, DataType::Bool);
+    auto same = g->addTensor({2, 3}, DataType::Bool);
+    auto broadcast = g->addOp<WhereObj>(x, y, condition, nullptr);
+    auto select = g->addOp<WhereObj>(x, y, same, nullptr);
+    g->dataMalloc();
+    x->copyin(vector<float>{1, 2, 3, 4, 5, 6});
+    y->copyin(vector<float>{-1, -2, -3});
+    condition->copyin(vector<int8_t>{0, 1});
+    same->copyin(vector<int8_t>{1, 0, 1, 0, 1, 0});
+    runtime->run(g);
+    EXPECT_TRUE(broadcast->getOutput()->equalData(
+        vector<float>{-1, -2, -3, 4, 5, 6}));
+    EXPECT_TRUE(
+        select->getOutput()->equalData(vector<float>{1, -2, 3, -1, 5, -3}));
+}
+
+} // namespace infini
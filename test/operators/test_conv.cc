@@ -66,4 +66,22 @@ TEST(Conv, NaiveCPU) {
     EXPECT_TRUE(conv->getOutput()->equalData(ans));
 }
 
+TEST(Conv, NaiveCPUBiasRelu) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    Graph g = make_ref<GraphObj>(runtime);
+    Tensor i0 = g->addTensor({1, 3, 4, 4}, DataType::Float32);
+    Tensor w0 = g->addTensor({2, 3, 3, 3}, DataType::Float32);
+    Tensor b0 = g->addTensor({2}, DataType::Float32);
+    auto conv = g->addOp<ConvObj>(i0, w0, nullptr, 1, 1, 2, 1, 1, 2, b0,
+                                  ActType::Relu);
+
+    g->dataMalloc();
+    i0->setData(IncrementalGenerator());
+    w0->setData(IncrementalGenerator());
+    b0->copyin(vector<float>{-5000, 1});
+    runtime->run(g);
+    EXPECT_TRUE(conv->getOutput()->equalData(
+        vector<float>{0, 0, 3199, 2506, 11275, 10543, 20836, 19657}));
+}
+
 } // namespace infini
@@ -1,7 +1,7 @@
 #include "core/graph.h"
 #include "core/kernel.h"
 #include "core/runtime.h"
-#include "operators/reduce_mean.h"
+#include "operators/reduce.h"
 
 #include "test.h"
 
@@ -48,4 +48,23 @@ TEST(ReduceMean, ShapeInference) {
     }
 }
 
+TEST(Reduce, NoopWithEmptyAxes) {
+    Runtime runtime = NativeCpuRuntimeObj::getInstance();
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({2, 3, 3, 4}, DataType::Float32);
+        auto op =
+            g->addOp<ReduceSumObj>(i, nullptr, vector<int>{}, false, true);
+        EXPECT_EQ(op->getOutput()->getDims(), (Shape{2, 3, 3, 4}));
+        EXPECT_TRUE(op->getAxes().empty());
+    }
+    {
+        Graph g = make_ref<GraphObj>(runtime);
+        Tensor i = g->addTensor({2, 3, 3, 4}, DataType::Float32);
+        auto op =
+            g->addOp<ReduceMaxObj>(i, nullptr, vector<int>{}, false, false);
+        EXPECT_EQ(op->getOutput()->getDims(), (Shape{1}));
+    }
+}
+
 } // namespace infini